@@ -0,0 +1,123 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+
+#include <ccol/thread/parallel.hxx>
+#include <ccol/thread/threadpool.hxx>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+/* Compares std::sort with ccol::thread::parallel_sort on pools of 1, 8 and 64 threads.
+ *
+ * Usage: parallelsort_benchmark [elements] [repetitions]
+ */
+
+namespace {
+
+struct Record
+{
+    std::uint64_t key;
+    std::string name;
+
+    bool operator<(const Record &other) const { return key < other.key; }
+};
+
+std::vector<std::uint64_t> makeKeys(const std::size_t &count)
+{
+    std::mt19937_64 random(42);
+    std::vector<std::uint64_t> keys(count);
+    for (auto &key : keys) key = random();
+    return keys;
+}
+
+std::vector<Record> makeRecords(const std::size_t &count)
+{
+    std::vector<Record> records;
+    records.reserve(count);
+    for (auto key : makeKeys(count)) records.push_back(Record{key, "record " + std::to_string(key)});
+    return records;
+}
+
+// Returns the fastest of the repetitions in milliseconds, every repetition sorts a fresh copy of input.
+template<class T, class Sort>
+double measure(const std::vector<T> &input, const int &repetitions, Sort sort)
+{
+    double best = 0;
+    for (int repetition = 0; repetition < repetitions; repetition++) {
+        std::vector<T> values = input;
+        const auto start = std::chrono::steady_clock::now();
+        sort(values);
+        const std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+        if (!std::is_sorted(values.begin(), values.end())) {
+            std::fprintf(stderr, "result is not sorted\n");
+            std::exit(1);
+        }
+        if (repetition == 0 || elapsed.count() < best) best = elapsed.count();
+    }
+    return best;
+}
+
+template<class T>
+void run(const char *name, const std::vector<T> &input, const int &repetitions)
+{
+    const double reference = measure(input, repetitions, [](std::vector<T> &values) { std::sort(values.begin(), values.end()); });
+    std::printf("%-8s %-20s %10.2f ms\n", name, "std::sort", reference);
+    for (unsigned int threads : {1u, 8u, 64u}) {
+        ccol::thread::ThreadPool pool(threads);
+        const double elapsed = measure(input, repetitions, [&pool](std::vector<T> &values) {
+            ccol::thread::parallel_sort(pool, values.begin(), values.end());
+        });
+        std::printf("%-8s parallel_sort %2u+1  %10.2f ms %6.2fx\n", name, threads, elapsed, reference / elapsed);
+    }
+}
+
+}
+
+int main(int argc, char *argv[])
+{
+    const std::size_t count = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : 4000000;
+    const int repetitions = argc > 2 ? std::atoi(argv[2]) : 5;
+    std::printf("%zu elements, best of %d, %u hardware threads\n", count, repetitions, std::thread::hardware_concurrency());
+    run("uint64", makeKeys(count), repetitions);
+    run("record", makeRecords(count), repetitions);
+    return 0;
+}
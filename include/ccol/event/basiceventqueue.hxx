@@ -0,0 +1,158 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_EVENT_BASICEVENTQUEUE_HXX
+#define CCOL_EVENT_BASICEVENTQUEUE_HXX
+
+#include <ccol/thread/queuepolicy.hxx>
+#include <ccol/thread/threadpooloptions.hxx>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+namespace ccol {
+    namespace event {
+
+        /**
+         * \brief A header-only event loop whose event type, queue and idle strategy are template arguments.
+         *
+         *    struct Tick { int value; };
+         *    ccol::event::BasicEventQueue<Tick, ccol::thread::RingQueue> queue(1024);
+         *    std::thread loop([&queue]{ queue.run([](Tick &&tick){ handle(tick); }); });
+         *    queue.enqueue(Tick{1});
+         *
+         * EventQueue dispatches shared_ptr events on their dynamic type to std::function callbacks,
+         * behind a stable ABI. BasicEventQueue passes events by value to one handler that is a
+         * template argument of run(), so enqueue and the dispatch are inlined and events are not
+         * allocated. Dispatching on the kind of event is up to the handler, for example with a
+         * switch on a member of the event.
+         *
+         * enqueue() and stop() are thread safe. One thread at a time executes run().
+         *
+         * \tparam E The type of the events, it must be default constructible and move assignable.
+         * \tparam Queue The queue policy, see ccol::thread::LockedQueue.
+         * \tparam Idle What run() does when the queue is empty.
+         */
+        template<class E, template<class> class Queue = thread::LockedQueue, thread::IdleStrategy Idle = thread::IdleStrategy::Park>
+        class BasicEventQueue
+        {
+        private:
+            Queue<E> _queue;
+            thread::detail::Idler<Idle> _idler;
+            std::atomic_bool _running{false};
+
+        public:
+            /**
+             * \brief Constructor of the BasicEventQueue.
+             * \param maxQueueSize The capacity of the queue, see the queue policy.
+             * \param spinCount The amount of polls of IdleStrategy::SpinThenPark.
+             */
+            explicit BasicEventQueue(const std::size_t &maxQueueSize = 0, const unsigned int &spinCount = 4096)
+                : _queue(maxQueueSize), _idler(spinCount)
+            {
+            }
+
+            BasicEventQueue(const BasicEventQueue &) = delete;
+            BasicEventQueue &operator=(const BasicEventQueue &) = delete;
+
+            /**
+             * \brief enqueue an event by using move semantics.
+             * \param event The event to queue.
+             * \return true when enqueue is succesful, false when queue is full.
+             */
+            bool enqueue(E &&event)
+            {
+                if (!_queue.tryPush(std::move(event))) return false;
+                _idler.pushed();
+                return true;
+            }
+
+            /**
+             * \brief enqueue a copy of an event.
+             * \param event The event to queue.
+             * \return true when enqueue is succesful, false when queue is full.
+             */
+            bool enqueue(const E &event)
+            {
+                return enqueue(E(event));
+            }
+
+            /**
+             * \brief run processes the events until stop() is called.
+             * \param handler A callable that takes an E&&, called for every event in queue order.
+             *
+             * Events that are queued when stop() is called stay queued for the next run().
+             */
+            template<class H>
+            void run(H &&handler)
+            {
+                if (_running.exchange(true)) return;
+                E event;
+                while (_running.load(std::memory_order_relaxed)) {
+                    if (_queue.tryPop(event)) {
+                        _idler.popped();
+                        handler(std::move(event));
+                    }
+                    else {
+                        _idler.idle(_running);
+                    }
+                }
+            }
+
+            /**
+             * \brief isRunning returns the running state.
+             * \return true when the event queue is running.
+             */
+            bool isRunning() const
+            {
+                return _running;
+            }
+
+            /**
+             * \brief stop the event queue when it is running.
+             *
+             * The run method will return after the event it is handling.
+             */
+            void stop()
+            {
+                _running = false;
+                _idler.wakeAll();
+            }
+        };
+
+    }
+}
+
+#endif
@@ -0,0 +1,81 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_EVENT_COROUTINE_HXX
+#define CCOL_EVENT_COROUTINE_HXX
+
+#include <ccol/event/eventqueue.hxx>
+
+#ifdef CCOL_ENABLE_COROUTINES
+
+#include <coroutine>
+
+namespace ccol {
+    namespace event {
+        /**
+         * \brief Awaitable returned by EventQueue::schedule().
+         *
+         * Awaiting it suspends the coroutine and posts its handle to the EventQueue, the thread
+         * that executes run() resumes it in order with the queued events.
+         */
+        class EventQueueAwaitable
+        {
+        private:
+            EventQueue &_queue;
+
+            static void resume(void *address)
+            {
+                std::coroutine_handle<>::from_address(address).resume();
+            }
+        public:
+            explicit EventQueueAwaitable(EventQueue &queue) noexcept : _queue(queue) {}
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                _queue.post(&EventQueueAwaitable::resume, handle.address());
+            }
+            void await_resume() const noexcept {}
+        };
+
+        inline EventQueueAwaitable EventQueue::schedule()
+        {
+            return EventQueueAwaitable(*this);
+        }
+    }
+}
+
+#endif // CCOL_ENABLE_COROUTINES
+
+#endif // CCOL_EVENT_COROUTINE_HXX
@@ -36,6 +36,7 @@
 #ifndef CCOL_EVENT_EVENTQUEUE_HXX
 #define CCOL_EVENT_EVENTQUEUE_HXX
 #include <ccol/event/baseevent.hxx>
+#include <ccol/thread/threadoptions.hxx>
 #include <functional>
 #include <utility>
 #include <vector>
@@ -46,6 +47,10 @@
 
 namespace ccol {
     namespace event {
+#ifdef CCOL_ENABLE_COROUTINES
+        class EventQueueAwaitable;
+#endif
+
         /**
          * \brief EventQueue implementation that allows cross-thread event messaging.
          *
@@ -131,6 +136,19 @@ namespace ccol {
              */
             bool enqueue(event_type &&event);
 
+            /**
+             * \brief post queues a plain function to be called by the thread that executes run().
+             * \param callback The function to call, it must not be nullptr.
+             * \param context The argument passed to callback.
+             * \return true when the callback is queued, false when callback is nullptr.
+             *
+             * Posted callbacks do not allocate an event and are not limited by the maximum queue
+             * size, they are executed in order with the events. This is the low level mechanism
+             * used to resume coroutines on the event loop. Callbacks that are still queued when
+             * the EventQueue is destroyed are never called.
+             */
+            bool post(void (*callback)(void*), void *context);
+
             /**
              * \brief setCallbackForType adds a lambda function as a handler for an event of type type.
              *
@@ -174,6 +192,16 @@ namespace ccol {
              */
             void run();
 
+            /**
+             * \brief run sets up the calling thread with threadOptions and starts processing the event queue.
+             * \param threadOptions The CPU set, scheduling policy and name of the thread.
+             *
+             * The options are applied before the first event is processed. The stack size of a
+             * running thread can not change, start the thread with ccol::thread::createThread()
+             * to set it.
+             */
+            void run(const thread::ThreadOptions &threadOptions);
+
             /**
              * \brief isRunning returns the running state.
              * \return true when the event queue is running.
@@ -191,8 +219,27 @@ namespace ccol {
              * \brief The virtual destructor ~EventQueue
              */
             virtual ~EventQueue();
+
+#ifdef CCOL_ENABLE_COROUTINES
+            /**
+             * \brief schedule returns an awaitable that resumes the awaiting coroutine on the thread that executes run().
+             *
+             *    co_await queue.schedule();
+             *    // continues on the event loop thread
+             *
+             * A coroutine suspended this way stays suspended until run() processes it.
+             *
+             * \return The awaitable, see ccol/event/coroutine.hxx.
+             */
+            EventQueueAwaitable schedule();
+#endif
         };
 
     }
 }
+
+#ifdef CCOL_ENABLE_COROUTINES
+#include <ccol/event/coroutine.hxx>
+#endif
+
 #endif
@@ -0,0 +1,187 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+
+#ifndef CCOL_THREAD_BASICTHREADPOOL_HXX
+#define CCOL_THREAD_BASICTHREADPOOL_HXX
+
+#include <ccol/thread/job.hxx>
+#include <ccol/thread/queuepolicy.hxx>
+#include <ccol/thread/threadpooloptions.hxx>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace ccol
+{
+    namespace thread
+    {
+        /** \brief A header-only thread pool whose queue, idle strategy and job type are template arguments.
+         *
+         *      ccol::thread::BasicThreadPool<ccol::thread::BasicJob<32>, ccol::thread::RingQueue, ccol::thread::IdleStrategy::SpinThenPark> threadpool(4, 4096);
+         *      threadpool.enqueue([&counter]{ counter++; });
+         *      threadpool.wait();
+         *
+         *  ThreadPool hides its implementation behind a stable ABI, so every enqueue is a call into
+         *  the library that the compiler can not inline. BasicThreadPool is compiled with the code
+         *  that uses it: enqueue, the worker loop and the job call are inlined for the chosen
+         *  policies, and the branches of the other policies do not exist. In return it only has
+         *  the core of ThreadPool: one FIFO queue, a fixed amount of workers, wait() and
+         *  runPendingJob(). Priorities, elastic threads, metrics and the other options of
+         *  ThreadPool remain exclusive to ThreadPool.
+         *
+         *  SpinThenPark polls up to spinCount times before parking, without the adaptation of
+         *  ThreadPool. Jobs that are still queued when the pool is destroyed are discarded.
+         *
+         *  \tparam J The job type, a move constructible callable without arguments that is
+         *  default constructible and move assignable, for example Job, BasicJob or a function pointer.
+         *  \tparam Queue The queue policy, LockedQueue, RingQueue or a class template like them.
+         *  \tparam Idle What a worker does when it finds no job.
+         */
+        template<class J = Job, template<class> class Queue = LockedQueue, IdleStrategy Idle = IdleStrategy::Park>
+        class BasicThreadPool
+        {
+        private:
+            Queue<J> _queue;
+            detail::Idler<Idle> _idler;
+            std::atomic_bool _running{true};
+            std::atomic<std::size_t> _unfinished{0}; // queued and running jobs.
+            std::atomic<unsigned int> _waiters{0};
+            std::mutex _mutex;
+            std::condition_variable _finishedCv;
+            std::vector<std::thread> _threads;
+
+            bool execute()
+            {
+                J job;
+                if (!_queue.tryPop(job)) return false;
+                _idler.popped();
+                job();
+                job = J();
+                // the waiter registers before it checks the count, so either it sees 0 or it is notified.
+                if (_unfinished.fetch_sub(1) == 1 && _waiters.load() > 0) {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _finishedCv.notify_all();
+                }
+                return true;
+            }
+
+            void worker()
+            {
+                while (_running.load(std::memory_order_relaxed)) {
+                    if (!execute()) {
+                        _idler.idle(_running);
+                    }
+                }
+            }
+        public:
+            /** \brief Creates the pool and starts its workers.
+             *
+             *  \param threads The amount of workers, 0 means std::thread::hardware_concurrency().
+             *  \param queueCapacity The capacity of the queue, see the queue policy.
+             *  \param spinCount The amount of polls of IdleStrategy::SpinThenPark.
+             */
+            explicit BasicThreadPool(const unsigned int &threads = 0, const std::size_t &queueCapacity = 0, const unsigned int &spinCount = 4096)
+                : _queue(queueCapacity), _idler(spinCount)
+            {
+                const unsigned int count = threads != 0 ? threads : std::max(std::thread::hardware_concurrency(), 1u);
+                _threads.reserve(count);
+                for (unsigned int idx = 0; idx < count; idx++) {
+                    _threads.emplace_back([this] { worker(); });
+                }
+            }
+
+            BasicThreadPool(const BasicThreadPool &) = delete;
+            BasicThreadPool &operator=(const BasicThreadPool &) = delete;
+
+            /** \brief Queues a job.
+             *
+             *  \param job The job to execute.
+             *  \return False when the queue is full, the job is then not queued.
+             */
+            bool enqueue(J &&job)
+            {
+                _unfinished.fetch_add(1, std::memory_order_relaxed);
+                if (!_queue.tryPush(std::move(job))) {
+                    _unfinished.fetch_sub(1, std::memory_order_relaxed);
+                    return false;
+                }
+                _idler.pushed();
+                return true;
+            }
+
+            /** \brief Executes one queued job on the calling thread.
+             *
+             *  \return True when a job was executed, false when the queue was empty.
+             */
+            bool runPendingJob()
+            {
+                return execute();
+            }
+
+            /** \brief Waits until all jobs are processed, it must not be called from a job of the pool. */
+            void wait()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                _waiters++;
+                _finishedCv.wait(lock, [this] { return _unfinished.load() == 0; });
+                _waiters--;
+            }
+
+            /** \brief Returns the amount of workers. */
+            unsigned int threadCount() const
+            {
+                return static_cast<unsigned int>(_threads.size());
+            }
+
+            /** \brief Stops the workers after their current job and joins them. */
+            ~BasicThreadPool()
+            {
+                _running = false;
+                _idler.wakeAll();
+                for (std::thread &thread : _threads) {
+                    thread.join();
+                }
+            }
+        };
+    }
+}
+
+#endif // CCOL_THREAD_BASICTHREADPOOL_HXX
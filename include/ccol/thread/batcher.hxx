@@ -0,0 +1,185 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+
+#ifndef CCOL_THREAD_BATCHER_HXX
+#define CCOL_THREAD_BATCHER_HXX
+
+#include <ccol/thread/threadpool.hxx>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            /** \brief The coordination of a Batcher, independent of the type of its items.
+             *
+             *  Batches are numbered, batch g is collected in buffer g modulo the amount of buffers.
+             */
+            class BatcherCore
+            {
+            private:
+                class Impl;
+                std::shared_ptr<Impl> _impl; // shared with the jobs of the batcher.
+            public:
+                /** \brief A place for one item, see claim(). */
+                struct Slot
+                {
+                    std::uint32_t batch;
+                    std::size_t buffer;
+                    std::size_t index;
+                };
+
+                BatcherCore(ThreadPool &pool, const std::size_t &maxItems, const std::chrono::nanoseconds &maxDelay,
+                            const std::size_t &buffers, std::function<void(std::size_t, std::size_t)> &&flush);
+                std::size_t maxItems() const;
+                std::size_t bufferCount() const;
+                Slot claim();
+                void commit(const Slot &slot);
+                void flush();
+                void wait();
+                ~BatcherCore();
+            };
+        }
+
+        /** \brief A Batcher collects items from any amount of threads and hands them to a ThreadPool in batches.
+         *
+         *      ccol::thread::Batcher<Sample> batcher(threadpool, 1000, std::chrono::microseconds(500),
+         *          [&database](std::vector<Sample> &samples) { database.insert(samples); });
+         *      batcher.add(Sample{"latency", 12});
+         *
+         *  A batch is flushed when it holds maxItems items, or maxDelay after its first item was
+         *  added, whichever comes first. Every batch is handled by one job on the pool.
+         *
+         *  Adding an item takes no lock: the item is moved to a place that was claimed with an
+         *  atomic increment. The batches are collected in a fixed set of buffers that are reused,
+         *  so after the first batches the Batcher does not allocate. When all buffers are being
+         *  handled, add() waits until the handler returns one. When the pool helps while waiting,
+         *  see ThreadPoolOptions::helpWhileWaiting, the waiting thread executes jobs of the pool
+         *  meanwhile, otherwise add() must not be called from a job of a pool without free workers.
+         *
+         *  The handler is called with at most one batch per buffer at the same time, so with more
+         *  than one buffer it must be thread safe. It may move the items out of the vector, the
+         *  vector is cleared afterwards. Batches of a single thread are handled in the order they
+         *  were added only when there is one buffer.
+         *
+         *  The ThreadPool must outlive the Batcher. The destructor flushes and waits for the
+         *  handler, see wait(). The jobs of a Batcher must not be removed from the pool with
+         *  ThreadPool::clear() or ThreadPool::dequeueAll().
+         *
+         *  \tparam T The type of the items, it must be default constructible and move assignable.
+         */
+        template<class T>
+        class Batcher
+        {
+        private:
+            std::vector<std::vector<T>> _buffers;
+            std::function<void(std::vector<T>&)> _handler;
+            detail::BatcherCore _core;
+
+            void handle(const std::size_t &buffer, const std::size_t &size)
+            {
+                std::vector<T> &items = _buffers[buffer];
+                items.resize(size);
+                _handler(items);
+                items.clear();
+                items.resize(_core.maxItems()); // keeps the capacity.
+            }
+        public:
+            /** \brief Creates a Batcher.
+             *
+             *  \param pool The ThreadPool that executes the handler.
+             *  \param maxItems The size of a full batch, at least 1.
+             *  \param maxDelay The time after the first item of a batch when the batch is flushed
+             *  even when it is not full, zero only flushes full batches.
+             *  \param handler A callable that takes a std::vector<T>&, a batch of 1 to maxItems items.
+             *  \param buffers The amount of batches that can be handled at the same time while the
+             *  next batch is collected, rounded up to a power of two.
+             */
+            template<class F>
+            Batcher(ThreadPool &pool, const std::size_t &maxItems, const std::chrono::microseconds &maxDelay, F &&handler,
+                    const std::size_t &buffers = 2)
+                : _handler(std::forward<F>(handler)),
+                  _core(pool, maxItems, maxDelay, buffers, [this](std::size_t buffer, std::size_t size) { handle(buffer, size); })
+            {
+                _buffers.assign(_core.bufferCount(), std::vector<T>(_core.maxItems()));
+            }
+
+            Batcher(const Batcher &) = delete;
+            Batcher &operator=(const Batcher &) = delete;
+
+            /** \brief Adds a copy of item to the current batch. */
+            void add(const T &item)
+            {
+                const detail::BatcherCore::Slot slot = _core.claim();
+                _buffers[slot.buffer][slot.index] = item;
+                _core.commit(slot);
+            }
+
+            /** \brief Moves item to the current batch. */
+            void add(T &&item)
+            {
+                const detail::BatcherCore::Slot slot = _core.claim();
+                _buffers[slot.buffer][slot.index] = std::move(item);
+                _core.commit(slot);
+            }
+
+            /** \brief Flushes the current batch now when it is not empty, without waiting for the handler. */
+            void flush()
+            {
+                _core.flush();
+            }
+
+            /** \brief Flushes the current batch and waits until the handler returned for every flushed batch.
+             *
+             *  Items that other threads add meanwhile may end up in a new batch that is not waited for.
+             */
+            void wait()
+            {
+                _core.wait();
+            }
+        };
+    }
+}
+
+#endif // CCOL_THREAD_BATCHER_HXX
@@ -0,0 +1,456 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_COROUTINE_HXX
+#define CCOL_THREAD_COROUTINE_HXX
+
+#include <ccol/thread/threadpool.hxx>
+
+#ifdef CCOL_ENABLE_COROUTINES
+
+#include <ccol/util/blockpool.hxx>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            /** \brief The Job that resumes a coroutine on a ThreadPool, it owns the suspended coroutine until it runs. */
+            class ResumeJob
+            {
+            private:
+                std::coroutine_handle<> _handle;
+            public:
+                explicit ResumeJob(std::coroutine_handle<> handle) noexcept : _handle(handle) {}
+                ResumeJob(ResumeJob &&other) noexcept : _handle(std::exchange(other._handle, nullptr)) {}
+                ResumeJob &operator=(ResumeJob &&other) = delete;
+                void operator()()
+                {
+                    std::exchange(_handle, nullptr).resume();
+                }
+                ~ResumeJob()
+                {
+                    if (_handle) _handle.destroy(); // dropped by the pool, the coroutine never resumes.
+                }
+            };
+        }
+
+        /** \brief Awaitable returned by ThreadPool::schedule().
+         *
+         *  Awaiting it suspends the coroutine and enqueues a single Job on the ThreadPool that
+         *  resumes it. The Job stores the coroutine handle inline, so a hop does not allocate.
+         *
+         *  When the pool drops the Job without running it, for example by clear(), dequeueAll()
+         *  or its destructor, the suspended coroutine is destroyed. A Task that is destroyed this
+         *  way destroys the coroutines that await it as well, syncWait then throws
+         *  std::future_error with std::future_errc::broken_promise.
+         */
+        class ThreadPoolAwaitable
+        {
+        private:
+            ThreadPool &_pool;
+        public:
+            explicit ThreadPoolAwaitable(ThreadPool &pool) noexcept : _pool(pool) {}
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle)
+            {
+                _pool.enqueue(Job(detail::ResumeJob(handle)));
+            }
+            void await_resume() const noexcept {}
+        };
+
+        inline ThreadPoolAwaitable ThreadPool::schedule()
+        {
+            return ThreadPoolAwaitable(*this);
+        }
+
+        template<class T = void> class Task;
+
+        namespace detail
+        {
+            /** \brief Stored in front of every coroutine frame of a Task, remembers where the frame came from. */
+            struct alignas(std::max_align_t) TaskFrameHeader
+            {
+                std::shared_ptr<util::BlockPool> pool;
+            };
+
+            /** \brief The part of the promise of a Task that does not depend on the result type. */
+            class TaskPromiseBase
+            {
+            private:
+                std::coroutine_handle<> _continuation;
+                std::coroutine_handle<> *_owner = nullptr;
+
+            protected:
+                static void *allocateFrame(std::size_t size, const std::shared_ptr<util::BlockPool> &pool)
+                {
+                    const std::size_t total = sizeof(TaskFrameHeader) + size;
+                    void *block = pool ? pool->allocate(total) : ::operator new(total);
+                    new (block) TaskFrameHeader{pool};
+                    return static_cast<char*>(block) + sizeof(TaskFrameHeader);
+                }
+
+                struct FinalAwaiter
+                {
+                    bool await_ready() const noexcept { return false; }
+                    template<class Promise>
+                    std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+                    {
+                        auto continuation = handle.promise()._continuation;
+                        return continuation ? continuation : std::noop_coroutine();
+                    }
+                    void await_resume() const noexcept {}
+                };
+
+            public:
+                /** \brief Allocates the frame of a coroutine from the global heap, see PoolTaskPromise for coroutines on a ThreadPool. */
+                static void *operator new(std::size_t size)
+                {
+                    return allocateFrame(size, nullptr);
+                }
+
+                static void operator delete(void *frame, std::size_t size)
+                {
+                    void *block = static_cast<char*>(frame) - sizeof(TaskFrameHeader);
+                    auto header = static_cast<TaskFrameHeader*>(block);
+                    std::shared_ptr<util::BlockPool> pool = std::move(header->pool);
+                    header->~TaskFrameHeader();
+                    if (pool) {
+                        pool->deallocate(block, sizeof(TaskFrameHeader) + size);
+                    } else {
+                        ::operator delete(block);
+                    }
+                }
+
+                std::suspend_always initial_suspend() const noexcept { return {}; }
+                FinalAwaiter final_suspend() const noexcept { return {}; }
+                void unhandled_exception() const noexcept { std::terminate(); }
+                void setContinuation(std::coroutine_handle<> continuation) noexcept { _continuation = continuation; }
+
+                /** \brief Sets the handle of the Task that destroys the coroutine, or nullptr when the Task destroys it. */
+                void setOwner(std::coroutine_handle<> *owner) noexcept { _owner = owner; }
+
+                /** \brief A coroutine that is not destroyed by its Task was dropped while suspended, so is its awaiter. */
+                ~TaskPromiseBase()
+                {
+                    if (!_owner) return;
+                    *_owner = nullptr;
+                    if (_continuation) _continuation.destroy();
+                }
+            };
+
+            template<class T>
+            class TaskPromise : public TaskPromiseBase
+            {
+            private:
+                std::optional<T> _value;
+            public:
+                Task<T> get_return_object() noexcept;
+                template<class U>
+                void return_value(U &&value) { _value.emplace(std::forward<U>(value)); }
+                T result() { return std::move(*_value); }
+            };
+
+            template<>
+            class TaskPromise<void> : public TaskPromiseBase
+            {
+            public:
+                Task<void> get_return_object() noexcept;
+                void return_void() const noexcept {}
+                void result() const noexcept {}
+            };
+
+            /** \brief The promise of a Task whose first parameter is a ThreadPool, selected by std::coroutine_traits.
+             *
+             *  Its frame is allocated from the BlockPool of that pool. The parameters are part of the
+             *  class instead of the operator, so operator new and operator delete are a plain pair,
+             *  which compilers that check allocation pairs accept.
+             */
+            template<class T, class... Args>
+            class PoolTaskPromise : public TaskPromise<T>
+            {
+            public:
+                static void *operator new(std::size_t size, ThreadPool &pool, Args&...)
+                {
+                    return TaskPromiseBase::allocateFrame(size, pool.blockPool());
+                }
+
+                static void operator delete(void *frame, std::size_t size)
+                {
+                    TaskPromiseBase::operator delete(frame, size);
+                }
+
+                Task<T> get_return_object() noexcept;
+            };
+        }
+
+        /** \brief A lazily started coroutine that produces a T.
+         *
+         *  The coroutine does not run until the Task is awaited with co_await, the awaiting
+         *  coroutine is resumed, without an additional hop, by the thread that completes the
+         *  Task. Use syncWait to run a Task from code that is not a coroutine.
+         *
+         *  When the first parameter of the coroutine is a ThreadPool, its frame is allocated
+         *  from the BlockPool of that ThreadPool, so short lived tasks recycle their frames:
+         *
+         *      ccol::thread::Task<int> compute(ccol::thread::ThreadPool &pool, int value)
+         *      {
+         *          co_await pool.schedule();
+         *          co_return value * 2;
+         *      }
+         *
+         *  Other coroutines use the global heap. Like jobs, a Task does not support exceptions,
+         *  an exception that leaves the coroutine calls std::terminate().
+         */
+        template<class T>
+        class Task
+        {
+        public:
+            typedef detail::TaskPromise<T> promise_type;
+
+        private:
+            // The promise may be a PoolTaskPromise, so the handle is kept without its promise type.
+            std::coroutine_handle<> _handle;
+            promise_type *_promise = nullptr;
+
+            class Awaiter
+            {
+            private:
+                std::coroutine_handle<> _handle;
+                promise_type *_promise;
+            public:
+                Awaiter(std::coroutine_handle<> handle, promise_type *promise) noexcept : _handle(handle), _promise(promise) {}
+                bool await_ready() const noexcept { return !_handle || _handle.done(); }
+                std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept
+                {
+                    _promise->setContinuation(awaiting);
+                    return _handle;
+                }
+                T await_resume() { return _promise->result(); }
+            };
+
+            void reset() noexcept
+            {
+                if (!_handle) return;
+                _promise->setOwner(nullptr);
+                std::exchange(_handle, nullptr).destroy();
+            }
+
+        public:
+            Task() noexcept = default;
+            Task(std::coroutine_handle<> handle, promise_type &promise) noexcept : _handle(handle), _promise(&promise)
+            {
+                _promise->setOwner(&_handle);
+            }
+            Task(Task &&other) noexcept : _handle(std::exchange(other._handle, nullptr)), _promise(other._promise)
+            {
+                if (_handle) _promise->setOwner(&_handle);
+            }
+            Task &operator=(Task &&other) noexcept
+            {
+                if (this != &other) {
+                    reset();
+                    _handle = std::exchange(other._handle, nullptr);
+                    _promise = other._promise;
+                    if (_handle) _promise->setOwner(&_handle);
+                }
+                return *this;
+            }
+            Task(const Task &) = delete;
+            Task &operator=(const Task &) = delete;
+            ~Task()
+            {
+                reset();
+            }
+
+            /** \brief Returns true when the Task holds a coroutine, false as well when the pool dropped it. */
+            bool valid() const noexcept { return static_cast<bool>(_handle); }
+
+            /** \brief Returns true when the coroutine has completed. */
+            bool done() const noexcept { return _handle && _handle.done(); }
+
+            /** \brief Starts the coroutine and suspends the awaiting coroutine until it completes. */
+            Awaiter operator co_await() const noexcept { return Awaiter(_handle, _promise); }
+        };
+
+        namespace detail
+        {
+            template<class T>
+            Task<T> TaskPromise<T>::get_return_object() noexcept
+            {
+                return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this), *this);
+            }
+
+            inline Task<void> TaskPromise<void>::get_return_object() noexcept
+            {
+                return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this), *this);
+            }
+
+            template<class T, class... Args>
+            Task<T> PoolTaskPromise<T, Args...>::get_return_object() noexcept
+            {
+                return Task<T>(std::coroutine_handle<PoolTaskPromise>::from_promise(*this), *this);
+            }
+
+            /** \brief Lets a thread that is not a coroutine block until a Task completes. */
+            class SyncWaitState
+            {
+            private:
+                std::mutex _mutex;
+                std::condition_variable _cv;
+                bool _done = false;
+                bool _completed = false;
+            public:
+                void complete() noexcept
+                {
+                    _completed = true;
+                }
+                void notify()
+                {
+                    // Notify under the lock, the waiter destroys this state as soon as it sees _done.
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _done = true;
+                    _cv.notify_all();
+                }
+                void wait()
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _cv.wait(lock, [this]{ return _done; });
+                    if (!_completed) {
+                        throw std::future_error(std::future_errc::broken_promise);
+                    }
+                }
+            };
+
+            /** \brief Notifies the SyncWaitState when the coroutine that waits for the Task ends, completed or destroyed. */
+            class SyncWaitNotifier
+            {
+            private:
+                SyncWaitState &_state;
+            public:
+                explicit SyncWaitNotifier(SyncWaitState &state) noexcept : _state(state) {}
+                SyncWaitNotifier(const SyncWaitNotifier &) = delete;
+                SyncWaitNotifier &operator=(const SyncWaitNotifier &) = delete;
+                ~SyncWaitNotifier()
+                {
+                    _state.notify();
+                }
+            };
+
+            /** \brief A coroutine that starts immediately and frees its own frame when it completes. */
+            struct DetachedCoroutine
+            {
+                struct promise_type
+                {
+                    DetachedCoroutine get_return_object() const noexcept { return {}; }
+                    std::suspend_never initial_suspend() const noexcept { return {}; }
+                    std::suspend_never final_suspend() const noexcept { return {}; }
+                    void return_void() const noexcept {}
+                    void unhandled_exception() const noexcept { std::terminate(); }
+                };
+            };
+
+            template<class T>
+            DetachedCoroutine syncWaitRun(Task<T> &task, std::optional<T> &result, SyncWaitState &state)
+            {
+                SyncWaitNotifier notifier(state);
+                result.emplace(co_await task);
+                state.complete();
+            }
+
+            inline DetachedCoroutine syncWaitRun(Task<void> &task, SyncWaitState &state)
+            {
+                SyncWaitNotifier notifier(state);
+                co_await task;
+                state.complete();
+            }
+        }
+
+        /** \brief Runs a Task to completion and blocks the calling thread until it is done.
+         *
+         *  The Task runs on the calling thread until its first suspension, for example
+         *  co_await pool.schedule(). Do not call syncWait from a worker of a ThreadPool that the
+         *  Task needs to make progress. When the pool drops the Task while it waits for a worker,
+         *  syncWait throws std::future_error with std::future_errc::broken_promise.
+         *
+         *  \param task The Task to run.
+         *  \return The value produced by the Task.
+         */
+        template<class T>
+        T syncWait(Task<T> task)
+        {
+            std::optional<T> result;
+            detail::SyncWaitState state;
+            detail::syncWaitRun(task, result, state);
+            state.wait();
+            return std::move(*result);
+        }
+
+        /** \brief Runs a Task<void> to completion and blocks the calling thread until it is done.
+         *
+         *  Throws std::future_error when the pool drops the Task, like syncWait of a Task<T>.
+         *
+         *  \param task The Task to run.
+         */
+        inline void syncWait(Task<void> task)
+        {
+            detail::SyncWaitState state;
+            detail::syncWaitRun(task, state);
+            state.wait();
+        }
+    }
+}
+
+/** \brief Selects the promise that allocates from the ThreadPool for a Task whose first parameter is a ThreadPool. */
+template<class T, class... Args>
+struct std::coroutine_traits<ccol::thread::Task<T>, ccol::thread::ThreadPool&, Args...>
+{
+    typedef ccol::thread::detail::PoolTaskPromise<T, Args...> promise_type;
+};
+
+#endif // CCOL_ENABLE_COROUTINES
+
+#endif // CCOL_THREAD_COROUTINE_HXX
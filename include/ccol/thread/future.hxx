@@ -0,0 +1,693 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_FUTURE_HXX
+#define CCOL_THREAD_FUTURE_HXX
+
+#include <ccol/thread/threadpool.hxx>
+#include <ccol/util/blockpool.hxx>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ccol
+{
+    namespace thread
+    {
+        template<class T> class Future;
+        template<class T> class Promise;
+
+        namespace detail
+        {
+            /** \brief Holds the result of a shared state. */
+            template<class T>
+            class FutureValue
+            {
+            private:
+                typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage;
+                bool _hasValue = false;
+            public:
+                template<class... Args>
+                void set(Args&&... args)
+                {
+                    new (&_storage) T(std::forward<Args>(args)...);
+                    _hasValue = true;
+                }
+                T take() { return std::move(*reinterpret_cast<T*>(&_storage)); }
+                ~FutureValue()
+                {
+                    if (_hasValue) reinterpret_cast<T*>(&_storage)->~T();
+                }
+            };
+
+            template<>
+            class FutureValue<void>
+            {
+            public:
+                void set() {}
+                void take() {}
+            };
+
+            /** \brief The state shared between a Future and the producer of its value.
+             *
+             *  The state is reference counted and allocated from the BlockPool of the ThreadPool
+             *  it belongs to. A single continuation can be attached, it is invoked on the thread
+             *  that makes the state ready, or immediately when the state already is ready.
+             *
+             *  A state whose producer is destroyed without providing a value becomes ready as
+             *  broken, taking the value of a broken state throws std::future_error.
+             *
+             *  The ThreadPool is not owned by the state, it must outlive the state while
+             *  continuations can still be scheduled on it.
+             */
+            template<class T>
+            class SharedState
+            {
+            private:
+                std::atomic<unsigned int> _references{1};
+                std::atomic_bool _ready{false};
+                bool _broken = false;
+                bool _waiting = false;
+                std::mutex _mutex;
+                std::condition_variable _readyCv;
+                Job _continuation;
+                ThreadPool *_pool;
+                std::shared_ptr<util::BlockPool> _blockPool;
+                FutureValue<T> _value;
+
+                SharedState(ThreadPool *pool, std::shared_ptr<util::BlockPool> &&blockPool)
+                    : _pool(pool), _blockPool(std::move(blockPool))
+                {
+                }
+
+                static_assert(alignof(FutureValue<T>) <= alignof(std::max_align_t), "Over-aligned types are not supported.");
+
+                void makeReady()
+                {
+                    Job continuation;
+                    bool waiting;
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        _ready.store(true, std::memory_order_release);
+                        continuation = std::move(_continuation);
+                        waiting = _waiting;
+                    }
+                    if (waiting) _readyCv.notify_all();
+                    if (continuation) continuation();
+                }
+            public:
+                /** \brief Creates a state with one reference, pool may be nullptr. */
+                static SharedState *create(ThreadPool *pool)
+                {
+                    std::shared_ptr<util::BlockPool> blockPool = pool != nullptr ? pool->blockPool() : nullptr;
+                    void *memory = blockPool != nullptr ? blockPool->allocate(sizeof(SharedState)) : ::operator new(sizeof(SharedState));
+                    return new (memory) SharedState(pool, std::move(blockPool));
+                }
+
+                void addReference()
+                {
+                    _references.fetch_add(1, std::memory_order_relaxed);
+                }
+
+                void release()
+                {
+                    if (_references.fetch_sub(1, std::memory_order_acq_rel) != 1) return;
+                    std::shared_ptr<util::BlockPool> blockPool = std::move(_blockPool);
+                    this->~SharedState();
+                    if (blockPool != nullptr) {
+                        blockPool->deallocate(this, sizeof(SharedState));
+                    }
+                    else {
+                        ::operator delete(this);
+                    }
+                }
+
+                ThreadPool *pool() const
+                {
+                    return _pool;
+                }
+
+                bool isReady() const
+                {
+                    return _ready.load(std::memory_order_acquire);
+                }
+
+                /** \brief Returns true when the state is ready without a value, the state must be ready. */
+                bool isBroken() const
+                {
+                    return _broken;
+                }
+
+                template<class... Args>
+                void setValue(Args&&... args)
+                {
+                    _value.set(std::forward<Args>(args)...);
+                    makeReady();
+                }
+
+                /** \brief Makes the state ready without a value. */
+                void setBroken()
+                {
+                    _broken = true;
+                    makeReady();
+                }
+
+                T take()
+                {
+                    if (_broken) throw std::future_error(std::future_errc::broken_promise);
+                    return _value.take();
+                }
+
+                void onReady(Job &&callback)
+                {
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        if (!_ready.load(std::memory_order_relaxed)) {
+                            _continuation = std::move(callback);
+                            return;
+                        }
+                    }
+                    callback();
+                }
+
+                void wait()
+                {
+                    if (isReady()) return;
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _waiting = true;
+                    _readyCv.wait(lock, [this]{ return _ready.load(std::memory_order_relaxed); });
+                }
+
+                bool wait_for(const std::chrono::nanoseconds &timeout)
+                {
+                    if (isReady()) return true;
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _waiting = true;
+                    return _readyCv.wait_for(lock, timeout, [this]{ return _ready.load(std::memory_order_relaxed); });
+                }
+            };
+
+            /** \brief Owns one reference to a state and releases it when destroyed. */
+            template<class T>
+            class StateReference
+            {
+            private:
+                SharedState<T> *_state;
+            public:
+                explicit StateReference(SharedState<T> *state) noexcept : _state(state) {}
+                StateReference(StateReference &&other) noexcept : _state(other._state)
+                {
+                    other._state = nullptr;
+                }
+                StateReference &operator=(StateReference &&other) = delete;
+                SharedState<T> &operator*() const { return *_state; }
+                ~StateReference()
+                {
+                    if (_state != nullptr) _state->release();
+                }
+            };
+
+            /** \brief Owns the reference of the producer of a state.
+             *
+             *  A producer that is destroyed before finish() was called, for example a job that is
+             *  removed from the ThreadPool by clear(), makes the state ready as broken so its
+             *  waiters return.
+             */
+            template<class T>
+            class ProducerReference
+            {
+            private:
+                SharedState<T> *_state;
+            public:
+                explicit ProducerReference(SharedState<T> *state) noexcept : _state(state) {}
+                ProducerReference(ProducerReference &&other) noexcept : _state(other._state)
+                {
+                    other._state = nullptr;
+                }
+                ProducerReference &operator=(ProducerReference &&other) = delete;
+                SharedState<T> &operator*() const { return *_state; }
+                void finish()
+                {
+                    _state->release();
+                    _state = nullptr;
+                }
+                ~ProducerReference()
+                {
+                    if (_state == nullptr) return;
+                    _state->setBroken();
+                    _state->release();
+                }
+            };
+
+            /** \brief The result type of a continuation F that receives the value of a Future<T>. */
+            template<class F, class T>
+            struct ContinuationResult
+            {
+                typedef typename std::result_of<F&(T&&)>::type type;
+            };
+
+            template<class F>
+            struct ContinuationResult<F, void>
+            {
+                typedef typename std::result_of<F&()>::type type;
+            };
+
+            /** \brief Invokes a function and stores its result in a state. */
+            template<class R>
+            struct Invoker
+            {
+                template<class F, class... Args>
+                static void invoke(SharedState<R> &state, F &function, Args&&... args)
+                {
+                    state.setValue(function(std::forward<Args>(args)...));
+                }
+            };
+
+            template<>
+            struct Invoker<void>
+            {
+                template<class F, class... Args>
+                static void invoke(SharedState<void> &state, F &function, Args&&... args)
+                {
+                    function(std::forward<Args>(args)...);
+                    state.setValue();
+                }
+            };
+
+            /** \brief Invokes a continuation with the value taken from the previous state. */
+            template<class T>
+            struct ContinuationInvoker
+            {
+                template<class R, class F>
+                static void invoke(SharedState<R> &next, F &function, SharedState<T> &previous)
+                {
+                    if (previous.isBroken()) {
+                        next.setBroken();
+                        return;
+                    }
+                    Invoker<R>::invoke(next, function, previous.take());
+                }
+            };
+
+            template<>
+            struct ContinuationInvoker<void>
+            {
+                template<class R, class F>
+                static void invoke(SharedState<R> &next, F &function, SharedState<void> &previous)
+                {
+                    if (previous.isBroken()) {
+                        next.setBroken();
+                        return;
+                    }
+                    Invoker<R>::invoke(next, function);
+                }
+            };
+
+            /** \brief Gives the library access to the shared state of futures and promises. */
+            struct FutureAccess
+            {
+                template<class T>
+                static SharedState<T> *state(const Future<T> &future) { return future._state; }
+
+                template<class T>
+                static Future<T> makeFuture(SharedState<T> *state) { return Future<T>(state); }
+
+                template<class T>
+                static Promise<T> makePromise(ThreadPool *pool) { return Promise<T>(pool); }
+            };
+        }
+
+        /** \brief A Future provides access to the result of an asynchronous operation.
+         *
+         *  Futures are returned by ThreadPool::submit(), Promise::getFuture(), Future::then(),
+         *  when_all() and when_any(). Their shared state is allocated from the BlockPool of the
+         *  ThreadPool that produces the value.
+         *
+         *  A Future is move-only and its value can be retrieved once. Exceptions are not supported:
+         *  a function that throws will terminate the program, just like a job on the ThreadPool.
+         *
+         *  When the producer of the value is destroyed without providing it, for example a submitted
+         *  job that is removed by ThreadPool::clear() or ThreadPool::dequeueAll(), or that is still
+         *  queued when the pool is destructed, the future becomes ready as broken. get() then throws
+         *  std::future_error with std::future_errc::broken_promise and continuations are skipped,
+         *  their futures become broken as well.
+         *
+         *  Continuations are scheduled on the ThreadPool of the future, that pool must outlive the
+         *  futures it returned while continuations can still be attached or scheduled.
+         *
+         *  \tparam T The type of the value, can be void.
+         */
+        template<class T>
+        class Future
+        {
+        private:
+            detail::SharedState<T> *_state = nullptr;
+
+            explicit Future(detail::SharedState<T> *state) : _state(state) {}
+
+            struct Releaser
+            {
+                detail::SharedState<T> *state;
+                ~Releaser() { state->release(); }
+            };
+
+            template<class> friend class Future;
+            friend struct detail::FutureAccess;
+            friend class ThreadPool;
+            friend class Promise<T>;
+        public:
+            /** \brief Constructs an invalid future. */
+            Future() = default;
+
+            /** \brief Move constructor, other becomes invalid. */
+            Future(Future &&other) noexcept : _state(other._state)
+            {
+                other._state = nullptr;
+            }
+
+            /** \brief Move assignment, other becomes invalid. */
+            Future &operator=(Future &&other) noexcept
+            {
+                if (this != &other) {
+                    if (_state != nullptr) _state->release();
+                    _state = other._state;
+                    other._state = nullptr;
+                }
+                return *this;
+            }
+
+            Future(const Future &) = delete;
+            Future &operator=(const Future &) = delete;
+
+            /** \brief Returns true when the future refers to a shared state. */
+            bool valid() const
+            {
+                return _state != nullptr;
+            }
+
+            /** \brief Returns true when the value is available, the future must be valid. */
+            bool isReady() const
+            {
+                return _state->isReady();
+            }
+
+            /** \brief Blocks until the value is available, the future must be valid. */
+            void wait() const
+            {
+                _state->wait();
+            }
+
+            /** \brief Blocks until the value is available or the timeout is reached.
+             *  \param timeout The maximum time to wait.
+             *  \return True when the value is available.
+             */
+            bool wait_for(const std::chrono::nanoseconds &timeout) const
+            {
+                return _state->wait_for(timeout);
+            }
+
+            /** \brief Returns true when the future is ready without a value, the future must be valid. */
+            bool isBroken() const
+            {
+                return _state->isReady() && _state->isBroken();
+            }
+
+            /** \brief Waits for the value and returns it.
+             *
+             *  The value is moved out of the shared state, the future becomes invalid.
+             *
+             *  \return The value.
+             *  \throws std::future_error When the future is broken.
+             */
+            T get()
+            {
+                Releaser releaser{_state};
+                _state = nullptr;
+                releaser.state->wait();
+                return releaser.state->take();
+            }
+
+            /** \brief Attaches a continuation that is executed when the value is available.
+             *
+             *  The continuation receives the value (or nothing for Future<void>) and is enqueued on
+             *  the ThreadPool of this future when the value becomes available, so no thread blocks
+             *  while waiting. When the future has no ThreadPool, the continuation is executed on the
+             *  thread that provides the value.
+             *
+             *  This future becomes invalid.
+             *
+             *  \param function The continuation.
+             *  \return A future for the result of the continuation.
+             */
+            template<class F>
+            Future<typename detail::ContinuationResult<typename std::decay<F>::type, T>::type> then(F &&function)
+            {
+                typedef typename detail::ContinuationResult<typename std::decay<F>::type, T>::type R;
+                detail::SharedState<T> *previous = _state;
+                _state = nullptr;
+                ThreadPool *pool = previous->pool();
+                detail::SharedState<R> *next = detail::SharedState<R>::create(pool);
+                next->addReference(); // one reference for the continuation, one for the returned future.
+                previous->onReady([pool, previous, next, function = std::forward<F>(function)]() mutable {
+                    auto continuation = [previous = detail::StateReference<T>(previous),
+                                         next = detail::ProducerReference<R>(next),
+                                         function = std::move(function)]() mutable {
+                        detail::ContinuationInvoker<T>::invoke(*next, function, *previous);
+                        next.finish();
+                    };
+                    // a broken state is made ready when its job is dropped, possibly by a pool that
+                    // is being destructed, so the broken result is passed on without the pool.
+                    if (pool != nullptr && !previous->isBroken()) {
+                        pool->enqueue(std::move(continuation));
+                    }
+                    else {
+                        continuation();
+                    }
+                });
+                return Future<R>(next);
+            }
+
+            /** \brief Destructor, releases the shared state. */
+            ~Future()
+            {
+                if (_state != nullptr) _state->release();
+            }
+        };
+
+        /** \brief A Promise provides the value of a Future.
+         *
+         *  The value must be set exactly once, the future of a promise that is destructed without
+         *  setting its value becomes ready as broken.
+         *
+         *  \tparam T The type of the value, can be void.
+         */
+        template<class T>
+        class Promise
+        {
+        private:
+            detail::SharedState<T> *_state;
+            bool _futureRetrieved = false;
+
+            explicit Promise(ThreadPool *pool) : _state(detail::SharedState<T>::create(pool)) {}
+
+            friend struct detail::FutureAccess;
+        public:
+            /** \brief Constructs a promise without ThreadPool.
+             *
+             *  Continuations of its future are executed on the thread that sets the value.
+             */
+            Promise() : Promise(static_cast<ThreadPool*>(nullptr)) {}
+
+            /** \brief Constructs a promise whose continuations are scheduled on pool.
+             *  \param pool The ThreadPool that allocates the shared state and runs continuations.
+             */
+            explicit Promise(ThreadPool &pool) : Promise(&pool) {}
+
+            /** \brief Move constructor. */
+            Promise(Promise &&other) noexcept : _state(other._state), _futureRetrieved(other._futureRetrieved)
+            {
+                other._state = nullptr;
+            }
+
+            Promise(const Promise &) = delete;
+            Promise &operator=(const Promise &) = delete;
+
+            /** \brief Returns the future of this promise, can be called once. */
+            Future<T> getFuture()
+            {
+                _futureRetrieved = true;
+                _state->addReference();
+                return Future<T>(_state);
+            }
+
+            /** \brief Sets the value and makes the future ready.
+             *  \param args The arguments used to construct the value.
+             */
+            template<class... Args>
+            void setValue(Args&&... args)
+            {
+                _state->setValue(std::forward<Args>(args)...);
+            }
+
+            /** \brief Destructor, breaks the future when no value was set and releases the shared state. */
+            ~Promise()
+            {
+                if (_state == nullptr) return;
+                if (!_state->isReady()) _state->setBroken();
+                _state->release();
+            }
+        };
+
+        /** \brief The result of when_any(). */
+        template<class T>
+        struct WhenAnyResult
+        {
+            /** \brief The index of the first future that became ready. */
+            std::size_t index;
+
+            /** \brief The futures passed to when_any(). */
+            std::vector<Future<T>> futures;
+        };
+
+        /** \brief Returns a future that becomes ready when all futures are ready.
+         *
+         *  No thread is blocked while waiting, the returned future is made ready by the
+         *  thread that provides the last value.
+         *
+         *  \param futures The futures to wait for, they are returned by the resulting future.
+         *  \return A future that returns the futures when all are ready.
+         */
+        template<class T>
+        Future<std::vector<Future<T>>> when_all(std::vector<Future<T>> &&futures)
+        {
+            struct Context
+            {
+                std::atomic<std::size_t> remaining;
+                std::vector<Future<T>> futures;
+                Promise<std::vector<Future<T>>> promise;
+                Context(std::size_t remaining, std::vector<Future<T>> &&futures, ThreadPool *pool)
+                    : remaining(remaining), futures(std::move(futures)),
+                      promise(detail::FutureAccess::makePromise<std::vector<Future<T>>>(pool)) {}
+                void arrive()
+                {
+                    if (remaining.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                        promise.setValue(std::move(futures));
+                    }
+                }
+            };
+            ThreadPool *pool = futures.empty() ? nullptr : detail::FutureAccess::state(futures.front())->pool();
+            std::vector<detail::SharedState<T>*> states;
+            states.reserve(futures.size());
+            for (const auto &future : futures) {
+                states.push_back(detail::FutureAccess::state(future));
+            }
+            // one extra arrival for this function, so the value is not set while callbacks are attached.
+            auto context = std::make_shared<Context>(futures.size() + 1, std::move(futures), pool);
+            Future<std::vector<Future<T>>> result = context->promise.getFuture();
+            for (auto state : states) {
+                state->onReady([context]{ context->arrive(); });
+            }
+            context->arrive();
+            return result;
+        }
+
+        /** \brief Returns a future that becomes ready when one of the futures is ready.
+         *
+         *  No thread is blocked while waiting, the returned future is made ready by the
+         *  thread that provides the first value.
+         *
+         *  \param futures The futures to wait for, they are returned by the resulting future.
+         *  \return A future that returns the index of the first ready future and the futures.
+         */
+        template<class T>
+        Future<WhenAnyResult<T>> when_any(std::vector<Future<T>> &&futures)
+        {
+            struct Context
+            {
+                std::atomic_bool done{false};
+                std::vector<Future<T>> futures;
+                Promise<WhenAnyResult<T>> promise;
+                Context(std::vector<Future<T>> &&futures, ThreadPool *pool)
+                    : futures(std::move(futures)),
+                      promise(detail::FutureAccess::makePromise<WhenAnyResult<T>>(pool)) {}
+                void arrive(const std::size_t &index)
+                {
+                    if (!done.exchange(true, std::memory_order_acq_rel)) {
+                        promise.setValue(WhenAnyResult<T>{index, std::move(futures)});
+                    }
+                }
+            };
+            ThreadPool *pool = futures.empty() ? nullptr : detail::FutureAccess::state(futures.front())->pool();
+            std::vector<detail::SharedState<T>*> states;
+            states.reserve(futures.size());
+            for (const auto &future : futures) {
+                states.push_back(detail::FutureAccess::state(future));
+            }
+            const bool empty = futures.empty();
+            auto context = std::make_shared<Context>(std::move(futures), pool);
+            Future<WhenAnyResult<T>> result = context->promise.getFuture();
+            if (empty) {
+                context->arrive(0);
+                return result;
+            }
+            for (std::size_t index = 0; index < states.size(); index++) {
+                states[index]->onReady([context, index]{ context->arrive(index); });
+            }
+            return result;
+        }
+
+        template<class F>
+        Future<typename std::result_of<typename std::decay<F>::type&()>::type> ThreadPool::submit(F &&function)
+        {
+            typedef typename std::result_of<typename std::decay<F>::type&()>::type R;
+            detail::SharedState<R> *state = detail::SharedState<R>::create(this);
+            state->addReference(); // one reference for the job, one for the returned future.
+            enqueue([producer = detail::ProducerReference<R>(state), function = std::forward<F>(function)]() mutable {
+                detail::Invoker<R>::invoke(*producer, function);
+                producer.finish();
+            });
+            return Future<R>(state);
+        }
+    }
+}
+
+#endif // CCOL_THREAD_FUTURE_HXX
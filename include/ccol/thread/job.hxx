@@ -0,0 +1,256 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_JOB_HXX
+#define CCOL_THREAD_JOB_HXX
+
+#include <cstddef>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/** \brief The inline buffer size in bytes of ccol::thread::Job.
+ *
+ *  Can be changed with the CMake cache variable CCOL_THREAD_JOB_INLINE_SIZE. The default
+ *  makes a Job exactly two cache lines in size.
+ */
+#ifndef CCOL_THREAD_JOB_INLINE_SIZE
+#define CCOL_THREAD_JOB_INLINE_SIZE 112
+#endif
+
+namespace ccol
+{
+    namespace thread
+    {
+        /** \brief A move-only callable without arguments, similar to std::function<void()>.
+         *
+         *  Callables that fit in InlineSize bytes and can be moved without throwing are stored
+         *  inside the BasicJob itself, so creating, moving and invoking such a job never allocates.
+         *  Larger callables are stored on the heap.
+         *
+         *  Contrary to std::function, move-only callables, for example lambdas that capture a
+         *  std::unique_ptr or a std::promise, are accepted.
+         *
+         *  \tparam InlineSize The size in bytes of the inline buffer.
+         */
+        template<std::size_t InlineSize>
+        class BasicJob
+        {
+        private:
+            static_assert(InlineSize >= sizeof(void*), "The inline buffer must at least hold a pointer.");
+
+            struct Operations
+            {
+                void (*invoke)(void *storage);
+                void (*move)(void *from, void *to);
+                void (*destroy)(void *storage);
+                bool heapAllocated;
+            };
+
+            template<class F>
+            struct InlineOperations
+            {
+                static void invoke(void *storage) { (*static_cast<F*>(storage))(); }
+                static void move(void *from, void *to)
+                {
+                    new (to) F(std::move(*static_cast<F*>(from)));
+                    static_cast<F*>(from)->~F();
+                }
+                static void destroy(void *storage) { static_cast<F*>(storage)->~F(); }
+                static constexpr Operations operations{&invoke, &move, &destroy, false};
+            };
+
+            template<class F>
+            struct HeapOperations
+            {
+                static F*& pointer(void *storage) { return *static_cast<F**>(storage); }
+                static void invoke(void *storage) { (*pointer(storage))(); }
+                static void move(void *from, void *to) { new (to) F*(pointer(from)); }
+                static void destroy(void *storage) { delete pointer(storage); }
+                static constexpr Operations operations{&invoke, &move, &destroy, true};
+            };
+
+            template<class F>
+            using fitsInline = std::integral_constant<bool,
+                sizeof(F) <= InlineSize &&
+                alignof(F) <= alignof(std::max_align_t) &&
+                std::is_nothrow_move_constructible<F>::value>;
+
+            template<class F>
+            static bool isEmpty(const F &) { return false; }
+            template<class R>
+            static bool isEmpty(R (* const &function)()) { return function == nullptr; }
+            template<class R>
+            static bool isEmpty(const std::function<R()> &function) { return function == nullptr; }
+
+            alignas(std::max_align_t) unsigned char _storage[InlineSize];
+            const Operations *_operations = nullptr;
+
+            template<class F>
+            void construct(F &&callable, std::true_type)
+            {
+                new (static_cast<void*>(_storage)) typename std::decay<F>::type(std::forward<F>(callable));
+                _operations = &InlineOperations<typename std::decay<F>::type>::operations;
+            }
+
+            template<class F>
+            void construct(F &&callable, std::false_type)
+            {
+                new (static_cast<void*>(_storage)) typename std::decay<F>::type*(new typename std::decay<F>::type(std::forward<F>(callable)));
+                _operations = &HeapOperations<typename std::decay<F>::type>::operations;
+            }
+
+            void reset() noexcept
+            {
+                if (_operations != nullptr) {
+                    _operations->destroy(_storage);
+                    _operations = nullptr;
+                }
+            }
+
+            void moveFrom(BasicJob &other) noexcept
+            {
+                if (other._operations != nullptr) {
+                    other._operations->move(other._storage, _storage);
+                    _operations = other._operations;
+                    other._operations = nullptr;
+                }
+            }
+
+        public:
+            /** \brief The size in bytes of the inline buffer. */
+            static constexpr std::size_t inlineSize = InlineSize;
+
+            /** \brief Constructs an empty job. */
+            BasicJob() noexcept = default;
+
+            /** \brief Constructs an empty job. */
+            BasicJob(std::nullptr_t) noexcept {}
+
+            /** \brief Constructs a job from any callable that can be invoked without arguments.
+             *
+             *  An empty std::function or a null function pointer results in an empty job.
+             *
+             *  \param callable The callable, it is moved or copied into the job.
+             */
+            template<class F, class = typename std::enable_if<
+                !std::is_same<typename std::decay<F>::type, BasicJob>::value &&
+                !std::is_same<typename std::decay<F>::type, std::nullptr_t>::value>::type,
+                class = decltype(std::declval<typename std::decay<F>::type&>()())>
+            BasicJob(F &&callable)
+            {
+                if (isEmpty(callable)) return;
+                construct(std::forward<F>(callable), fitsInline<typename std::decay<F>::type>());
+            }
+
+            /** \brief Move constructor, the other job is left empty. */
+            BasicJob(BasicJob &&other) noexcept
+            {
+                moveFrom(other);
+            }
+
+            /** \brief Move assignment, the other job is left empty. */
+            BasicJob& operator=(BasicJob &&other) noexcept
+            {
+                if (this != &other) {
+                    reset();
+                    moveFrom(other);
+                }
+                return *this;
+            }
+
+            /** \brief Assigning nullptr destroys the callable. */
+            BasicJob& operator=(std::nullptr_t) noexcept
+            {
+                reset();
+                return *this;
+            }
+
+            BasicJob(const BasicJob &) = delete;
+            BasicJob& operator=(const BasicJob &) = delete;
+
+            /** \brief Invokes the callable, the job must not be empty. */
+            void operator()()
+            {
+                _operations->invoke(_storage);
+            }
+
+            /** \brief Returns true when the job holds a callable. */
+            explicit operator bool() const noexcept
+            {
+                return _operations != nullptr;
+            }
+
+            /** \brief Returns true when the job holds a callable stored on the heap.
+             *
+             *  Such a callable was too large for the inline buffer or its move constructor may throw.
+             */
+            bool isHeapAllocated() const noexcept
+            {
+                return _operations != nullptr && _operations->heapAllocated;
+            }
+
+            ~BasicJob()
+            {
+                reset();
+            }
+
+            friend bool operator==(const BasicJob &job, std::nullptr_t) noexcept { return !job; }
+            friend bool operator==(std::nullptr_t, const BasicJob &job) noexcept { return !job; }
+            friend bool operator!=(const BasicJob &job, std::nullptr_t) noexcept { return static_cast<bool>(job); }
+            friend bool operator!=(std::nullptr_t, const BasicJob &job) noexcept { return static_cast<bool>(job); }
+        };
+
+        template<std::size_t InlineSize>
+        template<class F>
+        constexpr typename BasicJob<InlineSize>::Operations BasicJob<InlineSize>::InlineOperations<F>::operations;
+
+        template<std::size_t InlineSize>
+        template<class F>
+        constexpr typename BasicJob<InlineSize>::Operations BasicJob<InlineSize>::HeapOperations<F>::operations;
+
+        template<std::size_t InlineSize>
+        constexpr std::size_t BasicJob<InlineSize>::inlineSize;
+
+        /** \brief The job type used by the ThreadPool.
+         *
+         *  The inline buffer size is set by CCOL_THREAD_JOB_INLINE_SIZE.
+         */
+        typedef BasicJob<CCOL_THREAD_JOB_INLINE_SIZE> Job;
+    }
+}
+
+#endif // CCOL_THREAD_JOB_HXX
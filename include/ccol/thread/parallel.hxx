@@ -0,0 +1,665 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_PARALLEL_HXX
+#define CCOL_THREAD_PARALLEL_HXX
+
+#include <ccol/thread/threadpool.hxx>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            /** \brief The size of a cache line assumed by the parallel algorithms. */
+            constexpr std::size_t cacheLineSize = 64;
+
+            /** \brief Random access view on an iterator range or an integral index range. */
+            template<class I, bool isIntegral = std::is_integral<I>::value>
+            struct ParallelRange
+            {
+                typedef typename std::iterator_traits<I>::value_type value_type;
+                I first;
+                decltype(*std::declval<I>()) element(const std::size_t &offset) const { return first[offset]; }
+
+                /** \brief Elements per cache line, chunks are a multiple of this when possible. */
+                std::size_t alignment() const
+                {
+                    return sizeof(value_type) < cacheLineSize && cacheLineSize % sizeof(value_type) == 0 ? cacheLineSize / sizeof(value_type) : 1;
+                }
+
+                /** \brief The amount of elements before the first cache line boundary. */
+                std::size_t alignmentOffset() const
+                {
+                    const std::size_t elements = alignment();
+                    if (elements == 1) return 0;
+                    const std::uintptr_t address = reinterpret_cast<std::uintptr_t>(std::addressof(*first));
+                    if (address % sizeof(value_type) != 0) return 0;
+                    return ((cacheLineSize - address % cacheLineSize) % cacheLineSize) / sizeof(value_type);
+                }
+            };
+
+            template<class I>
+            struct ParallelRange<I, true>
+            {
+                I first;
+                I element(const std::size_t &offset) const { return static_cast<I>(first + offset); }
+                std::size_t alignment() const { return 1; }
+                std::size_t alignmentOffset() const { return 0; }
+            };
+
+            /** \brief Splits [0, count) in chunks that are claimed by the participating threads.
+             *
+             *  Chunks are claimed with guided self-scheduling: every chunk is a fraction of the
+             *  remaining work, so early chunks are large and the chunks at the end are small enough
+             *  to balance the load. Chunk boundaries are rounded to cache lines of the elements, so
+             *  two threads never write to the same cache line of an output range.
+             */
+            class ParallelChunks
+            {
+            private:
+                std::size_t _count;
+                std::size_t _alignment;
+                std::size_t _alignmentOffset;
+                std::size_t _divisor;
+                std::atomic<std::size_t> _next{0};
+                std::atomic<std::size_t> _remaining;
+                std::mutex _doneMutex;
+                std::condition_variable _doneCv;
+            public:
+                ParallelChunks(const std::size_t &count, const std::size_t &alignment, const std::size_t &alignmentOffset, const std::size_t &participants)
+                    : _count(count), _alignment(alignment), _alignmentOffset(alignmentOffset % alignment),
+                      _divisor(participants * 2), _remaining(count)
+                {
+                }
+
+                /** \brief Returns the first chunk boundary at or after position. */
+                std::size_t alignUp(const std::size_t &position) const
+                {
+                    if (position <= _alignmentOffset) return _alignmentOffset;
+                    return _alignmentOffset + ((position - _alignmentOffset + _alignment - 1) / _alignment) * _alignment;
+                }
+
+                bool claim(std::size_t &begin, std::size_t &end)
+                {
+                    std::size_t current = _next.load(std::memory_order_relaxed);
+                    do {
+                        if (current >= _count) return false;
+                        const std::size_t size = std::max<std::size_t>((_count - current) / _divisor, 1);
+                        end = std::min(_count, std::max(alignUp(current + size), alignUp(current + 1)));
+                    } while (!_next.compare_exchange_weak(current, end, std::memory_order_relaxed));
+                    begin = current;
+                    return true;
+                }
+
+                void completed(const std::size_t &count)
+                {
+                    if (count == 0) return;
+                    if (_remaining.fetch_sub(count, std::memory_order_acq_rel) == count) {
+                        std::unique_lock<std::mutex> lock(_doneMutex);
+                        _doneCv.notify_all();
+                    }
+                }
+
+                void wait()
+                {
+                    if (_remaining.load(std::memory_order_acquire) == 0) return;
+                    std::unique_lock<std::mutex> lock(_doneMutex);
+                    _doneCv.wait(lock, [this]{ return _remaining.load(std::memory_order_acquire) == 0; });
+                }
+            };
+
+            /** \brief Runs body(participant, begin, end) for chunks of [0, count) on the pool and the calling thread.
+             *
+             *  At most maxThreadCount() jobs are enqueued, independent of count. The calling thread
+             *  participates, so this also completes when no worker of the pool is available, for
+             *  example when it is called from a job. Returns the amount of participants.
+             */
+            template<class Body>
+            std::size_t parallelChunks(ThreadPool &pool, const std::size_t &count, const std::size_t &alignment, const std::size_t &alignmentOffset, Body &body)
+            {
+                if (count == 0) return 0;
+                const std::size_t chunks = (count + alignment - 1) / alignment;
+                const std::size_t helpers = std::min<std::size_t>(pool.maxThreadCount(), chunks - 1);
+                if (helpers == 0) {
+                    body(0, 0, count);
+                    return 1;
+                }
+                struct State
+                {
+                    ParallelChunks chunks;
+                    std::atomic<std::size_t> participants{0};
+                    Body *body;
+                    State(const std::size_t &count, const std::size_t &alignment, const std::size_t &alignmentOffset, const std::size_t &participants, Body *body)
+                        : chunks(count, alignment, alignmentOffset, participants), body(body) {}
+                    void work()
+                    {
+                        std::size_t begin, end, processed = 0;
+                        if (!chunks.claim(begin, end)) return; // late helper, the body may not exist anymore.
+                        const std::size_t participant = participants.fetch_add(1, std::memory_order_relaxed);
+                        do {
+                            (*body)(participant, begin, end);
+                            processed += end - begin;
+                        } while (chunks.claim(begin, end));
+                        chunks.completed(processed);
+                    }
+                };
+                auto state = std::make_shared<State>(count, alignment, alignmentOffset, helpers + 1, &body);
+                std::vector<Job> jobs;
+                jobs.reserve(helpers);
+                for (std::size_t idx = 0; idx < helpers; idx++) {
+                    jobs.emplace_back([state]{ state->work(); });
+                }
+                pool.enqueue(std::move(jobs));
+                state->work();
+                state->chunks.wait();
+                return helpers + 1;
+            }
+        }
+
+        /** \brief Invokes function for every element of a range, using the ThreadPool and the calling thread.
+         *
+         *  The range is either a pair of random access iterators, in which case function receives
+         *  a reference to each element, or a pair of integral values, in which case function
+         *  receives each index.
+         *
+         *  The work is split adaptively in chunks that are claimed by the threads, so only
+         *  maxThreadCount() jobs are enqueued, regardless of the size of the range. The calling
+         *  thread participates and returns when all elements have been processed.
+         *
+         *  \param pool The ThreadPool to execute on.
+         *  \param first The first element or index.
+         *  \param last One past the last element or index.
+         *  \param function The function to invoke.
+         */
+        template<class I, class F>
+        void parallel_for(ThreadPool &pool, I first, I last, F &&function)
+        {
+            const detail::ParallelRange<I> range{first};
+            auto body = [&range, &function](std::size_t, std::size_t begin, std::size_t end) {
+                for (std::size_t offset = begin; offset < end; offset++) {
+                    function(range.element(offset));
+                }
+            };
+            detail::parallelChunks(pool, static_cast<std::size_t>(last - first), range.alignment(), range.alignmentOffset(), body);
+        }
+
+        /** \brief Reduces a range in parallel, using the ThreadPool and the calling thread.
+         *
+         *  Every thread reduces the chunks it processes into its own partial result, the partial
+         *  results are reduced by the calling thread. Like std::reduce, reduce must be associative
+         *  and commutative.
+         *
+         *  \param pool The ThreadPool to execute on.
+         *  \param first The first element or index.
+         *  \param last One past the last element or index.
+         *  \param identity The identity value of reduce, for example 0 for addition.
+         *  \param reduce Function that combines two values of type T.
+         *  \param transform Function that converts an element, or an index for integral ranges, to T.
+         *  \return The reduced value.
+         */
+        template<class I, class T, class Reduce, class Transform>
+        T parallel_reduce(ThreadPool &pool, I first, I last, T identity, Reduce &&reduce, Transform &&transform)
+        {
+            const detail::ParallelRange<I> range{first};
+            std::vector<T> partials(pool.maxThreadCount() + 1, identity);
+            auto body = [&](std::size_t participant, std::size_t begin, std::size_t end) {
+                T result = std::move(partials[participant]);
+                for (std::size_t offset = begin; offset < end; offset++) {
+                    result = reduce(std::move(result), transform(range.element(offset)));
+                }
+                partials[participant] = std::move(result);
+            };
+            const std::size_t participants = detail::parallelChunks(pool, static_cast<std::size_t>(last - first), range.alignment(), range.alignmentOffset(), body);
+            T result = std::move(identity);
+            for (std::size_t participant = 0; participant < participants; participant++) {
+                result = reduce(std::move(result), std::move(partials[participant]));
+            }
+            return result;
+        }
+
+        /** \brief Reduces a range of random access iterators in parallel.
+         *
+         *  Same as parallel_reduce with a transform that returns the element.
+         *
+         *  \param pool The ThreadPool to execute on.
+         *  \param first The first element.
+         *  \param last One past the last element.
+         *  \param identity The identity value of reduce, for example 0 for addition.
+         *  \param reduce Function that combines two values of type T.
+         *  \return The reduced value.
+         */
+        template<class I, class T, class Reduce>
+        T parallel_reduce(ThreadPool &pool, I first, I last, T identity, Reduce &&reduce)
+        {
+            return parallel_reduce(pool, first, last, std::move(identity), std::forward<Reduce>(reduce), [](const T &value) { return value; });
+        }
+
+        /** \brief Computes an inclusive prefix scan in parallel, using the ThreadPool and the calling thread.
+         *
+         *  output[i] becomes identity op input[0] op ... op input[i]. The range is split in cache
+         *  line aligned blocks: the blocks are reduced in parallel, the block totals are scanned
+         *  by the calling thread and finally the blocks are scanned in parallel. op must be
+         *  associative, it does not need to be commutative.
+         *
+         *  \param pool The ThreadPool to execute on.
+         *  \param first The first input element.
+         *  \param last One past the last input element.
+         *  \param output The first output element, a random access iterator. May be equal to first.
+         *  \param identity The identity value of op.
+         *  \param op Function that combines two values of type T.
+         *  \return Iterator one past the last output element.
+         */
+        template<class InputIt, class OutputIt, class T, class Op>
+        OutputIt parallel_scan(ThreadPool &pool, InputIt first, InputIt last, OutputIt output, T identity, Op &&op)
+        {
+            const std::size_t count = static_cast<std::size_t>(last - first);
+            if (count == 0) return output;
+            const detail::ParallelRange<OutputIt> outputRange{output};
+            const std::size_t alignment = outputRange.alignment();
+            const std::size_t offset = outputRange.alignmentOffset();
+            const std::size_t blockSize = std::max<std::size_t>(
+                ((count / (4 * (pool.maxThreadCount() + 1)) + alignment - 1) / alignment) * alignment, alignment);
+            auto blockBegin = [&](std::size_t block) { return block == 0 ? 0 : std::min(count, offset + block * blockSize); };
+            std::size_t blocks = 1;
+            while (blockBegin(blocks) < count) blocks++;
+
+            std::vector<T> totals(blocks, identity);
+            auto reduceBlocks = [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (std::size_t block = begin; block < end; block++) {
+                    T total = identity;
+                    for (std::size_t idx = blockBegin(block); idx < blockBegin(block + 1); idx++) {
+                        total = op(std::move(total), first[idx]);
+                    }
+                    totals[block] = std::move(total);
+                }
+            };
+            detail::parallelChunks(pool, blocks, 1, 0, reduceBlocks);
+
+            T prefix = identity;
+            for (std::size_t block = 0; block < blocks; block++) {
+                T total = std::move(totals[block]);
+                totals[block] = prefix;
+                prefix = op(std::move(prefix), std::move(total));
+            }
+
+            auto scanBlocks = [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (std::size_t block = begin; block < end; block++) {
+                    T value = totals[block];
+                    for (std::size_t idx = blockBegin(block); idx < blockBegin(block + 1); idx++) {
+                        value = op(std::move(value), first[idx]);
+                        output[idx] = value;
+                    }
+                }
+            };
+            detail::parallelChunks(pool, blocks, 1, 0, scanBlocks);
+            return output + count;
+        }
+
+        namespace detail
+        {
+            /** \brief The least amount of elements per block that parallel_sort sorts with std::sort. */
+            constexpr std::size_t sortGrain = 16384;
+
+            /** \brief The least amount of elements per piece of the parallel merge steps. */
+            constexpr std::size_t mergeGrain = 8192;
+
+            /** \brief Uninitialized storage for the elements of a range, the scratch buffer of parallel_sort.
+             *
+             *  The first merge step constructs every element, the destructor destroys them.
+             */
+            template<class T>
+            class ScratchBuffer
+            {
+            private:
+                std::allocator<T> _allocator;
+                T *_data;
+                std::size_t _count;
+                bool _constructed = false;
+            public:
+                explicit ScratchBuffer(const std::size_t &count) : _data(_allocator.allocate(count)), _count(count) {}
+                ScratchBuffer(const ScratchBuffer &) = delete;
+                ScratchBuffer &operator=(const ScratchBuffer &) = delete;
+                T *data() const { return _data; }
+                void constructed() { _constructed = true; }
+                ~ScratchBuffer()
+                {
+                    if (_constructed && !std::is_trivially_destructible<T>::value) {
+                        for (std::size_t idx = 0; idx < _count; idx++) {
+                            _data[idx].~T();
+                        }
+                    }
+                    _allocator.deallocate(_data, _count);
+                }
+            };
+
+            /** \brief Moves a value to an output position, constructing it when the output is uninitialized. */
+            template<bool Construct>
+            struct MergeOutput
+            {
+                template<class O, class T>
+                static void put(O output, T &&value) { *output = std::move(value); }
+            };
+
+            template<>
+            struct MergeOutput<true>
+            {
+                template<class O, class T>
+                static void put(O output, T &&value)
+                {
+                    typedef typename std::iterator_traits<O>::value_type Value;
+                    ::new (static_cast<void*>(std::addressof(*output))) Value(std::move(value));
+                }
+            };
+
+            /** \brief Returns how many of the first k elements of the merge of a and b come from a.
+             *
+             *  Equal elements are taken from a first, like std::merge.
+             */
+            template<class I, class Compare>
+            std::size_t mergeSplit(const std::size_t &k, I a, const std::size_t &aSize, I b, const std::size_t &bSize, Compare &comp)
+            {
+                std::size_t low = k > bSize ? k - bSize : 0;
+                std::size_t high = std::min(k, aSize);
+                while (low < high) {
+                    const std::size_t i = low + (high - low) / 2;
+                    const std::size_t j = k - i;
+                    if (i < aSize && j > 0 && !comp(b[j - 1], a[i])) {
+                        low = i + 1; // a[i] precedes b[j - 1], more elements come from a.
+                    }
+                    else {
+                        high = i;
+                    }
+                }
+                return low;
+            }
+
+            /** \brief Merges a[aBegin, aEnd) and b[bBegin, bEnd) by moving the elements to output. */
+            template<bool Construct, class I, class O, class Compare>
+            void mergeMove(I a, std::size_t aBegin, const std::size_t &aEnd, I b, std::size_t bBegin, const std::size_t &bEnd, O output, Compare &comp)
+            {
+                while (aBegin < aEnd && bBegin < bEnd) {
+                    if (comp(b[bBegin], a[aBegin])) {
+                        MergeOutput<Construct>::put(output++, std::move(b[bBegin++]));
+                    }
+                    else {
+                        MergeOutput<Construct>::put(output++, std::move(a[aBegin++]));
+                    }
+                }
+                for (; aBegin < aEnd; aBegin++) MergeOutput<Construct>::put(output++, std::move(a[aBegin]));
+                for (; bBegin < bEnd; bBegin++) MergeOutput<Construct>::put(output++, std::move(b[bBegin]));
+            }
+
+            /** \brief Merges pairs of sorted runs of source into destination, on the pool and the calling thread.
+             *
+             *  Runs consist of width blocks, see blockBegin. The output is split in pieces of equal
+             *  size regardless of the runs, so the last merge of one pair of runs is as parallel as
+             *  the first. Where a piece starts in its pair of runs is found by binary search before
+             *  any element is moved, splits holds one position per piece boundary.
+             */
+            template<bool Construct, class Source, class Destination, class BlockBegin, class Compare>
+            void mergeRuns(ThreadPool &pool, Source source, Destination destination, const std::size_t &count,
+                           const std::size_t &blocks, const std::size_t &width, BlockBegin &blockBegin,
+                           std::vector<std::size_t> &splits, Compare &comp)
+            {
+                const std::size_t pieces = splits.size() - 1;
+                auto boundary = [count, pieces](std::size_t piece) { return count / pieces * piece + std::min(piece, count % pieces); };
+                // calls body(pairBegin, middle, pairEnd) for every pair of runs that overlaps [begin, end).
+                auto forPairs = [&](const std::size_t &begin, const std::size_t &end, auto body) {
+                    for (std::size_t pair = 0; pair < blocks; pair += 2 * width) {
+                        const std::size_t pairBegin = blockBegin(pair);
+                        const std::size_t pairEnd = blockBegin(std::min(blocks, pair + 2 * width));
+                        if (pairEnd <= begin) continue;
+                        if (pairBegin >= end) break;
+                        body(pairBegin, blockBegin(std::min(blocks, pair + width)), pairEnd);
+                    }
+                };
+                for (std::size_t piece = 1; piece < pieces; piece++) {
+                    const std::size_t position = boundary(piece);
+                    forPairs(position, position + 1, [&](std::size_t pairBegin, std::size_t middle, std::size_t pairEnd) {
+                        splits[piece] = mergeSplit(position - pairBegin, source + pairBegin, middle - pairBegin, source + middle, pairEnd - middle, comp);
+                    });
+                }
+                auto body = [&](std::size_t, std::size_t begin, std::size_t end) {
+                    for (std::size_t piece = begin; piece < end; piece++) {
+                        const std::size_t first = boundary(piece);
+                        const std::size_t last = boundary(piece + 1);
+                        forPairs(first, last, [&](std::size_t pairBegin, std::size_t middle, std::size_t pairEnd) {
+                            // a boundary inside the pair has a split, otherwise the piece covers the pair up to its start or end.
+                            const std::size_t from = std::max(first, pairBegin) - pairBegin;
+                            const std::size_t to = std::min(last, pairEnd) - pairBegin;
+                            const std::size_t aFrom = first > pairBegin ? splits[piece] : 0;
+                            const std::size_t aTo = last < pairEnd ? splits[piece + 1] : middle - pairBegin;
+                            mergeMove<Construct>(source + pairBegin, aFrom, aTo, source + middle, from - aFrom, to - aTo,
+                                                 destination + (pairBegin + from), comp);
+                        });
+                    }
+                };
+                parallelChunks(pool, pieces, 1, 0, body);
+            }
+        }
+
+        /** \brief Sorts a range in parallel, using the ThreadPool and the calling thread.
+         *
+         *  The range is split in blocks that are sorted with std::sort in parallel, after which
+         *  the blocks are merged pairwise. Every merge step is split in pieces of equal size of its
+         *  output, so the threads stay busy until the last step. The elements are moved between
+         *  the range and one scratch buffer of the size of the range, which is allocated once per
+         *  call, independent of the amount of threads and steps.
+         *
+         *  Like std::sort the sort is not stable. Ranges of less than a few ten thousand elements
+         *  are sorted on the calling thread. The calling thread participates, see parallel_for.
+         *
+         *  \param pool The ThreadPool to execute on.
+         *  \param first The first element, a random access iterator.
+         *  \param last One past the last element.
+         *  \param comp The comparison function, like the one of std::sort.
+         */
+        template<class I, class Compare>
+        void parallel_sort(ThreadPool &pool, I first, I last, Compare comp)
+        {
+            typedef typename std::iterator_traits<I>::value_type T;
+            const std::size_t count = static_cast<std::size_t>(last - first);
+            const std::size_t participants = pool.maxThreadCount() + 1;
+            std::size_t blocks = 1;
+            while (blocks < 2 * participants && count / (2 * blocks) >= detail::sortGrain) {
+                blocks *= 2;
+            }
+            if (blocks == 1) {
+                std::sort(first, last, comp);
+                return;
+            }
+            auto blockBegin = [count, blocks](std::size_t block) { return count / blocks * block + std::min(block, count % blocks); };
+            auto sortBlocks = [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (std::size_t block = begin; block < end; block++) {
+                    std::sort(first + blockBegin(block), first + blockBegin(block + 1), comp);
+                }
+            };
+            detail::parallelChunks(pool, blocks, 1, 0, sortBlocks);
+
+            detail::ScratchBuffer<T> scratch(count);
+            std::vector<std::size_t> splits(std::max<std::size_t>(std::min(count / detail::mergeGrain, 8 * participants), 1) + 1);
+            detail::mergeRuns<true>(pool, first, scratch.data(), count, blocks, 1, blockBegin, splits, comp);
+            scratch.constructed();
+            bool inScratch = true;
+            for (std::size_t width = 2; width < blocks; width *= 2) {
+                if (inScratch) {
+                    detail::mergeRuns<false>(pool, scratch.data(), first, count, blocks, width, blockBegin, splits, comp);
+                }
+                else {
+                    detail::mergeRuns<false>(pool, first, scratch.data(), count, blocks, width, blockBegin, splits, comp);
+                }
+                inScratch = !inScratch;
+            }
+            if (inScratch) {
+                T *sorted = scratch.data();
+                parallel_for(pool, std::size_t(0), count, [sorted, first](std::size_t idx) { first[idx] = std::move(sorted[idx]); });
+            }
+        }
+
+        /** \brief Sorts a range in ascending order in parallel, see parallel_sort with a comparison function.
+         *
+         *  \param pool The ThreadPool to execute on.
+         *  \param first The first element, a random access iterator.
+         *  \param last One past the last element.
+         */
+        template<class I>
+        void parallel_sort(ThreadPool &pool, I first, I last)
+        {
+            parallel_sort(pool, first, last, std::less<typename std::iterator_traits<I>::value_type>());
+        }
+
+        /** \brief Merges sorted runs into one sorted output in parallel, using the ThreadPool and the calling thread.
+         *
+         *  The output is split in parts by splitters sampled from the runs. Every part is a k-way
+         *  merge of one slice of every run, executed by one thread with a heap of the runs, so the
+         *  runs are read and the output is written once. The bounds of the slices and the heaps of
+         *  all parts share the buffers of the call, no memory is allocated per part or thread.
+         *
+         *  Equal elements keep the order of their runs. Parts can become unbalanced when many
+         *  elements are equal to a splitter.
+         *
+         *      std::vector<std::pair<Iterator, Iterator>> runs{{a.begin(), a.end()}, {b.begin(), b.end()}, {c.begin(), c.end()}};
+         *      ccol::thread::parallel_merge(threadpool, runs, output.begin());
+         *
+         *  \param pool The ThreadPool to execute on.
+         *  \param runs The first and last iterator of every sorted run, random access iterators.
+         *  \param output The first output element, a random access iterator, it must not overlap the runs.
+         *  \param comp The comparison function the runs are sorted by.
+         *  \return Iterator one past the last output element.
+         */
+        template<class I, class O, class Compare>
+        O parallel_merge(ThreadPool &pool, const std::vector<std::pair<I, I>> &runs, O output, Compare comp)
+        {
+            const std::size_t k = runs.size();
+            std::size_t count = 0;
+            for (const auto &run : runs) {
+                count += static_cast<std::size_t>(run.second - run.first);
+            }
+            if (count == 0) return output;
+            const std::size_t parts = std::max<std::size_t>(std::min<std::size_t>(4 * (pool.maxThreadCount() + 1), count / detail::mergeGrain), 1);
+
+            // splitters are quantiles of a sample of every run, a part holds the elements from one splitter up to the next.
+            std::vector<I> samples;
+            samples.reserve(k * parts);
+            for (const auto &run : runs) {
+                const std::size_t size = static_cast<std::size_t>(run.second - run.first);
+                for (std::size_t sample = 0; sample < parts && size > 0; sample++) {
+                    samples.push_back(run.first + (size * sample + size / 2) / parts);
+                }
+            }
+            std::sort(samples.begin(), samples.end(), [&comp](const I &left, const I &right) { return comp(*left, *right); });
+            std::vector<std::size_t> bounds((parts + 1) * k); // the slice of run r in part p is [bounds[p * k + r], bounds[(p + 1) * k + r]).
+            for (std::size_t run = 0; run < k; run++) {
+                bounds[parts * k + run] = static_cast<std::size_t>(runs[run].second - runs[run].first);
+            }
+            for (std::size_t part = 1; part < parts; part++) {
+                const I splitter = samples[part * samples.size() / parts];
+                for (std::size_t run = 0; run < k; run++) {
+                    bounds[part * k + run] = static_cast<std::size_t>(std::lower_bound(runs[run].first, runs[run].second, *splitter, comp) - runs[run].first);
+                }
+            }
+
+            std::vector<std::size_t> state(2 * parts * k); // per part the next element of every run, and a heap of runs.
+            auto mergeParts = [&](std::size_t, std::size_t begin, std::size_t end) {
+                for (std::size_t part = begin; part < end; part++) {
+                    const std::size_t *upper = &bounds[(part + 1) * k];
+                    std::size_t *cursors = &state[2 * part * k];
+                    std::size_t *heap = cursors + k;
+                    std::size_t heapSize = 0;
+                    O position = output;
+                    for (std::size_t run = 0; run < k; run++) {
+                        cursors[run] = bounds[part * k + run];
+                        position += cursors[run];
+                        if (cursors[run] < upper[run]) heap[heapSize++] = run;
+                    }
+                    // the top of the heap is the run with the smallest next element, the lowest run among equals.
+                    auto later = [&](const std::size_t &left, const std::size_t &right) {
+                        const auto &a = runs[left].first[cursors[left]];
+                        const auto &b = runs[right].first[cursors[right]];
+                        return comp(b, a) || (!comp(a, b) && left > right);
+                    };
+                    std::make_heap(heap, heap + heapSize, later);
+                    while (heapSize > 1) {
+                        std::pop_heap(heap, heap + heapSize, later);
+                        const std::size_t run = heap[heapSize - 1];
+                        *position++ = runs[run].first[cursors[run]++];
+                        if (cursors[run] < upper[run]) {
+                            std::push_heap(heap, heap + heapSize, later);
+                        }
+                        else {
+                            heapSize--;
+                        }
+                    }
+                    if (heapSize == 1) {
+                        const std::size_t run = heap[0];
+                        std::copy(runs[run].first + cursors[run], runs[run].first + upper[run], position);
+                    }
+                }
+            };
+            detail::parallelChunks(pool, parts, 1, 0, mergeParts);
+            return output + count;
+        }
+
+        /** \brief Merges runs sorted in ascending order in parallel, see parallel_merge with a comparison function.
+         *
+         *  \param pool The ThreadPool to execute on.
+         *  \param runs The first and last iterator of every sorted run, random access iterators.
+         *  \param output The first output element, a random access iterator, it must not overlap the runs.
+         *  \return Iterator one past the last output element.
+         */
+        template<class I, class O>
+        O parallel_merge(ThreadPool &pool, const std::vector<std::pair<I, I>> &runs, O output)
+        {
+            return parallel_merge(pool, runs, output, std::less<typename std::iterator_traits<I>::value_type>());
+        }
+    }
+}
+
+#endif // CCOL_THREAD_PARALLEL_HXX
@@ -0,0 +1,178 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_PIPELINE_HXX
+#define CCOL_THREAD_PIPELINE_HXX
+
+#include <ccol/thread/threadpool.hxx>
+#include <algorithm>
+#include <cstddef>
+#include <functional>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace ccol
+{
+    namespace thread
+    {
+        /** \brief How a stage of a Pipeline processes its tokens. */
+        enum class StageMode
+        {
+            /** \brief Any amount of tokens is processed at the same time, in any order. */
+            Parallel,
+
+            /** \brief One token at a time, in the order the tokens arrive at the stage. */
+            Serial,
+
+            /** \brief One token at a time, in the order the source produced them.
+             *
+             *  Tokens that overtook each other in a parallel stage wait in front of this stage
+             *  until the tokens before them have passed. The buffer in front of the stage is
+             *  therefore only bounded by the amount of tokens, not by the buffer capacity.
+             */
+            SerialInOrder
+        };
+
+        namespace detail
+        {
+            /** \brief The scheduling of a Pipeline, independent of the type of its tokens.
+             *
+             *  Tokens are identified by their index, the source is stage 0.
+             */
+            class PipelineCore
+            {
+            private:
+                class Impl;
+                std::shared_ptr<Impl> _impl; // shared with the jobs of the pipeline.
+            public:
+                PipelineCore(ThreadPool &pool, const std::size_t &tokens, const std::size_t &bufferCapacity);
+                void setSource(std::function<bool(std::size_t)> &&source);
+                void addStage(const StageMode &mode, std::function<void(std::size_t)> &&function);
+                void run();
+                ~PipelineCore();
+            };
+        }
+
+        /** \brief A Pipeline processes a stream of items in stages, on the threads of a ThreadPool.
+         *
+         *      ccol::thread::Pipeline<Record> pipeline(threadpool, 16);
+         *      pipeline.setSource([&input](Record &record) { return std::getline(input, record.line).good(); });
+         *      pipeline.addStage(ccol::thread::StageMode::Parallel, [](Record &record) { record.parse(); });
+         *      pipeline.addStage(ccol::thread::StageMode::Parallel, [](Record &record) { record.transform(); });
+         *      pipeline.addStage(ccol::thread::StageMode::SerialInOrder, [&output](Record &record) { output << record; });
+         *      pipeline.run();
+         *
+         *  Items travel through the stages in tokens, objects of type T that are created once by
+         *  the pipeline and reused for every item, so running the pipeline does not allocate
+         *  items. The source fills a token, every stage works on it in place. The amount of
+         *  tokens limits the amount of items in flight.
+         *
+         *  Every stage has a buffer of at most bufferCapacity tokens in front of it. A stage only
+         *  starts on a token when it can reserve a place in the buffer of the next stage, so a
+         *  slow stage makes the stages before it wait instead of piling up work, up to the
+         *  source. No thread blocks for this: every step of a token is a job on the pool, and
+         *  jobs are only enqueued for tokens that can make progress.
+         *
+         *  The ThreadPool and the Pipeline must outlive run(). The jobs of a pipeline must not be
+         *  removed from the pool with ThreadPool::clear() or ThreadPool::dequeueAll().
+         *
+         *  \tparam T The type of the tokens, it must be default constructible.
+         */
+        template<class T>
+        class Pipeline
+        {
+        private:
+            std::vector<T> _tokens;
+            detail::PipelineCore _core;
+        public:
+            /** \brief Creates a pipeline without source and stages.
+             *
+             *  \param pool The ThreadPool that executes the stages.
+             *  \param tokens The maximum amount of items in flight, at least 1.
+             *  \param bufferCapacity The capacity of the buffer in front of every stage, 0 means tokens.
+             */
+            Pipeline(ThreadPool &pool, const std::size_t &tokens, const std::size_t &bufferCapacity = 0)
+                : _tokens(std::max<std::size_t>(tokens, 1)), _core(pool, _tokens.size(), bufferCapacity)
+            {
+            }
+
+            Pipeline(const Pipeline &) = delete;
+            Pipeline &operator=(const Pipeline &) = delete;
+
+            /** \brief Sets the source, which fills a token with the next item.
+             *
+             *  The source is called serially. It returns false when there are no more items, the
+             *  token it was called with is then discarded.
+             *
+             *  \param source A callable that takes a T& and returns bool.
+             */
+            template<class F>
+            void setSource(F &&source)
+            {
+                _core.setSource([this, source = typename std::decay<F>::type(std::forward<F>(source))](std::size_t token) mutable -> bool {
+                    return source(_tokens[token]);
+                });
+            }
+
+            /** \brief Appends a stage.
+             *
+             *  \param mode How the stage processes its tokens.
+             *  \param function A callable that takes a T&.
+             */
+            template<class F>
+            void addStage(const StageMode &mode, F &&function)
+            {
+                _core.addStage(mode, [this, function = typename std::decay<F>::type(std::forward<F>(function))](std::size_t token) mutable {
+                    function(_tokens[token]);
+                });
+            }
+
+            /** \brief Runs the pipeline until the source has no more items and all items passed all stages.
+             *
+             *  When the pool helps while waiting, see ThreadPoolOptions::helpWhileWaiting, the
+             *  calling thread executes jobs of the pool meanwhile, so run() can be called from a
+             *  job. The pipeline can be run again, the source is then called again.
+             */
+            void run()
+            {
+                _core.run();
+            }
+        };
+    }
+}
+
+#endif // CCOL_THREAD_PIPELINE_HXX
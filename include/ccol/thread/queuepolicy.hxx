@@ -0,0 +1,276 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+
+#ifndef CCOL_THREAD_QUEUEPOLICY_HXX
+#define CCOL_THREAD_QUEUEPOLICY_HXX
+
+#include <ccol/thread/threadpooloptions.hxx>
+#include <ccol/thread/detail/cpurelax.hxx>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace ccol
+{
+    namespace thread
+    {
+        /** \brief A queue policy that keeps the items in a std::deque behind a mutex.
+         *
+         *  Queue policies are the storage of BasicThreadPool and event::BasicEventQueue. A policy
+         *  is a class template over the item type with a constructor that takes the capacity and
+         *  thread safe tryPush(T&&) and tryPop(T&) members, which return false when the queue is
+         *  full or empty. tryPush leaves the item untouched when it returns false.
+         *
+         *  \tparam T The type of the items, it must be move constructible and move assignable.
+         */
+        template<class T>
+        class LockedQueue
+        {
+        private:
+            std::mutex _mutex;
+            std::deque<T> _items;
+            std::size_t _capacity;
+        public:
+            /** \brief Creates an empty queue.
+             *
+             *  \param capacity The maximum amount of items, 0 means unbounded.
+             */
+            explicit LockedQueue(const std::size_t &capacity = 0)
+                : _capacity(capacity)
+            {
+            }
+
+            /** \brief Appends item, returns false when the queue is full. */
+            bool tryPush(T &&item)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_capacity != 0 && _items.size() >= _capacity) return false;
+                _items.push_back(std::move(item));
+                return true;
+            }
+
+            /** \brief Moves the oldest item to item, returns false when the queue is empty. */
+            bool tryPop(T &item)
+            {
+                std::lock_guard<std::mutex> lock(_mutex);
+                if (_items.empty()) return false;
+                item = std::move(_items.front());
+                _items.pop_front();
+                return true;
+            }
+        };
+
+        /** \brief A queue policy with a bounded lock-free multi-producer multi-consumer ring.
+         *
+         *  It is also the queue of Scheduling::Bounded. Every cell carries a sequence number
+         *  that tells producers and consumers whether the cell is free or filled for their
+         *  position, so they only contend on their own position counter. See LockedQueue for the
+         *  requirements of a queue policy.
+         *
+         *  \tparam T The type of the items, it must be default constructible and move assignable.
+         */
+        template<class T>
+        class RingQueue
+        {
+        private:
+            struct Cell
+            {
+                std::atomic<std::size_t> sequence;
+                T item;
+            };
+            std::unique_ptr<Cell[]> _cells;
+            std::size_t _mask;
+            char _padding0[64]; // keep the positions of producers and consumers on different cache lines.
+            std::atomic<std::size_t> _enqueuePosition{0};
+            char _padding1[64];
+            std::atomic<std::size_t> _dequeuePosition{0};
+            char _padding2[64];
+        public:
+            /** \brief Creates an empty ring.
+             *
+             *  \param capacity The amount of cells, rounded up to a power of two. 0 means 1024.
+             */
+            explicit RingQueue(const std::size_t &capacity = 0)
+            {
+                std::size_t size = 2;
+                while (size < (capacity == 0 ? 1024 : capacity)) {
+                    size <<= 1;
+                }
+                _cells.reset(new Cell[size]);
+                _mask = size - 1;
+                for (std::size_t idx = 0; idx < size; idx++) {
+                    _cells[idx].sequence.store(idx, std::memory_order_relaxed);
+                }
+            }
+
+            /** \brief Appends item, returns false when the ring is full. */
+            bool tryPush(T &&item)
+            {
+                std::size_t position = _enqueuePosition.load(std::memory_order_relaxed);
+                Cell *cell;
+                for (;;) {
+                    cell = &_cells[position & _mask];
+                    const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                    const auto difference = static_cast<std::ptrdiff_t>(sequence - position);
+                    if (difference == 0) { // the cell is free for this position, claim it.
+                        if (_enqueuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                    }
+                    else if (difference < 0) { // the cell still holds the item of the previous lap.
+                        return false;
+                    }
+                    else {
+                        position = _enqueuePosition.load(std::memory_order_relaxed);
+                    }
+                }
+                cell->item = std::move(item);
+                cell->sequence.store(position + 1, std::memory_order_release);
+                return true;
+            }
+
+            /** \brief Moves the oldest item to item, returns false when the ring is empty. */
+            bool tryPop(T &item)
+            {
+                std::size_t position = _dequeuePosition.load(std::memory_order_relaxed);
+                Cell *cell;
+                for (;;) {
+                    cell = &_cells[position & _mask];
+                    const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                    const auto difference = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+                    if (difference == 0) { // the cell is filled for this position, claim it.
+                        if (_dequeuePosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                    }
+                    else if (difference < 0) { // the producer did not fill the cell yet.
+                        return false;
+                    }
+                    else {
+                        position = _dequeuePosition.load(std::memory_order_relaxed);
+                    }
+                }
+                item = std::move(cell->item);
+                cell->sequence.store(position + _mask + 1, std::memory_order_release);
+                return true;
+            }
+
+            /** \brief Returns the amount of cells. */
+            std::size_t capacity() const
+            {
+                return _mask + 1;
+            }
+        };
+
+        namespace detail
+        {
+            /** \brief Counts the items of a queue policy and lets consumers wait for them the way Idle prescribes.
+             *
+             *  Producers call pushed() after every successful tryPush, consumers call popped() after
+             *  every successful tryPop. The strategy is a template argument, so the branches of the
+             *  other strategies are not compiled into the consumer loop.
+             */
+            template<IdleStrategy Idle>
+            class Idler
+            {
+            private:
+                std::atomic<std::ptrdiff_t> _available{0}; // negative for a moment when a pop overtakes the count of its push.
+                std::atomic<unsigned int> _parked{0};
+                unsigned int _spinCount;
+                std::mutex _mutex;
+                std::condition_variable _cv;
+            public:
+                explicit Idler(const unsigned int &spinCount)
+                    : _spinCount(spinCount)
+                {
+                }
+
+                /** \brief Counts a pushed item and wakes a parked consumer. */
+                void pushed()
+                {
+                    _available.fetch_add(1);
+                    // the consumer registers before it checks the count, so either it sees the item or it is woken.
+                    if (Idle != IdleStrategy::BusySpin && _parked.load() > 0) {
+                        std::lock_guard<std::mutex> lock(_mutex);
+                        _cv.notify_one();
+                    }
+                }
+
+                /** \brief Counts a popped item. */
+                void popped()
+                {
+                    _available.fetch_sub(1, std::memory_order_relaxed);
+                }
+
+                /** \brief Returns true when there might be an item to pop. */
+                bool available() const
+                {
+                    return _available.load(std::memory_order_relaxed) > 0;
+                }
+
+                /** \brief Waits until an item was pushed or running is false, or spins and returns without waiting.
+                 *
+                 *  The caller tries to pop again when it returns.
+                 */
+                void idle(const std::atomic_bool &running)
+                {
+                    if (Idle == IdleStrategy::BusySpin) {
+                        cpuRelax();
+                        return;
+                    }
+                    if (Idle == IdleStrategy::SpinThenPark) {
+                        for (unsigned int iteration = 0; iteration < _spinCount && running.load(std::memory_order_relaxed); iteration++) {
+                            if (available()) return;
+                            cpuRelax();
+                        }
+                    }
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _parked++;
+                    _cv.wait(lock, [&] { return _available.load() > 0 || !running; });
+                    _parked--;
+                }
+
+                /** \brief Wakes all parked consumers, after running was set to false. */
+                void wakeAll()
+                {
+                    std::lock_guard<std::mutex> lock(_mutex);
+                    _cv.notify_all();
+                }
+            };
+        }
+    }
+}
+
+#endif // CCOL_THREAD_QUEUEPOLICY_HXX
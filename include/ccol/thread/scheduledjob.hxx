@@ -0,0 +1,87 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_SCHEDULEDJOB_HXX
+#define CCOL_THREAD_SCHEDULEDJOB_HXX
+
+#include <memory>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            class ScheduledJobState;
+        }
+
+        /** \brief A handle to a job scheduled with ThreadPool::enqueueAfter(), enqueueAt() or enqueueEvery().
+         *
+         *  The handle is only needed to cancel the job, dropping it does not cancel anything.
+         *  Copies of a handle refer to the same scheduled job.
+         *
+         *      auto heartbeat = threadpool.enqueueEvery(std::chrono::seconds(1), []{ sendHeartbeat(); });
+         *      ...
+         *      heartbeat.cancel();
+         */
+        class ScheduledJob
+        {
+        private:
+            std::shared_ptr<detail::ScheduledJobState> _state;
+        public:
+            /** \brief Creates a handle that refers to no job. */
+            ScheduledJob() = default;
+
+            /** \brief Creates a handle for the state of a scheduled job, used by ThreadPool. */
+            explicit ScheduledJob(std::shared_ptr<detail::ScheduledJobState> state);
+
+            /** \brief Cancels the job.
+             *
+             *  A job that is not yet due is removed from the timer of the pool and destroyed. A
+             *  periodic job is not enqueued again, an occurrence that is already queued is skipped
+             *  and one that is running is not interrupted.
+             *
+             *  \return True when this call cancelled the job, false when it had been cancelled
+             *  before, or when a single shot job had already been enqueued.
+             */
+            bool cancel();
+
+            /** \brief Returns true while the job will still be enqueued, at least once more. */
+            bool isPending() const;
+        };
+    }
+}
+
+#endif // CCOL_THREAD_SCHEDULEDJOB_HXX
@@ -0,0 +1,110 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_STRAND_HXX
+#define CCOL_THREAD_STRAND_HXX
+
+#include <ccol/thread/threadpool.hxx>
+#include <cstddef>
+#include <memory>
+
+namespace ccol
+{
+    namespace thread
+    {
+        /** \brief A Strand executes its jobs one at a time and in the order they were enqueued, on a shared ThreadPool.
+         *
+         *  Use a Strand instead of a dedicated thread or EventQueue when a component needs its jobs
+         *  serialized. Jobs are added to a lock-free queue that recycles its nodes, so a job added
+         *  to a busy Strand neither locks nor allocates. The Strand holds at most one job on the
+         *  ThreadPool while it has work. That job runs up to batchSize jobs of the Strand and
+         *  then enqueues itself again when more work is waiting, so a busy Strand does not starve
+         *  the other users of the pool. An idle Strand costs no pool resources, so a single pool
+         *  can serve tens of thousands of strands.
+         *
+         *      ccol::thread::Strand strand(threadpool);
+         *      strand.enqueue([&connection]{ connection.send(first); });
+         *      strand.enqueue([&connection]{ connection.send(second); }); // runs after first
+         *
+         *  Jobs of a Strand never run concurrently, and a job sees the effects of the jobs that
+         *  ran before it.
+         *
+         *  When the pool drops the job of the Strand, for example by clear(), the jobs that were
+         *  queued on the Strand at that moment are discarded as well, without running them.
+         */
+        class Strand
+        {
+        private:
+            class Impl;
+            std::shared_ptr<Impl> _impl;
+        public:
+            /** \brief Creates a Strand on pool.
+             *
+             *  \param pool The ThreadPool that executes the jobs, it must outlive the Strand.
+             *  \param batchSize The maximum amount of jobs that are run before the Strand gives
+             *  its worker back to the pool.
+             */
+            explicit Strand(ThreadPool &pool, const std::size_t &batchSize = 64);
+
+            Strand(const Strand &) = delete;
+            Strand &operator=(const Strand &) = delete;
+
+            /** \brief Adds a job to the end of the Strand.
+             *
+             *  Can be called from any thread, including from jobs of the Strand itself.
+             *
+             *  \param job The job to execute.
+             */
+            void enqueue(Job &&job);
+
+            /** \brief Returns the amount of jobs that were enqueued and have not finished yet. */
+            std::size_t pendingCount() const;
+
+            /** \brief Blocks until all jobs that were enqueued have finished.
+             *
+             *  Must not be called from a job of this Strand.
+             */
+            void wait();
+
+            /** \brief The destructor waits until all jobs of the Strand have finished.
+             *
+             *  A Strand must not be destroyed by one of its own jobs.
+             */
+            virtual ~Strand();
+        };
+    }
+}
+
+#endif // CCOL_THREAD_STRAND_HXX
@@ -0,0 +1,143 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_TASKGRAPH_HXX
+#define CCOL_THREAD_TASKGRAPH_HXX
+
+#include <ccol/thread/threadpool.hxx>
+#include <chrono>
+#include <cstddef>
+#include <functional>
+#include <memory>
+
+namespace ccol
+{
+    namespace thread
+    {
+        /** \brief A directed acyclic graph of tasks that is executed on a ThreadPool.
+         *
+         *  Declare the tasks with addNode() and the order between them with addEdge(), then
+         *  execute the graph with run() or start(). A task is enqueued as soon as all tasks it
+         *  depends on have finished. Every node has an atomic counter of unfinished dependencies,
+         *  the task that brings a counter to zero releases the node, so no lock is shared by the
+         *  tasks. One released node is executed directly by the job that released it, the others
+         *  are enqueued.
+         *
+         *  A graph can be executed any amount of times. Only the first run after a change of the
+         *  graph allocates, later runs only enqueue jobs.
+         *
+         *  On a pool with ThreadPoolOptions::helpWhileWaiting, wait(), wait_for() and run() execute
+         *  queued jobs, the tasks of the graph among them, instead of blocking. A job may then run
+         *  a graph on its own pool, even when that pool has a single worker.
+         *
+         *  Throwing an uncaught exception from a task will terminate the program, just like a job
+         *  on the ThreadPool.
+         *
+         *      ccol::thread::TaskGraph graph;
+         *      auto load = graph.addNode([]{ loadInput(); });
+         *      auto left = graph.addNode([]{ processLeft(); });
+         *      auto right = graph.addNode([]{ processRight(); });
+         *      auto merge = graph.addNode([]{ mergeResults(); });
+         *      graph.addEdge(load, left);
+         *      graph.addEdge(load, right);
+         *      graph.addEdge(left, merge);
+         *      graph.addEdge(right, merge);
+         *      graph.run(threadpool);
+         */
+        class TaskGraph
+        {
+        private:
+            class Impl;
+            std::unique_ptr<Impl> _impl;
+        public:
+            /** \brief Identifies a node of the graph. */
+            typedef std::size_t NodeId;
+
+            /** \brief Creates an empty graph. */
+            TaskGraph();
+
+            /** \brief Adds a task to the graph.
+             *
+             *  The graph must not be running.
+             *
+             *  \param task The task, it is executed once every run.
+             *  \return The id of the node, ids are assigned in order starting at 0.
+             */
+            NodeId addNode(std::function<void()> task);
+
+            /** \brief Declares that the task of to runs after the task of from has finished.
+             *
+             *  The graph must not be running.
+             *
+             *  \param from The node that must finish first.
+             *  \param to The node that depends on from.
+             *  \return False when one of the ids is unknown or both are the same node.
+             */
+            bool addEdge(const NodeId &from, const NodeId &to);
+
+            /** \brief Returns the amount of nodes. */
+            std::size_t nodeCount() const;
+
+            /** \brief Starts executing the graph on the pool and returns immediately.
+             *
+             *  \param pool The ThreadPool that executes the tasks.
+             *  \return False when the graph contains a cycle or is still running.
+             */
+            bool start(ThreadPool &pool);
+
+            /** \brief Blocks until the run that was started has finished. */
+            void wait();
+
+            /** \brief Blocks until the run that was started has finished or the timeout expires.
+             *
+             *  \param timeout The maximum time to wait.
+             *  \return True when the run has finished.
+             */
+            bool wait_for(const std::chrono::nanoseconds &timeout);
+
+            /** \brief Executes the graph on the pool and waits until all tasks have finished.
+             *
+             *  \param pool The ThreadPool that executes the tasks.
+             *  \return False when the graph contains a cycle or is still running.
+             */
+            bool run(ThreadPool &pool);
+
+            /** \brief The destructor waits until a running graph has finished. */
+            virtual ~TaskGraph();
+        };
+    }
+}
+
+#endif // CCOL_THREAD_TASKGRAPH_HXX
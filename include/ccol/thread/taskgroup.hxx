@@ -0,0 +1,169 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_TASKGROUP_HXX
+#define CCOL_THREAD_TASKGROUP_HXX
+
+#include <ccol/thread/threadpool.hxx>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            /** \brief The counter and waiter shared by a TaskGroup and its jobs. */
+            class TaskGroupState
+            {
+            private:
+                std::atomic<std::size_t> _pending{0};
+                std::atomic_bool _waiting{false};
+                std::mutex _mutex;
+                std::condition_variable _cv;
+            public:
+                void started() { _pending.fetch_add(1, std::memory_order_relaxed); }
+                void finished();
+                std::size_t pending() const { return _pending.load(); }
+                void wait();
+                bool wait_for(const std::chrono::nanoseconds &timeout);
+            };
+
+            /** \brief Marks a job of a TaskGroup as finished when it has run or when it is dropped without running. */
+            class TaskGroupTicket
+            {
+            private:
+                std::shared_ptr<TaskGroupState> _state;
+            public:
+                explicit TaskGroupTicket(std::shared_ptr<TaskGroupState> state) noexcept : _state(std::move(state)) {}
+                TaskGroupTicket(TaskGroupTicket &&other) noexcept = default;
+                TaskGroupTicket &operator=(TaskGroupTicket &&other) = delete;
+                void finish()
+                {
+                    if (_state) {
+                        _state->finished();
+                        _state.reset();
+                    }
+                }
+                ~TaskGroupTicket() { finish(); }
+            };
+        }
+
+        /** \brief A TaskGroup tracks a set of jobs on a ThreadPool so they can be waited for together.
+         *
+         *  ThreadPool::wait() waits until the whole pool is idle, which includes the work of every
+         *  other user of the pool. A TaskGroup counts only the jobs that were enqueued through it,
+         *  so independent callers that share a pool can each wait for their own work:
+         *
+         *      ccol::thread::TaskGroup group(threadpool);
+         *      for (auto &item : items) {
+         *          group.enqueue([&item]{ process(item); });
+         *      }
+         *      group.wait();
+         *
+         *  Finishing a job only decrements an atomic counter. The job that brings the counter to
+         *  zero wakes the waiters of this group, and only when a thread is waiting.
+         *
+         *  A job that is removed from the pool without running, by clear(), dequeueAll() or
+         *  purgeCancelled(), counts as finished once it is destroyed.
+         *
+         *  When the pool helps while waiting, see ThreadPoolOptions::helpWhileWaiting, wait()
+         *  executes queued jobs of the pool, so a job can fork a group and join it without
+         *  blocking its worker.
+         */
+        class TaskGroup
+        {
+        private:
+            ThreadPool &_pool;
+            std::shared_ptr<detail::TaskGroupState> _state;
+        public:
+            /** \brief Creates an empty group that enqueues its jobs on pool.
+             *  \param pool The ThreadPool that executes the jobs, it must outlive the group.
+             */
+            explicit TaskGroup(ThreadPool &pool);
+
+            TaskGroup(const TaskGroup &) = delete;
+            TaskGroup &operator=(const TaskGroup &) = delete;
+
+            /** \brief Enqueues a function on the pool as part of this group.
+             *
+             *  The function and the bookkeeping of the group are stored in a single Job, so a
+             *  function that fits the inline buffer of Job does not allocate. The function is
+             *  destroyed before the job is marked as finished.
+             *
+             *  \param function The function to execute, it is invoked without arguments.
+             */
+            template<class F>
+            void enqueue(F &&function)
+            {
+                typedef typename std::decay<F>::type Function;
+                _state->started();
+                detail::TaskGroupTicket ticket(_state);
+                _pool.enqueue(Job([function = Function(std::forward<F>(function)), ticket = std::move(ticket)]() mutable {
+                    {
+                        Function run(std::move(function));
+                        run();
+                    }
+                    ticket.finish();
+                }));
+            }
+
+            /** \brief Returns the amount of jobs of this group that have not finished yet. */
+            std::size_t pendingCount() const;
+
+            /** \brief Blocks until all jobs of this group have finished. */
+            void wait();
+
+            /** \brief Blocks until all jobs of this group have finished or the timeout expires.
+             *
+             *  \param timeout The maximum time to wait.
+             *  \return True when all jobs have finished.
+             */
+            bool wait_for(const std::chrono::nanoseconds &timeout);
+
+            /** \brief The destructor waits until all jobs of this group have finished. */
+            virtual ~TaskGroup();
+        };
+    }
+}
+
+#endif // CCOL_THREAD_TASKGROUP_HXX
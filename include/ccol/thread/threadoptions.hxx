@@ -0,0 +1,146 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+
+#ifndef CCOL_THREAD_THREADOPTIONS_HXX
+#define CCOL_THREAD_THREADOPTIONS_HXX
+
+#include <cstddef>
+#include <functional>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ccol
+{
+    namespace thread
+    {
+        /** \brief The operating system scheduling policy of a thread, see ThreadOptions. */
+        enum class SchedulingPolicy
+        {
+            /** \brief Keep the policy of the thread that creates the thread. */
+            Inherit,
+
+            /** \brief The default time sharing policy, SCHED_OTHER. */
+            Other,
+
+            /** \brief Time sharing for throughput oriented threads, SCHED_BATCH. */
+            Batch,
+
+            /** \brief Only runs when the CPU has nothing else to do, SCHED_IDLE. */
+            Idle,
+
+            /** \brief Real time first in first out with ThreadOptions::priority, SCHED_FIFO. */
+            Fifo,
+
+            /** \brief Real time round robin with ThreadOptions::priority, SCHED_RR. */
+            RoundRobin
+        };
+
+        /** \brief How the threads of ThreadPool, Timer and the thread that runs an EventQueue are set up.
+         *
+         *      ccol::thread::ThreadPoolOptions options;
+         *      options.threadOptions.cpuSets = {{2}, {3}, {4}, {5}};
+         *      options.threadOptions.policy = ccol::thread::SchedulingPolicy::Fifo;
+         *      options.threadOptions.priority = 10;
+         *      options.threadOptions.name = "io";
+         *
+         *  The stack size is set when the thread is created, the other options by the thread itself
+         *  before it runs its first job or callback. Settings the system refuses, for example a
+         *  real time policy without the permission, leave the thread as it was. Only Linux is
+         *  supported, elsewhere the options are ignored.
+         */
+        struct ThreadOptions
+        {
+            /** \brief The CPUs the threads may run on, none restricts nothing.
+             *
+             *  Numbered threads, like the workers of a ThreadPool, use the set at their number modulo
+             *  the amount of sets, other threads use the first set. For a ThreadPool with
+             *  Scheduling::Numa a set replaces the CPUs of the node of the worker.
+             */
+            std::vector<std::vector<unsigned int>> cpuSets;
+
+            /** \brief The scheduling policy. */
+            SchedulingPolicy policy = SchedulingPolicy::Inherit;
+
+            /** \brief The static priority of the Fifo and RoundRobin policies, 1 to 99 on Linux. */
+            int priority = 0;
+
+            /** \brief The stack size in bytes, 0 keeps the default of the system.
+             *
+             *  std::thread takes no attributes, so the default thread attributes of the process are
+             *  changed while the thread is created and restored right after. A thread that other
+             *  code creates at that moment may get the stack size as well.
+             */
+            std::size_t stackSize = 0;
+
+            /** \brief The name of the threads, empty keeps the name.
+             *
+             *  Numbered threads get their number appended. Linux truncates names to 15 characters.
+             */
+            std::string name;
+        };
+
+        /** \brief Applies the CPU set, scheduling policy and name of options to the calling thread.
+         *
+         *  \return False when the system refused a setting.
+         */
+        bool applyThreadOptions(const ThreadOptions &options);
+
+        /** \brief Starts a thread with the stack size of options that applies the other options before it calls function.
+         *
+         *      std::thread loop = ccol::thread::createThread(options, [&queue]{ queue.run(); });
+         *
+         *  \param options The options of the thread.
+         *  \param function The function the thread executes.
+         *  \return The started thread.
+         */
+        std::thread createThread(const ThreadOptions &options, std::function<void()> function);
+
+        namespace detail
+        {
+            /** \brief The number of a thread that is not numbered, see ThreadOptions. */
+            constexpr unsigned int unnumbered = static_cast<unsigned int>(-1);
+
+            /** \brief Applies options to the calling thread as thread number index. */
+            bool applyThreadOptions(const ThreadOptions &options, const unsigned int &index);
+
+            /** \brief Starts a thread that executes function with a stack of stackSize bytes, 0 for the default. */
+            std::thread createThread(const std::size_t &stackSize, std::function<void()> &&function);
+        }
+    }
+}
+
+#endif // CCOL_THREAD_THREADOPTIONS_HXX
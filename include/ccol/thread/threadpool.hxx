@@ -36,12 +36,21 @@
 #ifndef CCOPENLIB_THREADPOOL_H
 #define CCOPENLIB_THREADPOOL_H
 
+#include <ccol/thread/job.hxx>
+#include <ccol/thread/scheduledjob.hxx>
+#include <ccol/thread/threadpooloptions.hxx>
+#include <ccol/thread/threadpoolmetrics.hxx>
+#include <ccol/thread/workercontext.hxx>
+#include <ccol/util/blockpool.hxx>
+#include <ccol/util/cancellationtoken.hxx>
 #include <memory>
 #include <vector>
 #include <queue>
 #include <functional>
 #include <thread>
 #include <chrono>
+#include <type_traits>
+#include <utility>
 
 namespace ccol
 {
@@ -50,6 +59,11 @@ namespace ccol
      */
     namespace thread {
 
+        template<class T> class Future;
+#ifdef CCOL_ENABLE_COROUTINES
+        class ThreadPoolAwaitable;
+#endif
+
         /** \brief The ThreadPool provides thread pooling functionality.
          *
          *  It uses a pool of std::thread instances internally.
@@ -64,6 +78,8 @@ namespace ccol
         private:
             class Impl;
             std::unique_ptr<Impl> _impl;
+            WorkerContext &acquireContext();
+            void releaseContext(WorkerContext &context);
         public:
 
             /** \brief Default constructor
@@ -105,13 +121,29 @@ namespace ccol
              */
             ThreadPool(const unsigned int &threads, const std::function<void(std::thread&)> &threadCreateCallback);
 
-            /** \brief Enqueue a job by copy.
+            /** \brief Contructor to create an instance of ThreadPool with the provided options.
+             *
+             *  Use this constructor to select the scheduling strategy of the pool, for example
+             *  Scheduling::WorkStealing. See ThreadPoolOptions for all available options.
              *
-             *  Enqueues a job on the threadpool by making a copy of the passed job.
+             *  \param options The options of the thread pool.
+             */
+            ThreadPool(const ThreadPoolOptions &options);
+
+            /**  \brief Enqueue a job by using move semantics.
+             *
+             *  Enqueues a job on the threadpool by using move semantics the job to the queue.
+             *
+             *  Any callable can be passed, including lambdas that capture move-only types. Callables
+             *  that fit in the inline buffer of Job are enqueued without a heap allocation.
+             *  A std::function is copied into the job when passed as lvalue.
+             *
+             *  When the queue of a pool that uses Scheduling::Bounded is full, the job is handled
+             *  according to ThreadPoolOptions::overflow. This applies to all enqueue overloads.
              *
              *  \param job The job to be executed.
              */
-            void enqueue(const std::function<void()> &job);
+            void enqueue(Job &&job);
 
             /** \brief Enqueue multiple jobs by copy.
              *
@@ -134,29 +166,263 @@ namespace ccol
              */
             void enqueue(std::queue<std::function<void()>> jobs); // copy because we need to pop...
 
-            /**  \brief Enqueue a job by using move semantics.
+            /** \brief Enqueue multiple jobs by using move semantics.
              *
-             *  Enqueues a job on the threadpool by using move semantics the job to the queue.
+             *  Enqueues multiple jobs on the threadpool by using move semantics the job to the queue.
              *
-             *  \param job The job to be executed.
+             *  \param jobs A std::vector containing the jobs to be executed.
              */
-            void enqueue(std::function<void()> &&job);
+            void enqueue(std::vector<std::function<void()>> &&jobs);
 
             /** \brief Enqueue multiple jobs by using move semantics.
              *
-             *  Enqueues multiple jobs on the threadpool by using move semantics the job to the queue.
+             *  Enqueues multiple jobs on the threadpool by using move semantics.
+             *
+             *  \param jobs A std::queue containing the jobs to be executed.
+             */
+            void enqueue(std::queue<std::function<void()>> &&jobs);
+
+            /** \brief Enqueue multiple jobs by using move semantics.
+             *
+             *  Enqueues multiple jobs on the threadpool by using move semantics.
              *
              *  \param jobs A std::vector containing the jobs to be executed.
              */
-            void enqueue(std::vector<std::function<void()>> &&jobs);
+            void enqueue(std::vector<Job> &&jobs);
 
             /** \brief Enqueue multiple jobs by using move semantics.
              *
              *  Enqueues multiple jobs on the threadpool by using move semantics.
              *
+             *  This overload accepts the queue returned by dequeueAll().
+             *
              *  \param jobs A std::queue containing the jobs to be executed.
              */
-            void enqueue(std::queue<std::function<void()>> &&jobs);
+            void enqueue(std::queue<Job> &&jobs);
+
+            /** \brief Enqueue a job unless the queue is full.
+             *
+             *  Only a pool that uses Scheduling::Bounded can be full, other pools always accept the
+             *  job.
+             *
+             *  \param job The job to be executed, it is left untouched when false is returned.
+             *  \return True when the job has been enqueued.
+             */
+            bool tryEnqueue(Job &&job);
+
+            /** \brief Enqueue a job, waiting at most timeout for space in the queue.
+             *
+             *  \param job The job to be executed, it is left untouched when false is returned.
+             *  \param timeout The maximum time to wait for space.
+             *  \return True when the job has been enqueued.
+             */
+            bool tryEnqueueFor(Job &&job, const std::chrono::nanoseconds &timeout);
+
+            /** \brief Enqueue a job with a priority class.
+             *
+             *  Jobs of a higher priority are executed before jobs of a lower priority, unless the
+             *  lower priority job has aged, see ThreadPoolOptions::agingInterval.
+             *
+             *  Priorities are only honoured when the pool uses Scheduling::SharedQueue, other
+             *  scheduling strategies treat all jobs equally.
+             *
+             *  \param priority The priority class of the job.
+             *  \param job The job to be executed.
+             */
+            void enqueue(const Priority &priority, Job &&job);
+
+            /** \brief Enqueue a job with a priority class on behalf of a tenant.
+             *
+             *  Within a priority class the tenants share the pool in proportion to their weights,
+             *  see setTenantWeight().
+             *
+             *  \param priority The priority class of the job.
+             *  \param tenant The tenant the job belongs to.
+             *  \param job The job to be executed.
+             */
+            void enqueue(const Priority &priority, const TenantId &tenant, Job &&job);
+
+            /** \brief Enqueue multiple jobs with a priority class.
+             *
+             *  \param priority The priority class of the jobs.
+             *  \param jobs A std::vector containing the jobs to be executed.
+             */
+            void enqueue(const Priority &priority, std::vector<Job> &&jobs);
+
+            /** \brief Enqueue multiple jobs with a priority class on behalf of a tenant.
+             *
+             *  \param priority The priority class of the jobs.
+             *  \param tenant The tenant the jobs belong to.
+             *  \param jobs A std::vector containing the jobs to be executed.
+             */
+            void enqueue(const Priority &priority, const TenantId &tenant, std::vector<Job> &&jobs);
+
+            /** \brief Sets the weight of a tenant.
+             *
+             *  A tenant with weight 3 gets three jobs dispatched for every job of a tenant with
+             *  weight 1 in the same priority class, as long as both have jobs waiting. Tenants
+             *  default to weight 1. A tenant that was idle does not get credit for the time it
+             *  was idle.
+             *
+             *  The pool keeps the weight of every tenant that does not have the default weight,
+             *  set the weight back to 1 to release it. Idle tenants with the default weight cost
+             *  nothing, so ephemeral tenant ids can be used as long as they keep the default weight.
+             *
+             *  \param tenant The tenant.
+             *  \param weight The weight, 0 is treated as 1 and weights above 1048576 as 1048576.
+             */
+            void setTenantWeight(const TenantId &tenant, const unsigned int &weight);
+
+            /** \brief Enqueue a job that is skipped when its token is cancelled.
+             *
+             *  A worker that dequeues the job after the CancellationTokenSource of the token has been
+             *  cancelled drops it without running it. Use purgeCancelled() to remove cancelled jobs
+             *  from the queue at once. A job that is already running is not interrupted.
+             *
+             *  Note that a default constructed CancellationToken counts as cancelled.
+             *
+             *  \param token The token the job is tied to.
+             *  \param job The job to be executed.
+             */
+            void enqueue(const util::CancellationToken &token, Job &&job);
+
+            /** \brief Enqueue multiple jobs that are skipped when their token is cancelled.
+             *
+             *  \param token The token the jobs are tied to.
+             *  \param jobs A std::vector containing the jobs to be executed.
+             */
+            void enqueue(const util::CancellationToken &token, std::vector<Job> &&jobs);
+
+            /** \brief Removes all queued jobs whose token has been cancelled.
+             *
+             *  Other jobs stay queued in their order. A pool that uses Scheduling::Bounded can not
+             *  remove jobs from its ring, it drops cancelled jobs when they are dequeued instead.
+             *
+             *  \return The amount of removed jobs.
+             */
+            size_t purgeCancelled();
+
+            /** \brief Enqueue a job on a NUMA node.
+             *
+             *  When the pool uses Scheduling::Numa the job is queued on the provided node instead of
+             *  the node of the calling thread. It is executed by a worker of that node, unless the
+             *  workers of another node run out of work and take it. Other scheduling strategies
+             *  ignore the node.
+             *
+             *  \param node The index of the node, see nodeCount().
+             *  \param job The job to be executed.
+             */
+            void enqueueOnNode(const unsigned int &node, Job &&job);
+
+            /** \brief Enqueue a job on the worker that the key is routed to.
+             *
+             *  The key is hashed to a preferred worker, so the jobs of one session or shard keep
+             *  their data in the cache of one core. Jobs with the same key run in the order they
+             *  were enqueued, and never concurrently. A worker runs the jobs routed to it before it
+             *  takes jobs from the shared queue.
+             *
+             *  A key only moves to another worker when it has no pending jobs and the backlog of
+             *  its preferred worker exceeds the backlog of the least busy worker by more than
+             *  ThreadPoolOptions::affinitySkew.
+             *
+             *  Keyed jobs bypass the scheduling strategy, they are not bounded by queueCapacity and
+             *  ignore priorities. An elastic pool routes keys to its first minThreads workers, which
+             *  never stop; with minThreads 0 keyed jobs are enqueued like any other job.
+             *
+             *  A keyed job that helps while waiting, see ThreadPoolOptions::helpWhileWaiting, only
+             *  runs jobs of the shared queue, so it never runs a job of its own key nested. It must
+             *  not wait for a job that is routed to its own worker.
+             *
+             *  \param key The key of the job.
+             *  \param job The job to be executed.
+             */
+            void enqueue(const AffinityKey &key, Job &&job);
+
+            /** \brief Enqueue a job that is only useful when it starts before a deadline.
+             *
+             *  A worker that dequeues the job after the deadline does not run it, it hands the job
+             *  to ThreadPoolOptions::deadlineMissedCallback or destroys it, and counts the miss in
+             *  ThreadPoolMetrics::deadlineMisses. A job that started in time is not interrupted.
+             *
+             *  A pool that uses Scheduling::Deadline executes the job with the earliest deadline
+             *  first, other scheduling strategies keep their order and only skip expired jobs.
+             *
+             *  \param deadline The latest time the job may start.
+             *  \param job The job to be executed.
+             */
+            void enqueue(const std::chrono::steady_clock::time_point &deadline, Job &&job);
+
+            /** \brief Enqueue a job once a delay has passed.
+             *
+             *  All delayed and periodic jobs of a pool share one timer thread, which is started
+             *  when the first job is scheduled, so scheduling a job costs no thread. The timer
+             *  thread enqueues the job when it is due, from then on it is a normal job that waits
+             *  for a worker. Jobs that are not yet due are not counted by totalJobCount() and are
+             *  not waited for by wait(), see scheduledCount(). They are destroyed with the pool.
+             *
+             *  \param delay The time after which the job is enqueued.
+             *  \param job The job to be executed.
+             *  \return A handle to cancel the job.
+             */
+            ScheduledJob enqueueAfter(const std::chrono::nanoseconds &delay, Job &&job);
+
+            /** \brief Enqueue a job at a point in time.
+             *
+             *  A time point in the past enqueues the job right away. See enqueueAfter().
+             *
+             *  \param timePoint The time at which the job is enqueued.
+             *  \param job The job to be executed.
+             *  \return A handle to cancel the job.
+             */
+            ScheduledJob enqueueAt(const std::chrono::steady_clock::time_point &timePoint, Job &&job);
+
+            /** \brief Enqueue a job every interval, until it is cancelled.
+             *
+             *  The job is first enqueued after one interval. Occurrences are scheduled at a fixed
+             *  rate, an occurrence is skipped while the previous one is still queued or running, so
+             *  the job never runs concurrently with itself. See enqueueAfter().
+             *
+             *      auto flush = threadpool.enqueueEvery(std::chrono::milliseconds(100), [&log]{ log.flush(); });
+             *      ...
+             *      flush.cancel();
+             *
+             *  \param interval The time between occurrences, 0 is treated as 1 nanosecond.
+             *  \param job The job to be executed.
+             *  \return A handle to cancel the job.
+             */
+            ScheduledJob enqueueEvery(const std::chrono::nanoseconds &interval, Job &&job);
+
+            /** \brief Returns the amount of delayed and periodic jobs that wait for their time. */
+            size_t scheduledCount();
+
+            /** \brief Enqueue a function that gets the WorkerContext of the worker that executes it.
+             *
+             *      threadpool.enqueueWithContext([](ccol::thread::WorkerContext &context) {
+             *          auto &parser = context.get<Parser>();
+             *          void *scratch = context.arena().allocate(4096);
+             *          // scratch is released when the job returns.
+             *      });
+             *
+             *  The function is stored in a Job together with the pool, so a small function does not
+             *  allocate.
+             *
+             *  \param function The function to execute, it is invoked with a WorkerContext&.
+             */
+            template<class F>
+            void enqueueWithContext(F &&function);
+
+            /** \brief Enqueue multiple jobs on a NUMA node.
+             *
+             *  \param node The index of the node, see nodeCount().
+             *  \param jobs A std::vector containing the jobs to be executed.
+             */
+            void enqueueOnNode(const unsigned int &node, std::vector<Job> &&jobs);
+
+            /** \brief Returns the amount of NUMA nodes the pool distributes its workers over.
+             *
+             *  \return The amount of nodes with CPUs when the pool uses Scheduling::Numa, otherwise 1.
+             */
+            unsigned int nodeCount() const;
 
             /** Returns the the total amount of jobs. (Currently processing + jobs in queue)
              *
@@ -171,11 +437,29 @@ namespace ccol
             size_t queueCount();
 
             /** \brief Returns the amount of threads in the pool.
+             *
+             *  The amount of threads of an elastic pool changes while it runs, in that case the
+             *  amount of threads that are alive at the moment of the call is returned.
              *
              *  \return The amount of threads in the pool.
              */
             unsigned int threadCount() const;
 
+            /** \brief Returns the maximum amount of threads of the pool.
+             *
+             *  \return ThreadPoolOptions::maxThreads for an elastic pool, otherwise threadCount().
+             */
+            unsigned int maxThreadCount() const;
+
+            /** \brief Returns a snapshot of the metrics of the pool.
+             *
+             *  The per worker counters and histograms are only collected when the pool was created
+             *  with ThreadPoolOptions::metrics. Taking a snapshot does not lock or stop the workers.
+             *
+             *  \return The metrics of the pool.
+             */
+            ThreadPoolMetrics metrics() const;
+
             /**  \brief Removes all jobs from the queue. */
             void clear();
 
@@ -184,10 +468,14 @@ namespace ccol
              *  This can be used to 'pause' the processing of jobs on the threadpool.
              *  \return A std::queue with the jobs that where pending for execution
              */
-            std::queue<std::function<void()>> dequeueAll();
+            std::queue<Job> dequeueAll();
 
             /**
              * \brief Wait until all jobs are processed.
+             *
+             * With ThreadPoolOptions::helpWhileWaiting the calling thread executes queued jobs while
+             * it waits, and a job that calls wait() waits for all jobs except itself and the other
+             * jobs that are waiting.
              */
             void wait();
 
@@ -198,6 +486,40 @@ namespace ccol
             */
             bool wait_for(const std::chrono::nanoseconds &timeout);
 
+            /** \brief Returns true when the pool was created with ThreadPoolOptions::helpWhileWaiting. */
+            bool helpsWhileWaiting() const;
+
+            /** \brief Executes one queued job on the calling thread.
+             *
+             *  A worker of this pool runs the jobs routed to it by key first.
+             *
+             *  \return False when no job was queued.
+             */
+            bool runPendingJob();
+
+            /** \brief Executes queued jobs on the calling thread until done returns true.
+             *
+             *  When no job is queued the thread sleeps until a job is enqueued or finishes, so done
+             *  must become true as a result of a job of this pool. done is called with a lock of the
+             *  pool held, it must be cheap and must not use the pool.
+             *
+             *      std::atomic_int remaining{2};
+             *      threadpool.enqueue([&]{ left(); remaining--; });
+             *      threadpool.enqueue([&]{ right(); remaining--; });
+             *      threadpool.helpUntil([&]{ return remaining == 0; });
+             *
+             *  \param done The condition to wait for.
+             */
+            void helpUntil(const std::function<bool()> &done);
+
+            /** \brief Executes queued jobs on the calling thread until done returns true or the timeout expires.
+             *
+             *  \param done The condition to wait for, see helpUntil().
+             *  \param timeout The maximum time to wait, a running job is not interrupted.
+             *  \return The result of done.
+             */
+            bool helpUntilFor(const std::function<bool()> &done, const std::chrono::nanoseconds &timeout);
+
             /** \brief Wraps the provided job in another lambda function that will execute the job on the provided ThreadPool.
              *
              * The lambda function provided will be wrapped in the returned lambda function that each time it is
@@ -213,6 +535,43 @@ namespace ccol
              */
             std::function<void()> wrap(const std::function<void()> &job);
 
+            /** \brief Submit a function and get a Future for its result.
+             *
+             *  The shared state of the future is allocated from the BlockPool of this ThreadPool.
+             *  Use Future::then() to schedule a continuation on this ThreadPool when the result is
+             *  available, without blocking a thread.
+             *
+             *  Defined in ccol/thread/future.hxx, which is included by this header.
+             *
+             *  \param function The function to execute, it is invoked without arguments.
+             *  \return A Future that provides the result of the function.
+             */
+            template<class F>
+            Future<typename std::result_of<typename std::decay<F>::type&()>::type> submit(F &&function);
+
+            /** \brief Returns the BlockPool used to allocate shared states of futures and other small objects of this ThreadPool.
+             *
+             *  The BlockPool is shared, objects allocated from it may outlive the ThreadPool as long
+             *  as they keep a copy of the std::shared_ptr.
+             *
+             *  \return The BlockPool of this ThreadPool.
+             */
+            const std::shared_ptr<util::BlockPool> &blockPool() const;
+
+#ifdef CCOL_ENABLE_COROUTINES
+            /** \brief Returns an awaitable that resumes the awaiting coroutine on a worker of this ThreadPool.
+             *
+             *      co_await pool.schedule();
+             *      // continues on a worker thread
+             *
+             *  Each hop enqueues a single Job that stores the coroutine handle inline, no
+             *  std::function is allocated.
+             *
+             *  \return The awaitable, see ccol/thread/coroutine.hxx.
+             */
+            ThreadPoolAwaitable schedule();
+#endif
+
             /** \brief The destructor
              *
              *  Destructing the threadpool will lead to the std::thread to be stopped and
@@ -222,7 +581,25 @@ namespace ccol
              */
             virtual ~ThreadPool();
         };
+
+        template<class F>
+        void ThreadPool::enqueueWithContext(F &&function)
+        {
+            typedef typename std::decay<F>::type Function;
+            enqueue(Job([this, function = Function(std::forward<F>(function))]() mutable {
+                WorkerContext &context = acquireContext();
+                const util::BumpArena::Marker marker = context.arena().mark();
+                function(context);
+                context.arena().rewind(marker);
+                releaseContext(context);
+            }));
+        }
     }
 }
 
+#include <ccol/thread/future.hxx>
+#ifdef CCOL_ENABLE_COROUTINES
+#include <ccol/thread/coroutine.hxx>
+#endif
+
 #endif // CCOPENLIB_THREADPOOL_H
@@ -0,0 +1,194 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_THREADPOOLMETRICS_HXX
+#define CCOL_THREAD_THREADPOOLMETRICS_HXX
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace ccol
+{
+    namespace thread
+    {
+        /** \brief A histogram of durations with logarithmic buckets.
+         *
+         *  Bucket 0 counts durations of 0ns, bucket i counts durations in the range
+         *  [2^(i-1), 2^i) nanoseconds. The relative error of a value read from the histogram is
+         *  therefore at most a factor 2, with a fixed size that covers every duration.
+         */
+        struct DurationHistogram
+        {
+            /** \brief The amount of buckets. */
+            static constexpr std::size_t bucketCount = 64;
+
+            /** \brief The amount of durations per bucket. */
+            std::array<std::uint64_t, bucketCount> buckets{};
+
+            /** \brief Returns the bucket a duration is counted in. */
+            static std::size_t bucketOf(const std::chrono::nanoseconds &duration)
+            {
+                std::uint64_t value = duration.count() > 0 ? static_cast<std::uint64_t>(duration.count()) : 0;
+                std::size_t bucket = 0;
+                while (value != 0) {
+                    value >>= 1;
+                    bucket++;
+                }
+                return bucket < bucketCount ? bucket : bucketCount - 1;
+            }
+
+            /** \brief Returns the exclusive upper bound of the durations counted in a bucket. */
+            static std::chrono::nanoseconds bucketUpperBound(const std::size_t &bucket)
+            {
+                if (bucket >= bucketCount - 1) return std::chrono::nanoseconds::max();
+                return std::chrono::nanoseconds(std::int64_t(1) << bucket);
+            }
+
+            /** \brief Returns the amount of durations in the histogram. */
+            std::uint64_t count() const
+            {
+                std::uint64_t result = 0;
+                for (const auto bucket : buckets) {
+                    result += bucket;
+                }
+                return result;
+            }
+
+            /** \brief Returns the upper bound of the bucket that contains the provided percentile.
+             *
+             *  \param percentile A value between 0 and 100, for example 99 for the 99th percentile.
+             *  \return The duration that the given percentage of durations is below, 0 when empty.
+             */
+            std::chrono::nanoseconds percentile(const double &percentile) const
+            {
+                const std::uint64_t total = count();
+                if (total == 0) return std::chrono::nanoseconds(0);
+                const double rank = total * percentile / 100.0;
+                std::uint64_t seen = 0;
+                for (std::size_t bucket = 0; bucket < bucketCount; bucket++) {
+                    seen += buckets[bucket];
+                    if (seen > 0 && seen >= rank) return bucketUpperBound(bucket);
+                }
+                return bucketUpperBound(bucketCount - 1);
+            }
+
+            /** \brief Adds the durations of another histogram. */
+            DurationHistogram &operator+=(const DurationHistogram &other)
+            {
+                for (std::size_t bucket = 0; bucket < bucketCount; bucket++) {
+                    buckets[bucket] += other.buckets[bucket];
+                }
+                return *this;
+            }
+        };
+
+        /** \brief The counters of one worker of a ThreadPool. */
+        struct WorkerMetrics
+        {
+            /** \brief The amount of jobs the worker executed. */
+            std::uint64_t jobsExecuted = 0;
+
+            /** \brief The total time the worker spent executing jobs. */
+            std::chrono::nanoseconds busyTime{0};
+
+            /** \brief The total time between the jobs of the worker, spinning or sleeping. */
+            std::chrono::nanoseconds idleTime{0};
+
+            /** \brief The time the jobs executed by the worker spent in the queue. */
+            DurationHistogram queueWaitTime;
+
+            /** \brief The time the worker spent executing each job. */
+            DurationHistogram runTime;
+        };
+
+        /** \brief A snapshot of the metrics of a ThreadPool, see ThreadPool::metrics().
+         *
+         *  The counters of every worker are consistent with each other, they are read without
+         *  stopping the worker. Snapshots only grow, the activity in an interval is the difference
+         *  of two snapshots.
+         */
+        struct ThreadPoolMetrics
+        {
+            /** \brief The metrics per worker, indexed by worker index.
+             *
+             *  Empty unless the pool was created with ThreadPoolOptions::metrics. An elastic pool
+             *  has an entry for every thread it may start.
+             */
+            std::vector<WorkerMetrics> workers;
+
+            /** \brief The amount of queued jobs at the moment of the snapshot. */
+            std::size_t queued = 0;
+
+            /** \brief The amount of queued and executing jobs at the moment of the snapshot. */
+            std::size_t total = 0;
+
+            /** \brief The amount of threads at the moment of the snapshot. */
+            unsigned int threads = 0;
+
+            /** \brief The amount of jobs that were not started before their deadline.
+             *
+             *  Counted whether or not the pool was created with ThreadPoolOptions::metrics.
+             */
+            std::uint64_t deadlineMisses = 0;
+
+            /** \brief Returns the sum of the metrics of all workers. */
+            WorkerMetrics combined() const
+            {
+                WorkerMetrics result;
+                for (const auto &worker : workers) {
+                    result.jobsExecuted += worker.jobsExecuted;
+                    result.busyTime += worker.busyTime;
+                    result.idleTime += worker.idleTime;
+                    result.queueWaitTime += worker.queueWaitTime;
+                    result.runTime += worker.runTime;
+                }
+                return result;
+            }
+
+            /** \brief Returns the fraction of time the workers were executing jobs, between 0 and 1. */
+            double utilization() const
+            {
+                const WorkerMetrics all = combined();
+                const auto time = all.busyTime + all.idleTime;
+                return time.count() == 0 ? 0.0 : static_cast<double>(all.busyTime.count()) / time.count();
+            }
+        };
+    }
+}
+
+#endif // CCOL_THREAD_THREADPOOLMETRICS_HXX
@@ -0,0 +1,304 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_THREADPOOLOPTIONS_HXX
+#define CCOL_THREAD_THREADPOOLOPTIONS_HXX
+
+#include <ccol/thread/job.hxx>
+#include <ccol/thread/threadoptions.hxx>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace ccol
+{
+    namespace thread
+    {
+        /** \brief The scheduling strategies a ThreadPool can use to distribute jobs over its threads. */
+        enum class Scheduling
+        {
+            /** \brief All threads pull jobs from one shared queue.
+             *
+             *  Jobs are executed in FIFO order within their priority class and tenant.
+             */
+            SharedQueue,
+
+            /** \brief Every thread owns a deque and idle threads steal jobs from the others.
+             *
+             *  Jobs enqueued from a thread of the pool are placed on the deque of that thread,
+             *  which executes them in LIFO order. Jobs enqueued from other threads are spread
+             *  over the deques round-robin. Idle threads steal the oldest job of another thread.
+             *
+             *  This removes the shared lock from the hot path when many small jobs are processed,
+             *  at the cost of a global FIFO order.
+             */
+            WorkStealing,
+
+            /** \brief Every NUMA node has its own queue and its own workers.
+             *
+             *  The topology is read from /sys/devices/system/node. Workers are distributed over the
+             *  nodes that have CPUs round-robin, and are pinned to the CPUs of their node that the
+             *  creating thread may run on. Jobs are
+             *  queued on the node of the enqueuing thread, unless a node is provided with
+             *  ThreadPool::enqueueOnNode(). Workers only take jobs of other nodes when the queue of
+             *  their own node is empty.
+             *
+             *  On systems without NUMA information, or with a single node, this behaves as
+             *  SharedQueue and workers are not pinned.
+             */
+            Numa,
+
+            /** \brief All threads pull jobs from one bounded lock-free ring.
+             *
+             *  The ring holds at most ThreadPoolOptions::queueCapacity jobs, which bounds the memory
+             *  and the queueing delay of an overloaded pool. What happens to jobs that do not fit
+             *  is decided by ThreadPoolOptions::overflow, or the caller uses
+             *  ThreadPool::tryEnqueue() or ThreadPool::tryEnqueueFor(). Jobs are executed in FIFO
+             *  order, priorities and tenants are ignored.
+             */
+            Bounded,
+
+            /** \brief All threads pull jobs from one shared queue, earliest deadline first.
+             *
+             *  Jobs enqueued with ThreadPool::enqueue(const std::chrono::steady_clock::time_point&, Job&&)
+             *  are executed in the order of their deadlines, jobs with the same deadline in FIFO
+             *  order. Jobs without deadline are executed after all jobs with a deadline, so they
+             *  wait as long as jobs with a deadline keep coming. Priorities and tenants are ignored.
+             *
+             *  Every scheduling strategy skips jobs whose deadline passed before they started, this
+             *  one also orders them.
+             */
+            Deadline
+        };
+
+        /** \brief What a worker of a ThreadPool does when it finds no job. */
+        enum class IdleStrategy
+        {
+            /** \brief Sleep on a condition variable until jobs are added. */
+            Park,
+
+            /** \brief Poll the queue for a while before sleeping.
+             *
+             *  The worker polls at most ThreadPoolOptions::spinCount times. The limit adapts per
+             *  worker: it grows when polling found a job and shrinks when the worker had to sleep
+             *  anyway. This saves the cost of sleeping and waking for bursts of short jobs.
+             */
+            SpinThenPark,
+
+            /** \brief Poll the queue without ever sleeping.
+             *
+             *  Gives the lowest latency at the cost of one fully used core per worker, intended for
+             *  workers on dedicated cores. Threads of an elastic pool do not stop when they busy-spin.
+             */
+            BusySpin
+        };
+
+        /** \brief What enqueue does with a job when the queue of a Scheduling::Bounded pool is full. */
+        enum class Overflow
+        {
+            /** \brief Wait until a worker makes space.
+             *
+             *  A worker of the pool itself runs the job inline instead, it could otherwise wait for
+             *  itself.
+             */
+            Block,
+
+            /** \brief Execute the job inline on the calling thread.
+             *
+             *  The job is treated as if a worker dequeued it: it is skipped when its token is
+             *  cancelled and handed to ThreadPoolOptions::deadlineMissedCallback when its
+             *  deadline passed.
+             */
+            CallerRuns
+        };
+
+        /** \brief The priority class of a job.
+         *
+         *  Jobs of a higher priority class are executed before jobs of a lower priority class.
+         *  Waiting jobs age: every ThreadPoolOptions::agingInterval a job waits, it competes as if
+         *  it were one priority class higher, so low priority jobs do not starve.
+         *
+         *  Priorities are honoured by Scheduling::SharedQueue.
+         */
+        enum class Priority : unsigned char
+        {
+            /** \brief Latency critical jobs. */
+            High = 0,
+
+            /** \brief The priority of jobs enqueued without priority. */
+            Normal = 1,
+
+            /** \brief Background jobs. */
+            Low = 2
+        };
+
+        /** \brief Identifies a tenant for weighted fair sharing of a ThreadPool.
+         *
+         *  Within a priority class, jobs of different tenants are dispatched in proportion to the
+         *  weights of the tenants, see ThreadPool::setTenantWeight(). Jobs enqueued without tenant
+         *  belong to tenant 0.
+         */
+        typedef std::uint32_t TenantId;
+
+        /** \brief The key of a job that is routed to a preferred worker.
+         *
+         *  Jobs with the same key, for example the id of a session or a shard, run on the same
+         *  worker and in the order they were enqueued, see ThreadPool::enqueue(const AffinityKey&, Job&&).
+         */
+        struct AffinityKey
+        {
+            std::uint64_t value;
+        };
+
+        /** \brief Options used to construct a ThreadPool.
+         *
+         *  Set the fields of a default constructed ThreadPoolOptions, every field has a default:
+         *
+         *      ccol::thread::ThreadPoolOptions options;
+         *      options.threads = 4;
+         *      options.scheduling = ccol::thread::Scheduling::WorkStealing;
+         *      ccol::thread::ThreadPool threadpool(options);
+         *
+         *  An elastic pool is created by setting maxThreads:
+         *
+         *      ccol::thread::ThreadPoolOptions options;
+         *      options.minThreads = 1;
+         *      options.maxThreads = 8;
+         *      options.idleTimeout = std::chrono::seconds(30);
+         */
+        struct ThreadPoolOptions
+        {
+            /** \brief The amount of threads, 0 creates the optimal amount of threads.
+             *
+             *  Ignored when maxThreads is not 0.
+             */
+            unsigned int threads = 0;
+
+            /** \brief The scheduling strategy of the pool. */
+            Scheduling scheduling = Scheduling::SharedQueue;
+
+            /** \brief Callback that allow you to perform operations on the std::thread when they are created.
+             *
+             *  It is called for every thread that is started, also for the threads an elastic pool
+             *  starts on demand and for the timer thread of ThreadPool::enqueueAfter(). It must not
+             *  use the ThreadPool.
+             */
+            std::function<void(std::thread&)> threadCreateCallback = nullptr;
+
+            /** \brief The CPU sets, scheduling policy, stack size and name of the threads.
+             *
+             *  Every worker applies them before it runs its first job, numbered by its worker index.
+             *  The timer thread of ThreadPool::enqueueAfter() is numbered as the worker after the
+             *  last one.
+             */
+            ThreadOptions threadOptions;
+
+            /** \brief The time after which a waiting job competes as if it had the next higher priority. */
+            std::chrono::nanoseconds agingInterval = std::chrono::milliseconds(100);
+
+            /** \brief The amount of threads an elastic pool keeps alive, these are started by the constructor. */
+            unsigned int minThreads = 0;
+
+            /** \brief The maximum amount of threads, a value other than 0 makes the pool elastic.
+             *
+             *  An elastic pool starts a thread when a job is enqueued while no idle thread is
+             *  available to pick it up, up to maxThreads. Threads above minThreads stop when they
+             *  have been idle for idleTimeout.
+             */
+            unsigned int maxThreads = 0;
+
+            /** \brief The time a thread of an elastic pool waits for a job before it stops. */
+            std::chrono::nanoseconds idleTimeout = std::chrono::seconds(10);
+
+            /** \brief The maximum amount of queued jobs of Scheduling::Bounded, rounded up to a power of two. */
+            size_t queueCapacity = 1024;
+
+            /** \brief What enqueue does when the queue of Scheduling::Bounded is full. */
+            Overflow overflow = Overflow::Block;
+
+            /** \brief What a worker does when it finds no job. */
+            IdleStrategy idleStrategy = IdleStrategy::Park;
+
+            /** \brief The maximum amount of times a worker polls the queue with IdleStrategy::SpinThenPark. */
+            unsigned int spinCount = 4096;
+
+            /** \brief Collect per worker counters and histograms, see ThreadPool::metrics().
+             *
+             *  Costs two clock reads for every executed job and one for every enqueue.
+             */
+            bool metrics = false;
+
+            /** \brief How many more jobs the preferred worker of a key may have queued than the least busy worker.
+             *
+             *  A key without pending jobs moves to the least busy worker when the backlog of its
+             *  preferred worker exceeds the backlog of that worker by more than affinitySkew.
+             */
+            size_t affinitySkew = 8;
+
+            /** \brief Threads that wait for the pool execute queued jobs instead of blocking.
+             *
+             *  Applies to ThreadPool::wait(), ThreadPool::wait_for() and TaskGroup. A job that waits
+             *  does not wait for itself, so jobs can fork work and join it without adding threads.
+             */
+            bool helpWhileWaiting = false;
+
+            /** \brief Creates the user defined object of a worker, see WorkerContext::get().
+             *
+             *  Called by every worker before it runs its first job, with the index of the worker,
+             *  so the object is allocated on the NUMA node of the worker. Called with
+             *  WorkerContext::externalWorker for contexts borrowed by threads outside the pool.
+             */
+            std::function<std::shared_ptr<void>(unsigned int)> workerContextFactory = nullptr;
+
+            /** \brief The chunk size of the arena of every worker, see WorkerContext::arena(). */
+            size_t workerArenaSize = 64 * 1024;
+
+            /** \brief Receives the jobs whose deadline passed before a worker could start them.
+             *
+             *  Called on the worker that dequeued the job, or on the producer when a full Bounded
+             *  pool runs the job inline. The callback may run the job, for example to answer the
+             *  client that it timed out, hand it elsewhere or destroy it. Without callback the
+             *  job is destroyed without running. Either way the miss is counted in
+             *  ThreadPoolMetrics::deadlineMisses.
+             */
+            std::function<void(Job&&)> deadlineMissedCallback = nullptr;
+        };
+    }
+}
+
+#endif // CCOL_THREAD_THREADPOOLOPTIONS_HXX
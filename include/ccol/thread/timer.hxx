@@ -42,6 +42,7 @@ If you have found any errors or improvements you'd like to share, please contact
 #include <functional>
 #include <chrono>
 #include <thread>
+#include <ccol/thread/threadoptions.hxx>
 
 namespace ccol
 {
@@ -87,6 +88,14 @@ namespace ccol
              */
             Timer(const std::function<void(std::thread&)> &&threadCreateCallback);
 
+            /** \brief Constructor that sets up the thread of the timer with threadOptions.
+             *
+             * The options are applied before the thread calls the callback for the first time.
+             *
+             * \param threadOptions The CPU set, scheduling policy, stack size and name of the thread.
+             */
+            explicit Timer(const ThreadOptions &threadOptions);
+
             /** \brief Constructor that accepts a callback by const reference.
              *
              * \param callback The const reference of the callback.
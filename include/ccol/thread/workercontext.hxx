@@ -0,0 +1,103 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_WORKERCONTEXT_HXX
+#define CCOL_THREAD_WORKERCONTEXT_HXX
+
+#include <ccol/util/bumparena.hxx>
+#include <cstddef>
+#include <limits>
+#include <memory>
+
+namespace ccol
+{
+    namespace thread
+    {
+        /** \brief The state a ThreadPool keeps for every worker, passed to jobs enqueued with ThreadPool::enqueueWithContext().
+         *
+         *  Every worker owns one WorkerContext for its lifetime: the index of the worker, a
+         *  BumpArena for temporary allocations and, when ThreadPoolOptions::workerContextFactory is
+         *  set, a user defined object such as a buffer, a parser or a random number generator.
+         *  Jobs get the context as an argument, so they need no thread_local lookup nor lazy
+         *  initialization.
+         *
+         *  Memory allocated from the arena by a job is released when the job returns.
+         *
+         *  A thread outside the pool that executes a job, for example while helping or with
+         *  Overflow::CallerRuns, borrows a context with index externalWorker.
+         */
+        class WorkerContext
+        {
+        private:
+            unsigned int _workerIndex;
+            util::BumpArena _arena;
+            std::shared_ptr<void> _context;
+        public:
+            /** \brief The index of contexts that are used by threads outside the pool. */
+            static constexpr unsigned int externalWorker = std::numeric_limits<unsigned int>::max();
+
+            /** \brief Creates a context.
+             *
+             *  \param workerIndex The index of the worker.
+             *  \param arenaSize The chunk size of the arena.
+             *  \param context The user defined object, may be nullptr.
+             */
+            WorkerContext(const unsigned int &workerIndex, const std::size_t &arenaSize, std::shared_ptr<void> context)
+                : _workerIndex(workerIndex), _arena(arenaSize), _context(std::move(context)) {}
+
+            WorkerContext(const WorkerContext &) = delete;
+            WorkerContext &operator=(const WorkerContext &) = delete;
+
+            /** \brief Returns the index of the worker, between 0 and ThreadPool::maxThreadCount(), or externalWorker. */
+            unsigned int workerIndex() const { return _workerIndex; }
+
+            /** \brief Returns the arena of the worker, it is rewound when the job returns. */
+            util::BumpArena &arena() { return _arena; }
+
+            /** \brief Returns the object created by ThreadPoolOptions::workerContextFactory.
+             *
+             *  T must be the type of the object the factory created, the context must not be
+             *  requested when no factory is set.
+             */
+            template<class T>
+            T &get() const { return *static_cast<T*>(_context.get()); }
+
+            /** \brief Returns true when the worker has a user defined object. */
+            bool hasContext() const { return _context != nullptr; }
+        };
+    }
+}
+
+#endif // CCOL_THREAD_WORKERCONTEXT_HXX
@@ -0,0 +1,107 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef COLL_UTIL_BLOCKPOOL_HXX
+#define COLL_UTIL_BLOCKPOOL_HXX
+#include <cstddef>
+#include <memory>
+
+namespace ccol
+{
+    namespace util
+    {
+        /**
+         * \brief A BlockPool is a thread safe allocator that recycles memory blocks.
+         *
+         * Requested sizes are rounded up to a power of two between minBlockSize and maxBlockSize.
+         * Released blocks are kept in a free list per size so the next allocation of that size
+         * does not have to go through the global heap. Larger requests are forwarded to the
+         * global operator new.
+         *
+         * All blocks are aligned to std::max_align_t.
+         */
+        class BlockPool
+        {
+        private:
+            class Impl;
+            std::unique_ptr<Impl> _impl;
+        public:
+            /**
+             * \brief The smallest block size handed out by the pool.
+             */
+            static constexpr std::size_t minBlockSize = 32;
+
+            /**
+             * \brief The largest block size that is recycled by the pool.
+             */
+            static constexpr std::size_t maxBlockSize = 2048;
+
+            /**
+             * \brief BlockPool constructor that caches at most 1024 free blocks per size.
+             */
+            BlockPool();
+
+            /**
+             * \brief BlockPool constructor.
+             * \param maxCachedBlocks The maximum amount of free blocks kept per size.
+             */
+            BlockPool(const std::size_t &maxCachedBlocks);
+
+            /**
+             * \brief Allocates a block of at least size bytes.
+             * \param size The size of the block in bytes.
+             * \return Pointer to the block.
+             */
+            void *allocate(const std::size_t &size);
+
+            /**
+             * \brief Returns a block to the pool.
+             * \param block Pointer returned by allocate.
+             * \param size The size that was passed to allocate.
+             */
+            void deallocate(void *block, const std::size_t &size);
+
+            /**
+             * \brief BlockPool destructor.
+             *
+             * Frees all cached blocks. Blocks that are still in use must be deallocated with
+             * the global operator delete or, preferably, not outlive the pool.
+             */
+            virtual ~BlockPool();
+        };
+    }
+}
+
+#endif // COLL_UTIL_BLOCKPOOL_HXX
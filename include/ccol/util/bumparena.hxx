@@ -0,0 +1,156 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef COLL_UTIL_BUMPARENA_HXX
+#define COLL_UTIL_BUMPARENA_HXX
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace ccol
+{
+    namespace util
+    {
+        /**
+         * \brief A BumpArena hands out memory by advancing a pointer through large chunks.
+         *
+         * Allocating costs a few instructions and nothing is freed individually: all memory
+         * allocated after a Marker is released at once with rewind(), or everything with reset().
+         * Chunks are kept when the arena is rewound, so an arena that is reused for similar work
+         * stops allocating from the heap after the first round.
+         *
+         * Destructors of objects placed in the arena are not called. A BumpArena is not thread
+         * safe, it is meant to be owned by a single thread.
+         */
+        class BumpArena
+        {
+        private:
+            struct Chunk
+            {
+                std::unique_ptr<unsigned char[]> memory;
+                std::size_t size;
+            };
+            std::vector<Chunk> _chunks;
+            std::size_t _chunkSize;
+            std::size_t _chunk = 0;
+            std::size_t _offset = 0;
+        public:
+            /**
+             * \brief A position in the arena, see mark() and rewind().
+             */
+            struct Marker
+            {
+                std::size_t chunk;
+                std::size_t offset;
+            };
+
+            /**
+             * \brief BumpArena constructor, no memory is reserved until the first allocation.
+             * \param chunkSize The size of the chunks requested from the heap, larger allocations get a chunk of their own.
+             */
+            explicit BumpArena(const std::size_t &chunkSize = 64 * 1024);
+
+            BumpArena(const BumpArena &) = delete;
+            BumpArena &operator=(const BumpArena &) = delete;
+
+            /**
+             * \brief Allocates size bytes.
+             * \param size The size of the memory in bytes.
+             * \param alignment The alignment of the memory, a power of two.
+             * \return Pointer to the memory, valid until the arena is rewound past it.
+             */
+            void *allocate(const std::size_t &size, const std::size_t &alignment = alignof(std::max_align_t));
+
+            /**
+             * \brief Returns the current position of the arena.
+             */
+            Marker mark() const;
+
+            /**
+             * \brief Releases all memory that was allocated after marker was taken.
+             * \param marker A position returned by mark().
+             */
+            void rewind(const Marker &marker);
+
+            /**
+             * \brief Releases all memory allocated from the arena and keeps the chunks for reuse.
+             */
+            void reset();
+
+            /**
+             * \brief Returns the amount of bytes reserved from the heap.
+             */
+            std::size_t capacity() const;
+        };
+
+        /**
+         * \brief A standard allocator that allocates from a BumpArena.
+         *
+         * Deallocation does nothing, the memory is released when the arena is rewound, so
+         * containers using it must not outlive that.
+         *
+         *     std::vector<int, ccol::util::ArenaAllocator<int>> values{ccol::util::ArenaAllocator<int>(arena)};
+         */
+        template<class T>
+        class ArenaAllocator
+        {
+        private:
+            template<class U> friend class ArenaAllocator;
+            BumpArena *_arena;
+        public:
+            typedef T value_type;
+
+            explicit ArenaAllocator(BumpArena &arena) noexcept : _arena(&arena) {}
+
+            template<class U>
+            ArenaAllocator(const ArenaAllocator<U> &other) noexcept : _arena(other._arena) {}
+
+            T *allocate(std::size_t count)
+            {
+                return static_cast<T*>(_arena->allocate(count * sizeof(T), alignof(T)));
+            }
+
+            void deallocate(T *, std::size_t) noexcept {}
+
+            template<class U>
+            bool operator==(const ArenaAllocator<U> &other) const noexcept { return _arena == other._arena; }
+
+            template<class U>
+            bool operator!=(const ArenaAllocator<U> &other) const noexcept { return _arena != other._arena; }
+        };
+    }
+}
+
+#endif // COLL_UTIL_BUMPARENA_HXX
@@ -38,6 +38,8 @@ If you have found any errors or improvements you'd like to share, please contact
 #include <condition_variable>
 #include <unordered_map>
 #include <queue>
+#include <deque>
+#include <utility>
 #include <typeindex>
 
 namespace ccol {
@@ -52,11 +54,15 @@ namespace ccol {
             std::size_t _maxQueueSize;
             std::unordered_map<std::type_index,callback_type> _callbacks;
             std::queue<event_type> _events;
+            std::deque<std::pair<std::size_t,std::pair<void(*)(void*),void*>>> _posts;
+            std::size_t _eventsPushed = 0;
+            std::size_t _eventsPopped = 0;
             bool _running = false;
             public:
             Impl(const std::size_t &maxQueueSize);
             bool enqueue(const event_type &event);
             bool enqueue(event_type &&event);
+            bool post(void (*callback)(void*), void *context);
             void setCallbackForType(const std::type_index &type, const callback_type &callback);
             void setCallbackForType(const std::type_index &type, callback_type &&callback);
             void setCallbacks(const callback_vector_type &callbacks);
@@ -78,6 +84,7 @@ namespace ccol {
                 std::unique_lock<std::mutex> lock(_stateMutex);
                 if (_maxQueueSize>0 && _events.size()>=_maxQueueSize) return false;
                 _events.push(event);
+                ++_eventsPushed;
             }
             _stateCv.notify_all();
             return true;
@@ -89,6 +96,19 @@ namespace ccol {
                 std::unique_lock<std::mutex> lock(_stateMutex);
                 if (_maxQueueSize>0 && _events.size()>=_maxQueueSize) return false;
                 _events.push(std::move(event));
+                ++_eventsPushed;
+            }
+            _stateCv.notify_all();
+            return true;
+        }
+
+        bool EventQueue::Impl::post(void (*callback)(void*), void *context)
+        {
+            if (callback==nullptr) return false;
+            {
+                std::unique_lock<std::mutex> lock(_stateMutex);
+                // Remember how many events precede this post, so run() keeps the order.
+                _posts.emplace_back(_eventsPushed,std::make_pair(callback,context));
             }
             _stateCv.notify_all();
             return true;
@@ -129,13 +149,18 @@ namespace ccol {
              while (_running) {
                  callback_type callback = nullptr;
                  event_type event;
+                 std::pair<void(*)(void*),void*> posted(nullptr,nullptr);
                  {
                      std::unique_lock<std::mutex> lock(_stateMutex);
                      _stateCv.wait(lock,[this]{
-                        return _events.size()>0 || !_running;
+                        return _events.size()>0 || _posts.size()>0 || !_running;
                      });
                      if (!_running) break;
-                     if (_events.size()>0) {
+                     if (_posts.size()>0 && _posts.front().first<=_eventsPopped) {
+                        posted = _posts.front().second;
+                        _posts.pop_front();
+                     } else if (_events.size()>0) {
+                        ++_eventsPopped;
                         event = _events.front();
                         _events.pop();
                         auto callbackIterator = _callbacks.find(typeid(*event));
@@ -144,7 +169,9 @@ namespace ccol {
                         }
                      }
                  }
-                 if (callback!=nullptr) {
+                 if (posted.first!=nullptr) {
+                     posted.first(posted.second);
+                 } else if (callback!=nullptr) {
                      callback(std::move(event));
                  }
              }
@@ -185,6 +212,11 @@ namespace ccol {
             return _impl->enqueue(std::move(event));
         }
 
+        bool EventQueue::post(void (*callback)(void*), void *context)
+        {
+            return _impl->post(callback,context);
+        }
+
         void EventQueue::setCallbackForType(const std::type_index &type, const callback_type &callback)
         {
             _impl->setCallbackForType(type,callback);
@@ -215,6 +247,12 @@ namespace ccol {
             _impl->run();
         }
 
+        void EventQueue::run(const thread::ThreadOptions &threadOptions)
+        {
+            thread::applyThreadOptions(threadOptions);
+            _impl->run();
+        }
+
         void EventQueue::stop()
         {
             _impl->stop();
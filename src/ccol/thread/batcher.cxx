@@ -0,0 +1,258 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+
+#include <ccol/thread/batcher.hxx>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            namespace {
+                // The state of a Batcher is the number of the open batch in the high half and the amount of claimed places in the low half.
+                inline std::uint32_t batchOf(const std::uint64_t &state) { return static_cast<std::uint32_t>(state >> 32); }
+                inline std::uint32_t claimedOf(const std::uint64_t &state) { return static_cast<std::uint32_t>(state); }
+                inline std::uint64_t stateOf(const std::uint32_t &batch, const std::uint32_t &claimed) { return (static_cast<std::uint64_t>(batch) << 32) | claimed; }
+            }
+
+            class BatcherCore::Impl : public std::enable_shared_from_this<BatcherCore::Impl>
+            {
+            private:
+                struct Buffer
+                {
+                    // the size of the sealed batch minus the items stored so far, the batch is complete at 0.
+                    std::atomic<std::int64_t> pending{0};
+                    // the batch can be opened once the batch before it is sealed and the buffer is handled, see handOff().
+                    std::atomic<unsigned int> handOffs{0};
+                    std::size_t size = 0;
+                };
+                ThreadPool &_pool;
+                std::uint32_t _maxItems;
+                std::chrono::nanoseconds _maxDelay;
+                std::function<void(std::size_t, std::size_t)> _flush;
+                std::size_t _bufferCount;
+                std::unique_ptr<Buffer[]> _buffers;
+                std::atomic<std::uint64_t> _state{0};
+                std::atomic<std::size_t> _inFlight{0}; // sealed batches the handler did not return from yet.
+                std::atomic<std::size_t> _waiters{0};
+                std::mutex _mutex;
+                std::condition_variable _cv;
+                Buffer &buffer(const std::uint32_t &batch) { return _buffers[batch & (_bufferCount - 1)]; }
+                void seal(const std::uint32_t &batch, const std::uint32_t &size);
+                void sealEarly(const std::uint32_t &batch);
+                void handOff(const std::uint32_t &batch);
+                void handle(const std::uint32_t &batch);
+                void notify();
+                void waitUntil(const std::function<bool()> &done);
+            public:
+                Impl(ThreadPool &pool, const std::size_t &maxItems, const std::chrono::nanoseconds &maxDelay,
+                     const std::size_t &buffers, std::function<void(std::size_t, std::size_t)> &&flush);
+                std::size_t maxItems() const { return _maxItems; }
+                std::size_t bufferCount() const { return _bufferCount; }
+                Slot claim();
+                void commit(const Slot &slot);
+                void flush();
+                void wait();
+            };
+
+            BatcherCore::Impl::Impl(ThreadPool &pool, const std::size_t &maxItems, const std::chrono::nanoseconds &maxDelay,
+                                    const std::size_t &buffers, std::function<void(std::size_t, std::size_t)> &&flush)
+                : _pool(pool),
+                  // the claimed places of a full batch keep counting while the next batch is not open, so leave room above maxItems.
+                  _maxItems(static_cast<std::uint32_t>(std::min<std::size_t>(std::max<std::size_t>(maxItems, 1), std::numeric_limits<std::int32_t>::max()))),
+                  _maxDelay(maxDelay), _flush(std::move(flush)), _bufferCount(1)
+            {
+                while (_bufferCount < buffers) {
+                    _bufferCount *= 2; // a power of two, so the buffer of a batch stays the same when the batch number wraps.
+                }
+                _buffers.reset(new Buffer[_bufferCount]);
+                // batch 0 is open, the other buffers are not used yet so their first batch only waits for the seal before it.
+                for (std::size_t index = 1; index < _bufferCount; index++) {
+                    _buffers[index].handOffs = 1;
+                }
+            }
+
+            BatcherCore::Slot BatcherCore::Impl::claim()
+            {
+                for (;;) {
+                    std::uint64_t state = _state.load(std::memory_order_acquire);
+                    if (claimedOf(state) < _maxItems) {
+                        state = _state.fetch_add(1, std::memory_order_acq_rel);
+                        const std::uint32_t batch = batchOf(state);
+                        const std::uint32_t index = claimedOf(state);
+                        if (index < _maxItems) {
+                            if (index == 0 && _maxDelay.count() > 0) {
+                                _pool.enqueueAfter(_maxDelay, Job([self = shared_from_this(), batch] { self->sealEarly(batch); }));
+                            }
+                            if (index + 1 == _maxItems) {
+                                seal(batch, _maxItems);
+                            }
+                            return Slot{batch, batch & (_bufferCount - 1), index};
+                        }
+                    }
+                    // the batch is full, wait until the next one is opened.
+                    const std::uint32_t full = batchOf(state);
+                    waitUntil([this, full] { return batchOf(_state.load()) != full; });
+                }
+            }
+
+            void BatcherCore::Impl::commit(const Slot &slot)
+            {
+                if (buffer(slot.batch).pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                    _pool.enqueue(Job([self = shared_from_this(), batch = slot.batch] { self->handle(batch); }));
+                }
+            }
+
+            void BatcherCore::Impl::seal(const std::uint32_t &batch, const std::uint32_t &size)
+            {
+                Buffer &sealed = buffer(batch);
+                sealed.size = size;
+                _inFlight.fetch_add(1);
+                // the stores that were committed before made pending negative, the last one to reach 0 flushes.
+                if (sealed.pending.fetch_add(size, std::memory_order_acq_rel) + size == 0) {
+                    _pool.enqueue(Job([self = shared_from_this(), batch] { self->handle(batch); }));
+                }
+                handOff(batch + 1);
+            }
+
+            void BatcherCore::Impl::sealEarly(const std::uint32_t &batch)
+            {
+                std::uint64_t state = _state.load(std::memory_order_acquire);
+                while (batchOf(state) == batch && claimedOf(state) > 0 && claimedOf(state) < _maxItems) {
+                    if (_state.compare_exchange_weak(state, stateOf(batch, _maxItems), std::memory_order_acq_rel)) {
+                        seal(batch, claimedOf(state));
+                        return;
+                    }
+                }
+            }
+
+            void BatcherCore::Impl::handOff(const std::uint32_t &batch)
+            {
+                Buffer &next = buffer(batch);
+                if (next.handOffs.fetch_add(1, std::memory_order_acq_rel) != 1) return;
+                next.handOffs.store(0, std::memory_order_relaxed);
+                _state.store(stateOf(batch, 0));
+                notify();
+            }
+
+            void BatcherCore::Impl::handle(const std::uint32_t &batch)
+            {
+                _flush(batch & (_bufferCount - 1), buffer(batch).size);
+                handOff(batch + static_cast<std::uint32_t>(_bufferCount));
+                _inFlight.fetch_sub(1);
+                notify();
+            }
+
+            void BatcherCore::Impl::notify()
+            {
+                // the waiter registers before it checks its condition, so either it sees the change or it is notified.
+                if (_waiters.load() == 0) return;
+                std::lock_guard<std::mutex> lock(_mutex);
+                _cv.notify_all();
+            }
+
+            void BatcherCore::Impl::waitUntil(const std::function<bool()> &done)
+            {
+                if (_pool.helpsWhileWaiting()) {
+                    _pool.helpUntil(done);
+                    return;
+                }
+                std::unique_lock<std::mutex> lock(_mutex);
+                _waiters++;
+                _cv.wait(lock, done);
+                _waiters--;
+            }
+
+            void BatcherCore::Impl::flush()
+            {
+                sealEarly(batchOf(_state.load(std::memory_order_acquire)));
+            }
+
+            void BatcherCore::Impl::wait()
+            {
+                flush();
+                waitUntil([this] { return _inFlight.load() == 0; });
+            }
+
+            BatcherCore::BatcherCore(ThreadPool &pool, const std::size_t &maxItems, const std::chrono::nanoseconds &maxDelay,
+                                     const std::size_t &buffers, std::function<void(std::size_t, std::size_t)> &&flush)
+                : _impl(std::make_shared<Impl>(pool, maxItems, maxDelay, buffers, std::move(flush)))
+            {
+            }
+
+            std::size_t BatcherCore::maxItems() const
+            {
+                return _impl->maxItems();
+            }
+
+            std::size_t BatcherCore::bufferCount() const
+            {
+                return _impl->bufferCount();
+            }
+
+            BatcherCore::Slot BatcherCore::claim()
+            {
+                return _impl->claim();
+            }
+
+            void BatcherCore::commit(const Slot &slot)
+            {
+                _impl->commit(slot);
+            }
+
+            void BatcherCore::flush()
+            {
+                _impl->flush();
+            }
+
+            void BatcherCore::wait()
+            {
+                _impl->wait();
+            }
+
+            BatcherCore::~BatcherCore()
+            {
+                _impl->wait();
+            }
+        }
+    }
+}
@@ -0,0 +1,136 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include "deadlinejobqueue.hxx"
+#include <algorithm>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            namespace {
+                // Orders the heap so its front is the earliest deadline, and the oldest job among equal deadlines.
+                struct Later
+                {
+                    template<class Item>
+                    bool operator()(const Item &left, const Item &right) const
+                    {
+                        return left.deadline != right.deadline ? left.deadline > right.deadline : left.sequence > right.sequence;
+                    }
+                };
+            }
+
+            void DeadlineJobQueue::lockedPush(JobEntry &&entry)
+            {
+                size_t slot;
+                if (_freeSlots.empty()) {
+                    slot = _slots.size();
+                    _slots.push_back(std::move(entry));
+                }
+                else {
+                    slot = _freeSlots.back();
+                    _freeSlots.pop_back();
+                    _slots[slot] = std::move(entry);
+                }
+                _heap.push_back(HeapItem{_slots[slot].deadline, _sequence++, slot});
+                std::push_heap(_heap.begin(), _heap.end(), Later());
+            }
+
+            JobEntry DeadlineJobQueue::lockedPop()
+            {
+                std::pop_heap(_heap.begin(), _heap.end(), Later());
+                const size_t slot = _heap.back().slot;
+                _heap.pop_back();
+                JobEntry entry = std::move(_slots[slot]);
+                _slots[slot] = JobEntry(); // releases the captures of the moved-from job.
+                _freeSlots.push_back(slot);
+                return entry;
+            }
+
+            void DeadlineJobQueue::push(JobEntry &&entry, const unsigned int &)
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                lockedPush(std::move(entry));
+            }
+
+            void DeadlineJobQueue::push(std::vector<JobEntry> &&entries, const unsigned int &)
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                for (auto &entry : entries) {
+                    lockedPush(std::move(entry));
+                }
+            }
+
+            bool DeadlineJobQueue::tryPop(JobEntry &entry, const unsigned int &)
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (_heap.empty()) return false;
+                entry = lockedPop();
+                return true;
+            }
+
+            std::vector<JobEntry> DeadlineJobQueue::popAll()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                std::sort(_heap.begin(), _heap.end(), [](const HeapItem &left, const HeapItem &right) { return Later()(right, left); });
+                std::vector<JobEntry> result;
+                result.reserve(_heap.size());
+                for (const auto &item : _heap) {
+                    result.push_back(std::move(_slots[item.slot]));
+                }
+                _heap.clear();
+                _slots.clear();
+                _freeSlots.clear();
+                return result;
+            }
+
+            size_t DeadlineJobQueue::removeCancelled()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                const size_t before = _heap.size();
+                _heap.erase(std::remove_if(_heap.begin(), _heap.end(), [this](const HeapItem &item) {
+                    if (!_slots[item.slot].isCancelled()) return false;
+                    _slots[item.slot] = JobEntry();
+                    _freeSlots.push_back(item.slot);
+                    return true;
+                }), _heap.end());
+                std::make_heap(_heap.begin(), _heap.end(), Later());
+                return before - _heap.size();
+            }
+        }
+    }
+}
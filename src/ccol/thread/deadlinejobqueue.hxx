@@ -0,0 +1,83 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_DEADLINEJOBQUEUE_HXX
+#define CCOL_THREAD_DEADLINEJOBQUEUE_HXX
+
+#include "jobqueue.hxx"
+#include <cstdint>
+#include <mutex>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            /** \brief A queue shared by all workers that serves the job with the earliest deadline first.
+             *
+             *  The heap only holds the deadline, the order of arrival and the slot of every job, the
+             *  entries themselves stay in their slot until they are popped, so reordering the heap
+             *  does not move jobs. Jobs with the same deadline, and jobs without deadline, are served
+             *  in the order they were pushed.
+             */
+            class DeadlineJobQueue : public JobQueue
+            {
+            private:
+                struct HeapItem
+                {
+                    std::chrono::steady_clock::time_point deadline;
+                    std::uint64_t sequence;
+                    size_t slot;
+                };
+                std::mutex _mutex;
+                std::vector<HeapItem> _heap;
+                std::vector<JobEntry> _slots;
+                std::vector<size_t> _freeSlots;
+                std::uint64_t _sequence = 0;
+                inline void lockedPush(JobEntry &&entry);
+                inline JobEntry lockedPop();
+            public:
+                void push(JobEntry &&entry, const unsigned int &workerIndex) override;
+                void push(std::vector<JobEntry> &&entries, const unsigned int &workerIndex) override;
+                bool tryPop(JobEntry &entry, const unsigned int &workerIndex) override;
+                std::vector<JobEntry> popAll() override;
+                size_t removeCancelled() override;
+            };
+        }
+    }
+}
+
+#endif // CCOL_THREAD_DEADLINEJOBQUEUE_HXX
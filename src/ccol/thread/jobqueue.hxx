@@ -0,0 +1,142 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_JOBQUEUE_HXX
+#define CCOL_THREAD_JOBQUEUE_HXX
+
+#include <ccol/thread/job.hxx>
+#include <ccol/thread/threadpooloptions.hxx>
+#include <ccol/util/cancellationtoken.hxx>
+#include <chrono>
+#include <limits>
+#include <vector>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            /** \brief Worker index used for jobs pushed or popped by threads outside of the pool. */
+            constexpr unsigned int noWorker = std::numeric_limits<unsigned int>::max();
+
+            /** \brief Node of a JobEntry that may be executed on any node. */
+            constexpr unsigned int anyNode = std::numeric_limits<unsigned int>::max();
+
+            /** \brief Key slot of a JobEntry that was not enqueued with an AffinityKey. */
+            constexpr size_t noKeySlot = std::numeric_limits<size_t>::max();
+
+            /** \brief The amount of priority classes. */
+            constexpr unsigned int priorityCount = 3;
+
+            /** \brief A job with the attributes it was enqueued with. */
+            struct JobEntry
+            {
+                Job job;
+                Priority priority = Priority::Normal;
+                TenantId tenant = 0;
+                unsigned int node = anyNode;
+                bool cancellable = false;
+                util::CancellationToken token; // only used when cancellable is set.
+                std::chrono::steady_clock::time_point enqueued;
+                size_t keySlot = noKeySlot; // the affinity key slot of a keyed job.
+                std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::time_point::max();
+
+                JobEntry() = default;
+                JobEntry(Job &&job, const Priority &priority = Priority::Normal, const TenantId &tenant = 0)
+                    : job(std::move(job)), priority(priority), tenant(tenant) {}
+
+                /** \brief Returns true when the job was enqueued with a token that has been cancelled. */
+                bool isCancelled()
+                {
+                    return cancellable && token.isCancelled(std::memory_order_relaxed);
+                }
+
+                /** \brief Returns true when the job was enqueued with a deadline that has passed. */
+                bool isExpired()
+                {
+                    return deadline != std::chrono::steady_clock::time_point::max() && std::chrono::steady_clock::now() > deadline;
+                }
+            };
+
+            /** \brief Interface of the queues that hold the pending jobs of a ThreadPool.
+             *
+             *  Implementations must be thread safe. The ThreadPool keeps track of the amount of
+             *  jobs and of sleeping threads itself, so a JobQueue only stores jobs.
+             */
+            class JobQueue
+            {
+            public:
+                /** \brief Push a job, workerIndex is the index of the pushing worker or noWorker. */
+                virtual void push(JobEntry &&entry, const unsigned int &workerIndex) = 0;
+
+                /** \brief Push a job unless the queue is full, entry is left untouched when false is returned.
+                 *
+                 *  Unbounded queues always accept the job.
+                 */
+                virtual bool tryPush(JobEntry &entry, const unsigned int &workerIndex)
+                {
+                    push(std::move(entry), workerIndex);
+                    return true;
+                }
+
+                /** \brief Push multiple jobs, workerIndex is the index of the pushing worker or noWorker. */
+                virtual void push(std::vector<JobEntry> &&entries, const unsigned int &workerIndex) = 0;
+
+                /** \brief Try to pop a job for the worker with index workerIndex.
+                 *  \return True when a job has been moved into entry.
+                 */
+                virtual bool tryPop(JobEntry &entry, const unsigned int &workerIndex) = 0;
+
+                /** \brief Remove all jobs and return them in the order they would have been processed. */
+                virtual std::vector<JobEntry> popAll() = 0;
+
+                /** \brief Remove the jobs that have been cancelled and return the amount removed.
+                 *
+                 *  Queues that can not remove jobs from the middle keep them, the pool skips them
+                 *  when they are popped.
+                 */
+                virtual size_t removeCancelled() { return 0; }
+
+                /** \brief Set the weight of a tenant, queues without fair sharing ignore it. */
+                virtual void setTenantWeight(const TenantId &, const unsigned int &) {}
+
+                virtual ~JobQueue() = default;
+            };
+        }
+    }
+}
+
+#endif // CCOL_THREAD_JOBQUEUE_HXX
@@ -0,0 +1,141 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include "mpscjobqueue.hxx"
+#include <new>
+#include <utility>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            namespace {
+                // The most nodes the free list keeps, more are returned to the BlockPool.
+                constexpr std::size_t maxFreeNodes = 256;
+            }
+
+            MpscJobQueue::MpscJobQueue(std::shared_ptr<util::BlockPool> blockPool)
+                : _blockPool(std::move(blockPool)), _head(&_stub), _tail(&_stub)
+            {
+            }
+
+            void MpscJobQueue::link(Node *node)
+            {
+                node->next.store(nullptr, std::memory_order_relaxed);
+                Node *previous = _head.exchange(node, std::memory_order_acq_rel);
+                previous->next.store(node, std::memory_order_release);
+            }
+
+            MpscJobQueue::Node *MpscJobQueue::acquireNode()
+            {
+                if (_free.load(std::memory_order_relaxed) != nullptr && !_freeTaken.exchange(true, std::memory_order_acquire)) {
+                    // the only producer taking from the list, the consumer only pushes, so a node
+                    // cannot be taken and returned between the load and the exchange.
+                    Node *node = _free.load(std::memory_order_acquire);
+                    while (node != nullptr && !_free.compare_exchange_weak(node, node->next.load(std::memory_order_relaxed),
+                                                                           std::memory_order_acquire, std::memory_order_acquire)) {
+                    }
+                    _freeTaken.store(false, std::memory_order_release);
+                    if (node != nullptr) {
+                        _freeCount.fetch_sub(1, std::memory_order_relaxed);
+                        return node;
+                    }
+                }
+                return new (_blockPool->allocate(sizeof(Node))) Node();
+            }
+
+            void MpscJobQueue::recycleNode(Node *node)
+            {
+                if (_freeCount.load(std::memory_order_relaxed) >= maxFreeNodes) {
+                    node->~Node();
+                    _blockPool->deallocate(node, sizeof(Node));
+                    return;
+                }
+                _freeCount.fetch_add(1, std::memory_order_relaxed);
+                Node *head = _free.load(std::memory_order_relaxed);
+                do {
+                    node->next.store(head, std::memory_order_relaxed);
+                } while (!_free.compare_exchange_weak(head, node, std::memory_order_release, std::memory_order_relaxed));
+            }
+
+            void MpscJobQueue::push(Job &&job)
+            {
+                Node *node = acquireNode();
+                node->job = std::move(job);
+                link(node);
+            }
+
+            bool MpscJobQueue::tryPop(Job &job)
+            {
+                Node *tail = _tail;
+                Node *next = tail->next.load(std::memory_order_acquire);
+                if (tail == &_stub) {
+                    if (next == nullptr) return false;
+                    _tail = next;
+                    tail = next;
+                    next = next->next.load(std::memory_order_acquire);
+                }
+                if (next == nullptr) {
+                    if (tail != _head.load(std::memory_order_acquire)) return false; // a producer has not linked its node yet.
+                    // tail is the last node, put the stub behind it so tail can be released.
+                    link(&_stub);
+                    next = tail->next.load(std::memory_order_acquire);
+                    if (next == nullptr) return false;
+                }
+                _tail = next;
+                job = std::move(tail->job);
+                recycleNode(tail);
+                return true;
+            }
+
+            MpscJobQueue::~MpscJobQueue()
+            {
+                Job job;
+                while (tryPop(job)) {
+                    job = nullptr;
+                }
+                Node *node = _free.load(std::memory_order_acquire);
+                while (node != nullptr) {
+                    Node *next = node->next.load(std::memory_order_relaxed);
+                    node->~Node();
+                    _blockPool->deallocate(node, sizeof(Node));
+                    node = next;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,101 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_MPSCJOBQUEUE_HXX
+#define CCOL_THREAD_MPSCJOBQUEUE_HXX
+
+#include <ccol/thread/job.hxx>
+#include <ccol/util/blockpool.hxx>
+#include <atomic>
+#include <cstddef>
+#include <memory>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            /** \brief An unbounded lock-free multi-producer single-consumer queue of jobs.
+             *
+             *  Producers link a node with a single exchange, the consumer follows the next pointers
+             *  without atomic read-modify-write operations.
+             *
+             *  The consumer recycles the nodes of popped jobs on a free list of the queue, and a
+             *  producer takes its node from that list without a lock. Only one producer at a time
+             *  takes from the list, which keeps it free of ABA problems; the others, and every
+             *  producer while the list is empty, allocate a node from the BlockPool instead.
+             *
+             *  tryPop can fail while a producer is between its exchange and linking its node, a
+             *  consumer that knows a job was pushed retries.
+             */
+            class MpscJobQueue
+            {
+            private:
+                struct Node
+                {
+                    std::atomic<Node*> next{nullptr};
+                    Job job;
+                };
+                std::shared_ptr<util::BlockPool> _blockPool;
+                std::atomic<Node*> _free{nullptr};         // recycled nodes, pushed by the consumer.
+                std::atomic<std::size_t> _freeCount{0};    // bounds the memory the free list keeps.
+                std::atomic_bool _freeTaken{false};        // set by the producer that takes a node from the free list.
+                Node _stub;
+                std::atomic<Node*> _head; // the last node, written by producers.
+                char _padding[64];        // keep the producers and the consumer on different cache lines.
+                Node *_tail;              // the first node, only used by the consumer.
+
+                void link(Node *node);
+                Node *acquireNode();
+                void recycleNode(Node *node);
+            public:
+                MpscJobQueue(std::shared_ptr<util::BlockPool> blockPool);
+                MpscJobQueue(const MpscJobQueue &) = delete;
+                MpscJobQueue &operator=(const MpscJobQueue &) = delete;
+
+                /** \brief Adds a job, can be called from any thread. */
+                void push(Job &&job);
+
+                /** \brief Removes the oldest job, must only be called by one thread at a time. */
+                bool tryPop(Job &job);
+
+                ~MpscJobQueue();
+            };
+        }
+    }
+}
+
+#endif // CCOL_THREAD_MPSCJOBQUEUE_HXX
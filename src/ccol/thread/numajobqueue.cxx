@@ -0,0 +1,155 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include "numajobqueue.hxx"
+#include <algorithm>
+#include <iterator>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            NumaJobQueue::NumaJobQueue(NumaTopology topology, const std::chrono::nanoseconds &agingInterval)
+                : _topology(std::move(topology))
+            {
+                for (size_t idx = 0; idx < _topology.nodeCpus.size(); idx++) {
+                    _nodes.push_back(std::make_unique<Node>(agingInterval));
+                }
+                if (_topology.nodeCpus.size() < 2) return; // pinning to the only node would widen an inherited affinity.
+                std::vector<unsigned int> allowed = currentThreadCpus();
+                std::sort(allowed.begin(), allowed.end());
+                for (const auto &nodeCpus : _topology.nodeCpus) {
+                    std::vector<unsigned int> cpus = nodeCpus;
+                    std::sort(cpus.begin(), cpus.end());
+                    if (!allowed.empty()) {
+                        std::vector<unsigned int> usable;
+                        std::set_intersection(cpus.begin(), cpus.end(), allowed.begin(), allowed.end(), std::back_inserter(usable));
+                        cpus = std::move(usable); // empty when the pool may not use the node, its workers stay unpinned.
+                    }
+                    _pinnedCpus.push_back(std::move(cpus));
+                }
+            }
+
+            unsigned int NumaJobQueue::nodeCount() const
+            {
+                return static_cast<unsigned int>(_nodes.size());
+            }
+
+            unsigned int NumaJobQueue::workerNode(const unsigned int &workerIndex) const
+            {
+                return workerIndex % nodeCount();
+            }
+
+            void NumaJobQueue::pinWorker(const unsigned int &workerIndex) const
+            {
+                if (_pinnedCpus.empty()) return;
+                const std::vector<unsigned int> &cpus = _pinnedCpus[workerNode(workerIndex)];
+                if (!cpus.empty()) {
+                    pinCurrentThread(cpus);
+                }
+            }
+
+            unsigned int NumaJobQueue::targetNode(const JobEntry &entry, const unsigned int &workerIndex) const
+            {
+                if (entry.node != anyNode) return entry.node % nodeCount();
+                if (workerIndex != noWorker) return workerNode(workerIndex);
+                return _topology.currentNode();
+            }
+
+            void NumaJobQueue::push(JobEntry &&entry, const unsigned int &workerIndex)
+            {
+                Node &node = *_nodes[targetNode(entry, workerIndex)];
+                node.count++;
+                node.jobs.push(std::move(entry), workerIndex);
+            }
+
+            void NumaJobQueue::push(std::vector<JobEntry> &&entries, const unsigned int &workerIndex)
+            {
+                if (entries.empty()) return;
+                const unsigned int target = targetNode(entries.front(), workerIndex); // entries of one call share their node.
+                Node &node = *_nodes[target];
+                node.count += entries.size();
+                node.jobs.push(std::move(entries), workerIndex);
+            }
+
+            bool NumaJobQueue::tryPop(JobEntry &entry, const unsigned int &workerIndex)
+            {
+                const unsigned int home = workerIndex == noWorker ? 0 : workerNode(workerIndex);
+                for (unsigned int offset = 0; offset < nodeCount(); offset++) { // the own node first, remote nodes only when it is empty.
+                    Node &node = *_nodes[(home + offset) % nodeCount()];
+                    if (node.count == 0) continue;
+                    if (node.jobs.tryPop(entry, workerIndex)) {
+                        node.count--;
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            std::vector<JobEntry> NumaJobQueue::popAll()
+            {
+                std::vector<JobEntry> result;
+                for (auto &node : _nodes) {
+                    std::vector<JobEntry> entries = node->jobs.popAll();
+                    node->count -= entries.size();
+                    for (auto &entry : entries) {
+                        result.push_back(std::move(entry));
+                    }
+                }
+                return result;
+            }
+
+            size_t NumaJobQueue::removeCancelled()
+            {
+                size_t removed = 0;
+                for (auto &node : _nodes) {
+                    const size_t count = node->jobs.removeCancelled();
+                    node->count -= count;
+                    removed += count;
+                }
+                return removed;
+            }
+
+            void NumaJobQueue::setTenantWeight(const TenantId &tenant, const unsigned int &weight)
+            {
+                for (auto &node : _nodes) {
+                    node->jobs.setTenantWeight(tenant, weight);
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,97 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_NUMAJOBQUEUE_HXX
+#define CCOL_THREAD_NUMAJOBQUEUE_HXX
+
+#include "jobqueue.hxx"
+#include "numatopology.hxx"
+#include "sharedjobqueue.hxx"
+#include <atomic>
+#include <memory>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            /** \brief A SharedJobQueue per NUMA node.
+             *
+             *  Workers are assigned to the nodes round-robin and take jobs from their own node.
+             *  Only when the queue of its node is empty a worker takes jobs from the other nodes.
+             *  Jobs are pushed to the node of JobEntry::node, or when that is anyNode, to the node
+             *  of the pushing worker or else to the node of the CPU the pushing thread runs on.
+             */
+            class NumaJobQueue : public JobQueue
+            {
+            private:
+                struct Node
+                {
+                    SharedJobQueue jobs;
+                    std::atomic<size_t> count{0}; // allows workers of other nodes to skip an empty node without locking.
+                    Node(const std::chrono::nanoseconds &agingInterval) : jobs(agingInterval) {}
+                };
+                NumaTopology _topology;
+                std::vector<std::unique_ptr<Node>> _nodes;
+                std::vector<std::vector<unsigned int>> _pinnedCpus; // per node, empty when workers are not pinned.
+                inline unsigned int targetNode(const JobEntry &entry, const unsigned int &workerIndex) const;
+            public:
+                NumaJobQueue(NumaTopology topology, const std::chrono::nanoseconds &agingInterval);
+                void push(JobEntry &&entry, const unsigned int &workerIndex) override;
+                void push(std::vector<JobEntry> &&entries, const unsigned int &workerIndex) override;
+                bool tryPop(JobEntry &entry, const unsigned int &workerIndex) override;
+                std::vector<JobEntry> popAll() override;
+                size_t removeCancelled() override;
+                void setTenantWeight(const TenantId &tenant, const unsigned int &weight) override;
+
+                /** \brief Returns the amount of nodes. */
+                unsigned int nodeCount() const;
+
+                /** \brief Returns the node of a worker. */
+                unsigned int workerNode(const unsigned int &workerIndex) const;
+
+                /** \brief Restricts the calling worker to the CPUs of its node that the pool may use.
+                 *
+                 *  Workers are only pinned when there is more than one node, so on systems without
+                 *  NUMA information the inherited affinity of the workers is kept.
+                 */
+                void pinWorker(const unsigned int &workerIndex) const;
+            };
+        }
+    }
+}
+
+#endif // CCOL_THREAD_NUMAJOBQUEUE_HXX
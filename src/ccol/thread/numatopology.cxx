@@ -0,0 +1,154 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include "numatopology.hxx"
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            namespace {
+                bool readLine(const std::string &fileName, std::string &line)
+                {
+                    std::ifstream file(fileName);
+                    return file && std::getline(file, line);
+                }
+            }
+
+            std::vector<unsigned int> parseCpuList(const std::string &list)
+            {
+                std::vector<unsigned int> result;
+                std::istringstream stream(list);
+                std::string range;
+                while (std::getline(stream, range, ',')) {
+                    unsigned int first = 0;
+                    unsigned int last = 0;
+                    char separator = 0;
+                    std::istringstream rangeStream(range);
+                    if (!(rangeStream >> first)) continue; // empty list or trailing newline.
+                    last = first;
+                    if (rangeStream >> separator && separator == '-') {
+                        rangeStream >> last;
+                    }
+                    for (unsigned int cpu = first; cpu <= last; cpu++) {
+                        result.push_back(cpu);
+                    }
+                }
+                return result;
+            }
+
+            NumaTopology readNumaTopology(const std::string &path)
+            {
+                NumaTopology topology;
+                std::string line;
+                if (readLine(path + "/online", line)) {
+                    for (unsigned int node : parseCpuList(line)) {
+                        if (!readLine(path + "/node" + std::to_string(node) + "/cpulist", line)) continue;
+                        std::vector<unsigned int> cpus = parseCpuList(line);
+                        if (!cpus.empty()) { // memory only nodes have no workers.
+                            topology.nodeCpus.push_back(std::move(cpus));
+                        }
+                    }
+                }
+                if (topology.nodeCpus.empty()) {
+                    std::vector<unsigned int> cpus;
+                    for (unsigned int cpu = 0; cpu < std::max(std::thread::hardware_concurrency(), 1u); cpu++) {
+                        cpus.push_back(cpu);
+                    }
+                    topology.nodeCpus.push_back(std::move(cpus));
+                }
+                for (unsigned int node = 0; node < topology.nodeCpus.size(); node++) {
+                    for (unsigned int cpu : topology.nodeCpus[node]) {
+                        if (cpu >= topology.cpuNodes.size()) {
+                            topology.cpuNodes.resize(cpu + 1, 0);
+                        }
+                        topology.cpuNodes[cpu] = node;
+                    }
+                }
+                return topology;
+            }
+
+            unsigned int NumaTopology::currentNode() const
+            {
+                if (nodeCpus.size() == 1) return 0;
+#ifdef __linux__
+                const int cpu = sched_getcpu();
+                if (cpu >= 0 && static_cast<size_t>(cpu) < cpuNodes.size()) {
+                    return cpuNodes[cpu];
+                }
+#endif
+                return 0;
+            }
+
+            std::vector<unsigned int> currentThreadCpus()
+            {
+                std::vector<unsigned int> result;
+#ifdef __linux__
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                if (sched_getaffinity(0, sizeof(set), &set) != 0) return result;
+                for (unsigned int cpu = 0; cpu < CPU_SETSIZE; cpu++) {
+                    if (CPU_ISSET(cpu, &set)) result.push_back(cpu);
+                }
+#endif
+                return result;
+            }
+
+            void pinCurrentThread(const std::vector<unsigned int> &cpus)
+            {
+#ifdef __linux__
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for (unsigned int cpu : cpus) {
+                    if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+                }
+                pthread_setaffinity_np(pthread_self(), sizeof(set), &set); // failure leaves the thread unpinned.
+#else
+                (void)cpus;
+#endif
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_NUMATOPOLOGY_HXX
+#define CCOL_THREAD_NUMATOPOLOGY_HXX
+
+#include <string>
+#include <vector>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            /** \brief The NUMA nodes of the machine and the CPUs that belong to them.
+             *
+             *  Only nodes that have CPUs are listed, in the order of their node id. There is always
+             *  at least one node, on systems without NUMA information all CPUs belong to node 0.
+             */
+            struct NumaTopology
+            {
+                /** \brief The CPUs of every node. */
+                std::vector<std::vector<unsigned int>> nodeCpus;
+
+                /** \brief The node of every CPU, indexed by CPU number. */
+                std::vector<unsigned int> cpuNodes;
+
+                /** \brief Returns the node of the CPU the calling thread runs on, 0 when unknown. */
+                unsigned int currentNode() const;
+            };
+
+            /** \brief Parses a list in the sysfs cpulist format, for example "0-3,8,10-11". */
+            std::vector<unsigned int> parseCpuList(const std::string &list);
+
+            /** \brief Reads the topology from sysfs, path is the directory that contains the node directories. */
+            NumaTopology readNumaTopology(const std::string &path = "/sys/devices/system/node");
+
+            /** \brief Returns the CPUs the calling thread may run on, empty when unknown. */
+            std::vector<unsigned int> currentThreadCpus();
+
+            /** \brief Restricts the calling thread to the provided CPUs, does nothing on systems without support. */
+            void pinCurrentThread(const std::vector<unsigned int> &cpus);
+        }
+    }
+}
+
+#endif // CCOL_THREAD_NUMATOPOLOGY_HXX
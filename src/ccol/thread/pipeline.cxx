@@ -0,0 +1,289 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/pipeline.hxx>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <limits>
+#include <mutex>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            namespace {
+                // An empty place in the buffer of a SerialInOrder stage.
+                constexpr std::size_t noToken = std::numeric_limits<std::size_t>::max();
+            }
+
+            class PipelineCore::Impl : public std::enable_shared_from_this<PipelineCore::Impl>
+            {
+            private:
+                struct Stage
+                {
+                    StageMode mode;
+                    std::function<void(std::size_t)> function;
+                    std::deque<std::size_t> buffer; // the tokens waiting for a Parallel or Serial stage.
+                    std::vector<std::size_t> ordered; // the tokens waiting for a SerialInOrder stage, indexed by sequence modulo the amount of tokens.
+                    std::uint64_t nextSequence = 0;
+                    std::size_t reserved = 0; // places in the buffer promised to tokens in the previous stage.
+                    std::size_t running = 0;
+                };
+                ThreadPool &_pool;
+                std::size_t _tokenCount;
+                std::size_t _bufferCapacity;
+                std::function<bool(std::size_t)> _source;
+                std::vector<Stage> _stages;
+                std::mutex _mutex;
+                std::condition_variable _finishedCv;
+                std::vector<std::size_t> _freeTokens;
+                std::vector<std::uint64_t> _sequences; // the sequence number the source gave to each token.
+                std::uint64_t _nextSequence = 0;
+                bool _sourceRunning = false;
+                bool _exhausted = true;
+                std::atomic_bool _finished{true};
+                inline bool reserve(Stage &stage);
+                inline void deliver(Stage &stage, const std::size_t &token);
+                inline bool hasInput(const Stage &stage) const;
+                inline std::size_t takeInput(Stage &stage);
+                inline bool pick(std::size_t &step, std::size_t &token);
+                inline void complete(const std::size_t &step, const std::size_t &token, const bool &produced);
+                void dispatch();
+                void execute(const std::size_t &step, const std::size_t &token);
+            public:
+                Impl(ThreadPool &pool, const std::size_t &tokens, const std::size_t &bufferCapacity);
+                void setSource(std::function<bool(std::size_t)> &&source);
+                void addStage(const StageMode &mode, std::function<void(std::size_t)> &&function);
+                void run();
+            };
+
+            PipelineCore::Impl::Impl(ThreadPool &pool, const std::size_t &tokens, const std::size_t &bufferCapacity)
+                : _pool(pool), _tokenCount(tokens), _bufferCapacity(bufferCapacity == 0 ? tokens : bufferCapacity), _sequences(tokens)
+            {
+                for (std::size_t token = tokens; token > 0; token--) {
+                    _freeTokens.push_back(token - 1);
+                }
+            }
+
+            void PipelineCore::Impl::setSource(std::function<bool(std::size_t)> &&source)
+            {
+                _source = std::move(source);
+            }
+
+            void PipelineCore::Impl::addStage(const StageMode &mode, std::function<void(std::size_t)> &&function)
+            {
+                _stages.emplace_back();
+                Stage &stage = _stages.back();
+                stage.mode = mode;
+                stage.function = std::move(function);
+                if (mode == StageMode::SerialInOrder) {
+                    stage.ordered.assign(_tokenCount, noToken);
+                }
+            }
+
+            bool PipelineCore::Impl::reserve(Stage &stage)
+            {
+                if (stage.mode == StageMode::SerialInOrder) return true; // bounded by the amount of tokens, see StageMode.
+                if (stage.buffer.size() + stage.reserved >= _bufferCapacity) return false;
+                stage.reserved++;
+                return true;
+            }
+
+            void PipelineCore::Impl::deliver(Stage &stage, const std::size_t &token)
+            {
+                if (stage.mode == StageMode::SerialInOrder) {
+                    stage.ordered[_sequences[token] % _tokenCount] = token;
+                    return;
+                }
+                stage.reserved--;
+                stage.buffer.push_back(token);
+            }
+
+            bool PipelineCore::Impl::hasInput(const Stage &stage) const
+            {
+                if (stage.mode == StageMode::SerialInOrder) return stage.ordered[stage.nextSequence % _tokenCount] != noToken;
+                return !stage.buffer.empty();
+            }
+
+            std::size_t PipelineCore::Impl::takeInput(Stage &stage)
+            {
+                if (stage.mode == StageMode::SerialInOrder) {
+                    // the tokens in flight have consecutive sequence numbers from nextSequence on, so they never share a place.
+                    std::size_t &place = stage.ordered[stage.nextSequence++ % _tokenCount];
+                    const std::size_t token = place;
+                    place = noToken;
+                    return token;
+                }
+                const std::size_t token = stage.buffer.front();
+                stage.buffer.pop_front();
+                return token;
+            }
+
+            bool PipelineCore::Impl::pick(std::size_t &step, std::size_t &token)
+            {
+                // the last stages first, they make room for the others.
+                for (std::size_t index = _stages.size(); index > 0; index--) {
+                    Stage &stage = _stages[index - 1];
+                    if (stage.mode != StageMode::Parallel && stage.running > 0) continue;
+                    if (!hasInput(stage)) continue;
+                    if (index < _stages.size() && !reserve(_stages[index])) continue;
+                    token = takeInput(stage);
+                    stage.running++;
+                    step = index;
+                    return true;
+                }
+                if (_sourceRunning || _exhausted || _freeTokens.empty()) return false;
+                if (!_stages.empty() && !reserve(_stages.front())) return false;
+                token = _freeTokens.back();
+                _freeTokens.pop_back();
+                _sourceRunning = true;
+                step = 0;
+                return true;
+            }
+
+            void PipelineCore::Impl::complete(const std::size_t &step, const std::size_t &token, const bool &produced)
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (step == 0) {
+                    _sourceRunning = false;
+                    if (!produced) {
+                        _exhausted = true;
+                        if (!_stages.empty() && _stages.front().mode != StageMode::SerialInOrder) {
+                            _stages.front().reserved--;
+                        }
+                        _freeTokens.push_back(token);
+                    }
+                    else {
+                        _sequences[token] = _nextSequence++; // only items get a number, so in order stages never wait for a gap.
+                        if (_stages.empty()) {
+                            _freeTokens.push_back(token);
+                        }
+                        else {
+                            deliver(_stages.front(), token);
+                        }
+                    }
+                }
+                else {
+                    _stages[step - 1].running--;
+                    if (step == _stages.size()) {
+                        _freeTokens.push_back(token);
+                    }
+                    else {
+                        deliver(_stages[step], token);
+                    }
+                }
+                if (_exhausted && !_sourceRunning && _freeTokens.size() == _tokenCount) {
+                    _finished = true;
+                    _finishedCv.notify_all();
+                }
+            }
+
+            void PipelineCore::Impl::dispatch()
+            {
+                std::size_t step;
+                std::size_t token;
+                for (;;) {
+                    {
+                        std::unique_lock<std::mutex> lock(_mutex);
+                        if (!pick(step, token)) return;
+                    }
+                    // enqueued without the lock, a bounded pool might run the job on this thread.
+                    _pool.enqueue(Job([self = shared_from_this(), step, token] { self->execute(step, token); }));
+                }
+            }
+
+            void PipelineCore::Impl::execute(const std::size_t &step, const std::size_t &token)
+            {
+                bool produced = true;
+                if (step == 0) {
+                    produced = _source(token);
+                }
+                else {
+                    _stages[step - 1].function(token);
+                }
+                complete(step, token, produced);
+                dispatch();
+            }
+
+            void PipelineCore::Impl::run()
+            {
+                if (!_source) return;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _exhausted = false;
+                    _finished = false;
+                    for (auto &stage : _stages) {
+                        stage.nextSequence = _nextSequence;
+                    }
+                }
+                dispatch();
+                if (_pool.helpsWhileWaiting()) {
+                    _pool.helpUntil([this] { return _finished.load(); });
+                    return;
+                }
+                std::unique_lock<std::mutex> lock(_mutex);
+                _finishedCv.wait(lock, [this] { return _finished.load(); });
+            }
+
+            PipelineCore::PipelineCore(ThreadPool &pool, const std::size_t &tokens, const std::size_t &bufferCapacity)
+                : _impl(std::make_shared<Impl>(pool, tokens, bufferCapacity))
+            {
+            }
+
+            void PipelineCore::setSource(std::function<bool(std::size_t)> &&source)
+            {
+                _impl->setSource(std::move(source));
+            }
+
+            void PipelineCore::addStage(const StageMode &mode, std::function<void(std::size_t)> &&function)
+            {
+                _impl->addStage(mode, std::move(function));
+            }
+
+            void PipelineCore::run()
+            {
+                _impl->run();
+            }
+
+            PipelineCore::~PipelineCore()
+            {
+            }
+        }
+    }
+}
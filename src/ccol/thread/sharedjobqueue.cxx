@@ -0,0 +1,234 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include "sharedjobqueue.hxx"
+#include <algorithm>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            namespace {
+                // The pass of a tenant with weight 1 advances by this value per dispatched job, it is also the largest weight.
+                constexpr std::uint64_t unitStride = 1 << 20;
+                // Idle tenants are only swept when the map holds this many more tenants than are active.
+                constexpr size_t idleTenantSlack = 64;
+            }
+
+            SharedJobQueue::SharedJobQueue(const std::chrono::nanoseconds &agingInterval)
+                : _agingInterval(agingInterval)
+            {
+            }
+
+            std::uint64_t SharedJobQueue::stride(const TenantId &tenant) const
+            {
+                auto iterator = _strides.find(tenant);
+                return iterator == _strides.end() ? unitStride : iterator->second;
+            }
+
+            void SharedJobQueue::eraseIdleTenants(PriorityClass &priorityClass)
+            {
+                // the pass of an idle tenant is at most one stride ahead of the virtual time, a recreated tenant starts at
+                // the virtual time, so erasing it forgives at most one job.
+                for (auto iterator = priorityClass.tenants.begin(); iterator != priorityClass.tenants.end();) {
+                    const TenantQueue &tenantQueue = iterator->second;
+                    if (tenantQueue.jobs.empty() && tenantQueue.stride == unitStride) {
+                        iterator = priorityClass.tenants.erase(iterator);
+                    }
+                    else {
+                        ++iterator;
+                    }
+                }
+            }
+
+            void SharedJobQueue::lockedPush(JobEntry &&entry)
+            {
+                PriorityClass &priorityClass = _classes[static_cast<unsigned int>(entry.priority)];
+                auto iterator = priorityClass.tenants.find(entry.tenant);
+                if (iterator == priorityClass.tenants.end()) {
+                    if (priorityClass.tenants.size() >= 2 * priorityClass.active.size() + idleTenantSlack) {
+                        eraseIdleTenants(priorityClass);
+                    }
+                    iterator = priorityClass.tenants.emplace(entry.tenant, TenantQueue()).first;
+                    iterator->second.stride = stride(entry.tenant);
+                }
+                TenantQueue &tenantQueue = iterator->second;
+                if (tenantQueue.jobs.empty()) { // a tenant that becomes active can not claim the time it was idle.
+                    tenantQueue.pass = std::max(tenantQueue.pass, priorityClass.virtualTime);
+                    priorityClass.active.push_back(&tenantQueue);
+                }
+                tenantQueue.jobs.push_back(std::move(entry));
+                priorityClass.size++;
+                _size++;
+            }
+
+            void SharedJobQueue::push(JobEntry &&entry, const unsigned int &)
+            {
+                if (entry.priority != Priority::High && entry.enqueued == std::chrono::steady_clock::time_point()) {
+                    entry.enqueued = std::chrono::steady_clock::now(); // required for aging, unless the pool stamped it already.
+                }
+                std::unique_lock<std::mutex> lock(_mutex);
+                lockedPush(std::move(entry));
+            }
+
+            void SharedJobQueue::push(std::vector<JobEntry> &&entries, const unsigned int &)
+            {
+                if (!entries.empty() && entries.front().enqueued == std::chrono::steady_clock::time_point()) {
+                    const auto now = std::chrono::steady_clock::now();
+                    for (auto &entry : entries) {
+                        entry.enqueued = now;
+                    }
+                }
+                std::unique_lock<std::mutex> lock(_mutex);
+                for (auto &entry : entries) {
+                    lockedPush(std::move(entry));
+                }
+            }
+
+            unsigned int SharedJobQueue::selectClass()
+            {
+                unsigned int nonEmpty = 0;
+                unsigned int selected = priorityCount;
+                for (unsigned int idx = 0; idx < priorityCount; idx++) {
+                    if (_classes[idx].size == 0) continue;
+                    if (selected == priorityCount) selected = idx;
+                    nonEmpty++;
+                }
+                if (nonEmpty <= 1 || _agingInterval <= std::chrono::nanoseconds(0)) return selected;
+                // several classes have jobs, let the oldest job of the lower classes compete with its aged priority.
+                const auto now = std::chrono::steady_clock::now();
+                long long best = selected;
+                for (unsigned int idx = selected + 1; idx < priorityCount; idx++) {
+                    if (_classes[idx].size == 0) continue;
+                    auto oldest = now;
+                    for (const TenantQueue *tenantQueue : _classes[idx].active) {
+                        oldest = std::min(oldest, tenantQueue->jobs.front().enqueued);
+                    }
+                    const long long effective = static_cast<long long>(idx) - (now - oldest) / _agingInterval;
+                    if (effective < best) {
+                        best = effective;
+                        selected = idx;
+                    }
+                }
+                return selected;
+            }
+
+            JobEntry SharedJobQueue::popFrom(PriorityClass &priorityClass)
+            {
+                auto next = priorityClass.active.begin();
+                for (auto iterator = next + 1; iterator < priorityClass.active.end(); ++iterator) {
+                    if ((*iterator)->pass < (*next)->pass) next = iterator;
+                }
+                TenantQueue &tenantQueue = **next;
+                JobEntry entry = std::move(tenantQueue.jobs.front());
+                tenantQueue.jobs.pop_front();
+                priorityClass.virtualTime = tenantQueue.pass;
+                tenantQueue.pass += tenantQueue.stride;
+                if (tenantQueue.jobs.empty()) {
+                    *next = priorityClass.active.back();
+                    priorityClass.active.pop_back();
+                }
+                priorityClass.size--;
+                _size--;
+                return entry;
+            }
+
+            bool SharedJobQueue::tryPop(JobEntry &entry, const unsigned int &)
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (_size == 0) return false;
+                entry = popFrom(_classes[selectClass()]);
+                return true;
+            }
+
+            std::vector<JobEntry> SharedJobQueue::popAll()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                std::vector<JobEntry> result;
+                result.reserve(_size);
+                for (auto &priorityClass : _classes) {
+                    while (priorityClass.size > 0) {
+                        result.push_back(popFrom(priorityClass));
+                    }
+                }
+                return result;
+            }
+
+            size_t SharedJobQueue::removeCancelled()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                size_t removed = 0;
+                for (auto &priorityClass : _classes) {
+                    for (size_t idx = 0; idx < priorityClass.active.size();) {
+                        std::deque<JobEntry> &jobs = priorityClass.active[idx]->jobs;
+                        const size_t before = jobs.size();
+                        jobs.erase(std::remove_if(jobs.begin(), jobs.end(), [](JobEntry &entry) { return entry.isCancelled(); }), jobs.end());
+                        priorityClass.size -= before - jobs.size();
+                        removed += before - jobs.size();
+                        if (jobs.empty()) {
+                            priorityClass.active[idx] = priorityClass.active.back();
+                            priorityClass.active.pop_back();
+                        }
+                        else {
+                            idx++;
+                        }
+                    }
+                }
+                _size -= removed;
+                return removed;
+            }
+
+            void SharedJobQueue::setTenantWeight(const TenantId &tenant, const unsigned int &weight)
+            {
+                const std::uint64_t tenantStride = std::max<std::uint64_t>(unitStride / std::max(weight, 1u), 1); // a pass that never advances would starve the other tenants.
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (tenantStride == unitStride) {
+                    _strides.erase(tenant); // the default weight needs no entry.
+                }
+                else {
+                    _strides[tenant] = tenantStride;
+                }
+                for (auto &priorityClass : _classes) {
+                    auto iterator = priorityClass.tenants.find(tenant);
+                    if (iterator != priorityClass.tenants.end()) {
+                        iterator->second.stride = tenantStride;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,104 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_SHAREDJOBQUEUE_HXX
+#define CCOL_THREAD_SHAREDJOBQUEUE_HXX
+
+#include "jobqueue.hxx"
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            /** \brief A queue shared by all workers, guarded by one mutex.
+             *
+             *  Jobs are kept per priority class and, within a class, per tenant. The class with
+             *  the highest effective priority is served first, where the effective priority of a
+             *  class rises by one for every agingInterval its oldest job has been waiting. Within a
+             *  class the tenants are served by weighted fair queuing: every tenant has a virtual
+             *  pass that advances by the inverse of its weight for each dispatched job, the active
+             *  tenant with the lowest pass is served next.
+             *
+             *  With a single tenant and priority class this is a plain FIFO queue.
+             *
+             *  Idle tenants with the default weight are erased when the tenant map grows well
+             *  beyond the active tenants, so ephemeral tenant ids do not accumulate.
+             */
+            class SharedJobQueue : public JobQueue
+            {
+            private:
+                struct TenantQueue
+                {
+                    std::deque<JobEntry> jobs;
+                    std::uint64_t pass = 0;
+                    std::uint64_t stride;
+                };
+                struct PriorityClass
+                {
+                    std::unordered_map<TenantId, TenantQueue> tenants;
+                    std::vector<TenantQueue*> active;
+                    std::uint64_t virtualTime = 0;
+                    size_t size = 0;
+                };
+                std::mutex _mutex;
+                std::chrono::nanoseconds _agingInterval;
+                PriorityClass _classes[priorityCount];
+                std::unordered_map<TenantId, std::uint64_t> _strides;
+                size_t _size = 0;
+                inline std::uint64_t stride(const TenantId &tenant) const;
+                inline void eraseIdleTenants(PriorityClass &priorityClass);
+                inline void lockedPush(JobEntry &&entry);
+                inline unsigned int selectClass();
+                inline JobEntry popFrom(PriorityClass &priorityClass);
+            public:
+                SharedJobQueue(const std::chrono::nanoseconds &agingInterval);
+                void push(JobEntry &&entry, const unsigned int &workerIndex) override;
+                void push(std::vector<JobEntry> &&entries, const unsigned int &workerIndex) override;
+                bool tryPop(JobEntry &entry, const unsigned int &workerIndex) override;
+                std::vector<JobEntry> popAll() override;
+                size_t removeCancelled() override;
+                void setTenantWeight(const TenantId &tenant, const unsigned int &weight) override;
+            };
+        }
+    }
+}
+
+#endif // CCOL_THREAD_SHAREDJOBQUEUE_HXX
@@ -0,0 +1,177 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/strand.hxx>
+#include "mpscjobqueue.hxx"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+namespace ccol
+{
+    namespace thread
+    {
+        class Strand::Impl : public std::enable_shared_from_this<Strand::Impl>
+        {
+        private:
+            /** \brief The single pool job of the Strand, when it is destroyed without running it discards the queued jobs. */
+            class Turn
+            {
+            private:
+                std::shared_ptr<Impl> _impl;
+            public:
+                explicit Turn(std::shared_ptr<Impl> impl) noexcept : _impl(std::move(impl)) {}
+                Turn(Turn &&other) noexcept = default;
+                Turn &operator=(Turn &&other) = delete;
+                void operator()()
+                {
+                    std::shared_ptr<Impl> impl = std::move(_impl);
+                    impl->turn();
+                }
+                ~Turn()
+                {
+                    if (_impl) _impl->discard();
+                }
+            };
+
+            ThreadPool &_pool;
+            std::size_t _batchSize;
+            detail::MpscJobQueue _jobs;
+            std::atomic<std::size_t> _pendingCount{0};
+            std::atomic_bool _waiting{false};
+            std::mutex _waitMutex;
+            std::condition_variable _waitCv;
+
+            Job pop()
+            {
+                Job job;
+                // The count tells a job was pushed, the producer may still be linking it.
+                while (!_jobs.tryPop(job)) {
+                    std::this_thread::yield();
+                }
+                return job;
+            }
+
+        public:
+            Impl(ThreadPool &pool, const std::size_t &batchSize)
+                : _pool(pool), _batchSize(std::max<std::size_t>(batchSize, 1)), _jobs(pool.blockPool())
+            {
+            }
+
+            void enqueue(Job &&job)
+            {
+                const bool idle = _pendingCount.fetch_add(1, std::memory_order_acq_rel) == 0;
+                _jobs.push(std::move(job));
+                if (idle) { // the first job of an idle Strand schedules its turn.
+                    _pool.enqueue(Job(Turn(shared_from_this())));
+                }
+            }
+
+            void idle()
+            {
+                if (_waiting.load()) {
+                    std::unique_lock<std::mutex> lock(_waitMutex);
+                    _waitCv.notify_all();
+                }
+            }
+
+            void turn()
+            {
+                const std::size_t count = std::min(_pendingCount.load(std::memory_order_acquire), _batchSize);
+                for (std::size_t i = 0; i < count; i++) {
+                    pop()();
+                }
+                if (_pendingCount.fetch_sub(count, std::memory_order_acq_rel) != count) {
+                    _pool.enqueue(Job(Turn(shared_from_this())));
+                } else {
+                    idle();
+                }
+            }
+
+            void discard()
+            {
+                // Without a turn on the pool nothing else pops, so discarding until the Strand is idle needs no new turn.
+                std::size_t count = _pendingCount.load(std::memory_order_acquire);
+                while (count > 0) {
+                    for (std::size_t i = 0; i < count; i++) {
+                        pop();
+                    }
+                    count = _pendingCount.fetch_sub(count, std::memory_order_acq_rel) - count;
+                }
+                idle();
+            }
+
+            std::size_t pendingCount() const
+            {
+                return _pendingCount.load();
+            }
+
+            void wait()
+            {
+                if (_pendingCount.load() == 0) return;
+                std::unique_lock<std::mutex> lock(_waitMutex);
+                _waiting.store(true);
+                _waitCv.wait(lock, [this]{ return _pendingCount.load() == 0; });
+            }
+        };
+
+        Strand::Strand(ThreadPool &pool, const std::size_t &batchSize)
+            : _impl(std::make_shared<Impl>(pool, batchSize))
+        {
+        }
+
+        void Strand::enqueue(Job &&job)
+        {
+            _impl->enqueue(std::move(job));
+        }
+
+        std::size_t Strand::pendingCount() const
+        {
+            return _impl->pendingCount();
+        }
+
+        void Strand::wait()
+        {
+            _impl->wait();
+        }
+
+        Strand::~Strand()
+        {
+            wait();
+        }
+    }
+}
@@ -0,0 +1,263 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/taskgraph.hxx>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <limits>
+#include <mutex>
+#include <vector>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace {
+            constexpr TaskGraph::NodeId noNode = std::numeric_limits<TaskGraph::NodeId>::max();
+        }
+
+        class TaskGraph::Impl
+        {
+        private:
+            struct Node
+            {
+                std::function<void()> task;
+                std::vector<NodeId> successors;
+                std::size_t predecessors = 0;
+                std::atomic<std::size_t> remaining{0};
+            };
+            std::deque<Node> _nodes; // a deque, so nodes never move.
+            std::vector<NodeId> _roots;
+            bool _validated = true;
+            bool _acyclic = true;
+            ThreadPool *_pool = nullptr;
+            std::atomic<std::size_t> _pending{0};
+            std::mutex _mutex;
+            std::condition_variable _finishedCv;
+            std::atomic_bool _running{false}; // changed under _mutex, read without it by threads that help the pool.
+            inline bool validate();
+            inline void enqueue(const NodeId &node);
+            void execute(NodeId node);
+        public:
+            inline NodeId addNode(std::function<void()> &&task);
+            inline bool addEdge(const NodeId &from, const NodeId &to);
+            inline std::size_t nodeCount() const;
+            inline bool start(ThreadPool &pool);
+            inline void wait();
+            inline bool wait_for(const std::chrono::nanoseconds &timeout);
+        };
+
+        TaskGraph::NodeId TaskGraph::Impl::addNode(std::function<void()> &&task)
+        {
+            _nodes.emplace_back();
+            _nodes.back().task = std::move(task);
+            _validated = false;
+            return _nodes.size() - 1;
+        }
+
+        bool TaskGraph::Impl::addEdge(const NodeId &from, const NodeId &to)
+        {
+            if (from >= _nodes.size() || to >= _nodes.size() || from == to) return false;
+            _nodes[from].successors.push_back(to);
+            _nodes[to].predecessors++;
+            _validated = false;
+            return true;
+        }
+
+        std::size_t TaskGraph::Impl::nodeCount() const
+        {
+            return _nodes.size();
+        }
+
+        bool TaskGraph::Impl::validate()
+        {
+            if (_validated) return _acyclic;
+            _roots.clear();
+            std::vector<std::size_t> remaining(_nodes.size());
+            std::vector<NodeId> ready;
+            for (NodeId node = 0; node < _nodes.size(); node++) {
+                remaining[node] = _nodes[node].predecessors;
+                if (remaining[node] == 0) {
+                    _roots.push_back(node);
+                    ready.push_back(node);
+                }
+            }
+            std::size_t visited = 0; // a topological sort visits every node, unless some are part of a cycle.
+            while (!ready.empty()) {
+                const NodeId node = ready.back();
+                ready.pop_back();
+                visited++;
+                for (const NodeId successor : _nodes[node].successors) {
+                    if (--remaining[successor] == 0) {
+                        ready.push_back(successor);
+                    }
+                }
+            }
+            _acyclic = visited == _nodes.size();
+            _validated = true;
+            return _acyclic;
+        }
+
+        bool TaskGraph::Impl::start(ThreadPool &pool)
+        {
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (_running || !validate()) return false;
+                if (_nodes.empty()) return true;
+                _running = true;
+                _pool = &pool;
+            }
+            for (auto &node : _nodes) {
+                node.remaining.store(node.predecessors, std::memory_order_relaxed);
+            }
+            _pending.store(_nodes.size(), std::memory_order_release); // the enqueue publishes the counters to the workers.
+            for (const NodeId root : _roots) {
+                enqueue(root);
+            }
+            return true;
+        }
+
+        void TaskGraph::Impl::enqueue(const NodeId &node)
+        {
+            _pool->enqueue([this, node]{ execute(node); });
+        }
+
+        void TaskGraph::Impl::execute(NodeId node)
+        {
+            while (node != noNode) {
+                Node &current = _nodes[node];
+                current.task();
+                NodeId continuation = noNode;
+                for (const NodeId successor : current.successors) {
+                    if (_nodes[successor].remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) continue;
+                    if (continuation == noNode) {
+                        continuation = successor; // executed by this job, which saves a round trip through the queue.
+                    }
+                    else {
+                        enqueue(successor);
+                    }
+                }
+                if (_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) { // the last task, the graph may be destroyed after the notification.
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _running = false;
+                    _finishedCv.notify_all();
+                    return;
+                }
+                node = continuation;
+            }
+        }
+
+        void TaskGraph::Impl::wait()
+        {
+            ThreadPool *pool = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (!_running) return;
+                pool = _pool;
+            }
+            if (pool->helpsWhileWaiting()) {
+                pool->helpUntil([this]{ return !_running.load(); });
+            }
+            // also when helping, the lock waits until the last task no longer uses the graph.
+            std::unique_lock<std::mutex> lock(_mutex);
+            _finishedCv.wait(lock, [this]{ return !_running; });
+        }
+
+        bool TaskGraph::Impl::wait_for(const std::chrono::nanoseconds &timeout)
+        {
+            ThreadPool *pool = nullptr;
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (!_running) return true;
+                pool = _pool;
+            }
+            if (pool->helpsWhileWaiting()) {
+                if (!pool->helpUntilFor([this]{ return !_running.load(); }, timeout)) return false;
+                std::unique_lock<std::mutex> lock(_mutex);
+                return !_running;
+            }
+            std::unique_lock<std::mutex> lock(_mutex);
+            return _finishedCv.wait_for(lock, timeout, [this]{ return !_running; });
+        }
+
+        TaskGraph::TaskGraph()
+            : _impl(std::make_unique<Impl>())
+        {
+        }
+
+        TaskGraph::NodeId TaskGraph::addNode(std::function<void()> task)
+        {
+            return _impl->addNode(std::move(task));
+        }
+
+        bool TaskGraph::addEdge(const NodeId &from, const NodeId &to)
+        {
+            return _impl->addEdge(from, to);
+        }
+
+        std::size_t TaskGraph::nodeCount() const
+        {
+            return _impl->nodeCount();
+        }
+
+        bool TaskGraph::start(ThreadPool &pool)
+        {
+            return _impl->start(pool);
+        }
+
+        void TaskGraph::wait()
+        {
+            _impl->wait();
+        }
+
+        bool TaskGraph::wait_for(const std::chrono::nanoseconds &timeout)
+        {
+            return _impl->wait_for(timeout);
+        }
+
+        bool TaskGraph::run(ThreadPool &pool)
+        {
+            if (!_impl->start(pool)) return false;
+            _impl->wait();
+            return true;
+        }
+
+        TaskGraph::~TaskGraph()
+        {
+            _impl->wait();
+        }
+    }
+}
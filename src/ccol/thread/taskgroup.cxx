@@ -0,0 +1,106 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/taskgroup.hxx>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            void TaskGroupState::finished()
+            {
+                if (_pending.fetch_sub(1) != 1) return;
+                // Only the last job looks for waiters. Both _pending and _waiting are sequentially
+                // consistent, so either this load sees the waiter or the waiter sees zero.
+                if (_waiting.load()) {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _cv.notify_all();
+                }
+            }
+
+            void TaskGroupState::wait()
+            {
+                if (_pending.load() == 0) return;
+                std::unique_lock<std::mutex> lock(_mutex);
+                _waiting.store(true);
+                _cv.wait(lock, [this]{ return _pending.load() == 0; });
+            }
+
+            bool TaskGroupState::wait_for(const std::chrono::nanoseconds &timeout)
+            {
+                if (_pending.load() == 0) return true;
+                std::unique_lock<std::mutex> lock(_mutex);
+                _waiting.store(true);
+                return _cv.wait_for(lock, timeout, [this]{ return _pending.load() == 0; });
+            }
+        }
+
+        TaskGroup::TaskGroup(ThreadPool &pool)
+            : _pool(pool), _state(std::make_shared<detail::TaskGroupState>())
+        {
+        }
+
+        std::size_t TaskGroup::pendingCount() const
+        {
+            return _state->pending();
+        }
+
+        void TaskGroup::wait()
+        {
+            if (_pool.helpsWhileWaiting()) {
+                detail::TaskGroupState *state = _state.get();
+                _pool.helpUntil([state]{ return state->pending() == 0; });
+                return;
+            }
+            _state->wait();
+        }
+
+        bool TaskGroup::wait_for(const std::chrono::nanoseconds &timeout)
+        {
+            if (_pool.helpsWhileWaiting()) {
+                detail::TaskGroupState *state = _state.get();
+                return _pool.helpUntilFor([state]{ return state->pending() == 0; }, timeout);
+            }
+            return _state->wait_for(timeout);
+        }
+
+        TaskGroup::~TaskGroup()
+        {
+            wait();
+        }
+    }
+}
@@ -0,0 +1,162 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+
+#include <ccol/thread/threadoptions.hxx>
+#include <algorithm>
+#include <mutex>
+#ifdef __linux__
+#include <climits>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+#if defined(__linux__) && defined(__GLIBC__)
+            namespace {
+                // The default thread attributes of the process, read on construction.
+                struct DefaultAttributes
+                {
+                    pthread_attr_t attributes;
+                    const bool valid;
+                    DefaultAttributes() : valid(pthread_getattr_default_np(&attributes) == 0) {}
+                    DefaultAttributes(const DefaultAttributes &) = delete;
+                    DefaultAttributes &operator=(const DefaultAttributes &) = delete;
+                    ~DefaultAttributes()
+                    {
+                        if (valid) pthread_attr_destroy(&attributes);
+                    }
+                };
+
+                // Restores the default thread attributes of the process, also when creating the thread throws.
+                class DefaultAttributesRestorer
+                {
+                private:
+                    const pthread_attr_t &_defaults;
+                public:
+                    explicit DefaultAttributesRestorer(const pthread_attr_t &defaults) : _defaults(defaults) {}
+                    DefaultAttributesRestorer(const DefaultAttributesRestorer &) = delete;
+                    DefaultAttributesRestorer &operator=(const DefaultAttributesRestorer &) = delete;
+                    ~DefaultAttributesRestorer()
+                    {
+                        pthread_setattr_default_np(&_defaults);
+                    }
+                };
+            }
+#endif
+
+            bool applyThreadOptions(const ThreadOptions &options, const unsigned int &index)
+            {
+                bool applied = true;
+#ifdef __linux__
+                if (!options.cpuSets.empty()) {
+                    const std::vector<unsigned int> &cpus = options.cpuSets[index == unnumbered ? 0 : index % options.cpuSets.size()];
+                    cpu_set_t set;
+                    CPU_ZERO(&set);
+                    for (unsigned int cpu : cpus) {
+                        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+                    }
+                    applied = pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0 && applied;
+                }
+                if (options.policy != SchedulingPolicy::Inherit) {
+                    int policy = SCHED_OTHER;
+                    switch (options.policy) {
+                    case SchedulingPolicy::Batch: policy = SCHED_BATCH; break;
+                    case SchedulingPolicy::Idle: policy = SCHED_IDLE; break;
+                    case SchedulingPolicy::Fifo: policy = SCHED_FIFO; break;
+                    case SchedulingPolicy::RoundRobin: policy = SCHED_RR; break;
+                    default: break;
+                    }
+                    sched_param parameters{};
+                    parameters.sched_priority = policy == SCHED_FIFO || policy == SCHED_RR ? options.priority : 0;
+                    applied = pthread_setschedparam(pthread_self(), policy, &parameters) == 0 && applied;
+                }
+                if (!options.name.empty()) {
+                    std::string name = index == unnumbered ? options.name : options.name + std::to_string(index);
+                    name.resize(std::min<std::size_t>(name.size(), 15)); // the limit of Linux, longer names are refused.
+                    applied = pthread_setname_np(pthread_self(), name.c_str()) == 0 && applied;
+                }
+#else
+                (void)options;
+                (void)index;
+#endif
+                return applied;
+            }
+
+            std::thread createThread(const std::size_t &stackSize, std::function<void()> &&function)
+            {
+#if defined(__linux__) && defined(__GLIBC__)
+                if (stackSize != 0) {
+                    // std::thread takes no attributes, so the default attributes of the process are
+                    // changed while the thread is created. Threads that other code creates at the
+                    // same moment may get the stack size as well.
+                    static std::mutex defaultsMutex;
+                    std::lock_guard<std::mutex> lock(defaultsMutex);
+                    DefaultAttributes defaults;
+                    DefaultAttributes attributes;
+                    if (defaults.valid && attributes.valid) {
+                        pthread_attr_setstacksize(&attributes.attributes, std::max<std::size_t>(stackSize, PTHREAD_STACK_MIN));
+                        if (pthread_setattr_default_np(&attributes.attributes) == 0) {
+                            DefaultAttributesRestorer restorer(defaults.attributes);
+                            return std::thread(std::move(function));
+                        }
+                    }
+                }
+#else
+                (void)stackSize;
+#endif
+                return std::thread(std::move(function));
+            }
+        }
+
+        bool applyThreadOptions(const ThreadOptions &options)
+        {
+            return detail::applyThreadOptions(options, detail::unnumbered);
+        }
+
+        std::thread createThread(const ThreadOptions &options, std::function<void()> function)
+        {
+            return detail::createThread(options.stackSize, [options, function = std::move(function)] {
+                detail::applyThreadOptions(options, detail::unnumbered);
+                function();
+            });
+        }
+    }
+}
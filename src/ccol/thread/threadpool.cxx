@@ -34,68 +34,278 @@ If you'd like to modify and/or share this code, share it under the same license,
 If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
 */
 #include <ccol/thread/threadpool.hxx>
+#include <ccol/thread/queuepolicy.hxx>
+#include "deadlinejobqueue.hxx"
+#include "numajobqueue.hxx"
+#include "ringjobqueue.hxx"
+#include "sharedjobqueue.hxx"
+#include "timerqueue.hxx"
+#include "workstealingjobqueue.hxx"
 #include <vector>
 #include <thread>
 #include <mutex>
 #include <atomic>
 #include <queue>
 #include <condition_variable>
+#include <type_traits>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <deque>
 
 namespace ccol
 {
     namespace thread {
 
+        constexpr unsigned int WorkerContext::externalWorker;
+
+        namespace {
+            // Identifies the pool and worker index of the current thread, used to keep jobs local to a worker.
+            thread_local const void *currentPool = nullptr;
+            thread_local unsigned int currentWorker = detail::noWorker;
+            // The context of the worker that runs on the current thread, set before the worker runs its first job.
+            thread_local WorkerContext *currentContext = nullptr;
+            // The pool of the innermost job the current thread is executing, workers and helping threads alike.
+            thread_local const void *executingPool = nullptr;
+            // The amount of jobs of executingPool the current thread is executing, more than one when a job helps while waiting.
+            thread_local size_t executingDepth = 0;
+            // The part of executingDepth the current thread has added to the waiting jobs of executingPool.
+            thread_local size_t waitingDepth = 0;
+            // The part of executingDepth that are keyed jobs, while it is non-zero helping skips the affinity lanes.
+            thread_local size_t keyedDepth = 0;
+
+            // The least amount of iterations an adaptive spin shrinks to.
+            constexpr unsigned int minimumSpinCount = 16;
+
+            // The metrics of one worker. Only the worker writes them, readers take a consistent copy by
+            // checking the sequence number, which is odd while the worker updates the counters.
+            struct WorkerCounters
+            {
+                std::atomic<std::uint64_t> sequence{0};
+                std::atomic<std::uint64_t> jobsExecuted{0};
+                std::atomic<std::int64_t> busyTime{0};
+                std::atomic<std::int64_t> idleTime{0};
+                std::array<std::atomic<std::uint64_t>, DurationHistogram::bucketCount> queueWaitTime;
+                std::array<std::atomic<std::uint64_t>, DurationHistogram::bucketCount> runTime;
+                char padding[64]; // keep the counters of different workers on different cache lines.
+
+                WorkerCounters()
+                {
+                    for (std::size_t bucket = 0; bucket < DurationHistogram::bucketCount; bucket++) {
+                        queueWaitTime[bucket].store(0, std::memory_order_relaxed);
+                        runTime[bucket].store(0, std::memory_order_relaxed);
+                    }
+                }
+
+                template<class T>
+                static void add(std::atomic<T> &counter, const T &value)
+                {
+                    // a single writer needs no read-modify-write, release makes a torn copy detectable.
+                    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_release);
+                }
+
+                void record(const std::chrono::nanoseconds &wait, const std::chrono::nanoseconds &run, const std::chrono::nanoseconds &idle)
+                {
+                    const std::uint64_t current = sequence.load(std::memory_order_relaxed);
+                    sequence.store(current + 1, std::memory_order_relaxed);
+                    add<std::uint64_t>(jobsExecuted, 1);
+                    add<std::int64_t>(busyTime, run.count());
+                    add<std::int64_t>(idleTime, idle.count());
+                    add<std::uint64_t>(queueWaitTime[DurationHistogram::bucketOf(wait)], 1);
+                    add<std::uint64_t>(runTime[DurationHistogram::bucketOf(run)], 1);
+                    sequence.store(current + 2, std::memory_order_release);
+                }
+
+                WorkerMetrics read() const
+                {
+                    WorkerMetrics result;
+                    for (;;) {
+                        const std::uint64_t before = sequence.load(std::memory_order_acquire);
+                        if ((before & 1) != 0) { // the worker is updating.
+                            std::this_thread::yield();
+                            continue;
+                        }
+                        result.jobsExecuted = jobsExecuted.load(std::memory_order_acquire);
+                        result.busyTime = std::chrono::nanoseconds(busyTime.load(std::memory_order_acquire));
+                        result.idleTime = std::chrono::nanoseconds(idleTime.load(std::memory_order_acquire));
+                        for (std::size_t bucket = 0; bucket < DurationHistogram::bucketCount; bucket++) {
+                            result.queueWaitTime.buckets[bucket] = queueWaitTime[bucket].load(std::memory_order_acquire);
+                            result.runTime.buckets[bucket] = runTime[bucket].load(std::memory_order_acquire);
+                        }
+                        if (sequence.load(std::memory_order_relaxed) == before) return result;
+                    }
+                }
+            };
+
+            // Spreads the bits of an affinity key, so consecutive keys end up in different slots.
+            inline std::uint64_t mixKey(std::uint64_t key)
+            {
+                key ^= key >> 30;
+                key *= 0xbf58476d1ce4e5b9ULL;
+                key ^= key >> 27;
+                key *= 0x94d049bb133111ebULL;
+                return key ^ (key >> 31);
+            }
+
+            // The keyed jobs routed to one worker.
+            struct AffinityLane
+            {
+                std::mutex mutex;
+                std::deque<detail::JobEntry> jobs;
+                std::atomic<size_t> backlog{0};
+                std::atomic_bool parked{false};
+                char padding[64]; // keep the lanes of different workers on different cache lines.
+            };
+
+            // Moves the element out of the container, unless the container is an lvalue which must be copied.
+            template<class Container, class T>
+            inline std::conditional_t<std::is_lvalue_reference<Container>::value, T&, T&&> forwardElement(T &element)
+            {
+                return static_cast<std::conditional_t<std::is_lvalue_reference<Container>::value, T&, T&&>>(element);
+            }
+        }
+
         class ThreadPool::Impl
         {
         private:
-            unsigned int _threadCount = 0;
+            std::atomic<unsigned int> _threadCount{0};
+            unsigned int _minThreads = 0;
+            unsigned int _maxThreads = 0;
+            bool _elastic = false;
+            std::chrono::nanoseconds _idleTimeout;
+            unsigned int _startingCount = 0; // threads that are created but did not look for jobs yet.
+            std::function<void(std::thread&)> _threadCreateCallback;
+            ThreadOptions _threadOptions;
+            std::vector<unsigned int> _freeWorkers;
             std::condition_variable _totalReducedCountCv;
-            size_t _totalJobsCount = 0;
+            std::atomic<size_t> _totalJobsCount{0};
+            std::atomic<size_t> _queuedJobsCount{0};
+            std::atomic<unsigned int> _parkedCount{0};
+            std::atomic<unsigned int> _spinningCount{0};
+            bool _helpWhileWaiting = false;
+            std::atomic<unsigned int> _parkedHelpers{0}; // threads that help while waiting and found no job.
+            std::atomic<size_t> _waitingJobs{0}; // jobs that are waiting for the pool from within, see wait().
+            IdleStrategy _idleStrategy = IdleStrategy::Park;
+            std::unique_ptr<WorkerCounters[]> _counters; // only allocated when metrics are enabled.
+            unsigned int _spinCount = 0;
             std::condition_variable _jobsCv;
-            std::vector<std::thread> _threads;
-            std::queue<std::function<void()>> _jobs;
+            std::vector<std::thread> _threads; // indexed by worker index, a stopped thread is joined when its slot is reused.
+            std::unique_ptr<detail::JobQueue> _jobs;
+            detail::NumaJobQueue *_numaJobs = nullptr; // points to _jobs when the pool uses Scheduling::Numa.
+            bool _bounded = false;
+            Overflow _overflow = Overflow::Block;
+            std::atomic<unsigned int> _blockedProducers{0};
+            std::mutex _spaceMutex; // only used by producers that wait for space in a bounded queue.
+            std::condition_variable _spaceCv;
+            std::unique_ptr<AffinityLane[]> _lanes;
+            unsigned int _laneCount = 0;
+            std::unique_ptr<std::atomic<std::uint64_t>[]> _keySlots; // the lane of a key slot in the high half, its pending jobs in the low half.
+            size_t _keySlotMask = 0;
+            size_t _affinitySkew = 0;
+            std::function<std::shared_ptr<void>(unsigned int)> _workerContextFactory;
+            size_t _workerArenaSize = 0;
+            std::mutex _contextMutex; // only used by threads outside the pool that borrow a context.
+            std::vector<std::unique_ptr<WorkerContext>> _externalContexts;
+            std::function<void(Job&&)> _deadlineMissedCallback;
+            std::atomic<std::uint64_t> _deadlineMisses{0};
+            std::shared_ptr<detail::TimerQueue> _timers; // shared with the handles of scheduled jobs, which may outlive the pool.
+            std::shared_ptr<util::BlockPool> _blockPool;
             std::mutex _stateMutex;
-            volatile bool _running = true;
-            void threadSpinner();
-            inline std::function<void()> threadRetrieveCallback(const bool &reduceJobs);
-            inline void lockedEnqueue(const std::vector<std::function<void()>> &jobs);
-            inline void lockedEnqueue(const std::function<void()> &job);
-            inline void lockedEnqueue(std::vector<std::function<void()>> &&jobs);
-            inline void lockedEnqueue(std::queue<std::function<void()>> &&jobs);
-            inline void lockedEnqueue(std::function<void()> &&job);
+            std::atomic_bool _running{true};
+            void threadSpinner(const unsigned int workerIndex);
+            inline unsigned int workerIndex() const;
+            inline bool spin(detail::JobEntry &entry, const unsigned int workerIndex, unsigned int &spinLimit);
+            inline bool park(const unsigned int workerIndex);
+            inline void startThread();
+            inline void grow();
+            inline void jobsAdded(const size_t &count);
+            inline void jobsReduced(const size_t &count);
+            inline void execute(detail::JobEntry &entry, WorkerCounters *counters, std::chrono::steady_clock::time_point &idleSince);
+            inline void stamp(detail::JobEntry &entry) const;
+            inline void push(detail::JobEntry &&entry);
+            inline void push(std::vector<detail::JobEntry> &&entries);
+            inline bool tryPush(detail::JobEntry &entry);
+            inline bool pushWhenSpace(detail::JobEntry &entry, const bool &timed, const std::chrono::nanoseconds &timeout);
+            inline void spaceAvailable(const size_t &count);
+            inline bool executingKeyed() const;
+            inline bool hasKeyed(const unsigned int workerIndex) const;
+            inline bool popKeyed(detail::JobEntry &entry, const unsigned int workerIndex);
+            inline unsigned int route(const size_t &slot);
+            inline unsigned int balancedLane(const unsigned int &home) const;
+            inline std::vector<detail::JobEntry> popAllKeyed();
+            template<class Jobs>
+            inline void pushConverted(Jobs &&jobs, const Priority &priority = Priority::Normal, const TenantId &tenant = 0);
+            template<class T>
+            inline void pushConverted(std::queue<T> &&jobs);
         public:
-            Impl(const unsigned int &threads, const std::function<void(std::thread&)> &threadCreateCallback);
-            inline void enqueue(const std::function<void()> &job);
+            Impl(const ThreadPoolOptions &options);
+            inline void enqueue(const Priority &priority, const TenantId &tenant, Job &&job);
+            inline void enqueue(const Priority &priority, const TenantId &tenant, std::vector<Job> &&jobs);
             inline void enqueue(const std::vector<std::function<void()>> &jobs);
-            inline void enqueue(std::function<void()> &&job);
             inline void enqueue(std::vector<std::function<void()>> &&jobs);
             inline void enqueue(std::queue<std::function<void()>> &&jobs);
+            inline void enqueue(std::queue<Job> &&jobs);
+            inline void setTenantWeight(const TenantId &tenant, const unsigned int &weight);
+            inline bool tryEnqueue(Job &job, const bool &timed, const std::chrono::nanoseconds &timeout);
+            inline void enqueue(const util::CancellationToken &token, Job &&job);
+            inline void enqueue(const util::CancellationToken &token, std::vector<Job> &&jobs);
+            inline size_t purgeCancelled();
+            inline void enqueueOnNode(const unsigned int &node, Job &&job);
+            inline void enqueueOnNode(const unsigned int &node, std::vector<Job> &&jobs);
+            inline void enqueue(const AffinityKey &key, Job &&job);
+            inline void enqueue(const std::chrono::steady_clock::time_point &deadline, Job &&job);
+            inline ScheduledJob schedule(const std::chrono::steady_clock::time_point &due, const std::chrono::nanoseconds &interval, Job &&job);
+            inline size_t scheduledCount();
+            inline unsigned int nodeCount() const;
+            inline ThreadPoolMetrics metrics();
             inline size_t queueCount();
             inline size_t totalJobCount();
             inline unsigned int threadCount() const;
+            inline unsigned int maxThreadCount() const;
+            inline const std::shared_ptr<util::BlockPool> &blockPool() const;
             inline void clear();
-            inline std::queue<std::function<void()>> dequeueAll();
+            inline std::queue<Job> dequeueAll();
             void wait();
             bool wait_for(const std::chrono::nanoseconds &timeout);
+            inline bool helpsWhileWaiting() const;
+            inline WorkerContext &acquireContext();
+            inline void releaseContext(WorkerContext &context);
+            bool runPendingJob();
+            bool help(const std::function<bool()> &done, const bool &timed, const std::chrono::nanoseconds &timeout);
+            bool helpWhileWaiting(const bool &timed, const std::chrono::nanoseconds &timeout);
             ~Impl();
         };
 
         inline void ThreadPool::Impl::clear()
         {
-            std::unique_lock<std::mutex> jobsMutexLock( _stateMutex );
-            _jobs = std::queue<std::function<void()>>();
+            const size_t count = _jobs->popAll().size();
+            _queuedJobsCount -= count;
+            jobsReduced(count + popAllKeyed().size());
+            spaceAvailable(count);
         }
 
-        inline std::queue<std::function<void()>> ThreadPool::Impl::dequeueAll()
+        inline std::queue<Job> ThreadPool::Impl::dequeueAll()
         {
-            std::unique_lock<std::mutex> jobsMutexLock( _stateMutex );
-            std::queue<std::function<void()>> result = std::move(_jobs);
-            _jobs = std::queue<std::function<void()>>(); // create new empty queue/
+            std::queue<Job> result;
+            for (auto &entry : _jobs->popAll()) {
+                result.push(std::move(entry.job));
+            }
+            const size_t count = result.size();
+            for (auto &entry : popAllKeyed()) {
+                result.push(std::move(entry.job));
+            }
+            _queuedJobsCount -= count;
+            jobsReduced(result.size());
+            spaceAvailable(count);
             return result;
         }
 
         void ThreadPool::Impl::wait()
         {
+             if (_helpWhileWaiting) {
+                 helpWhileWaiting(false, std::chrono::nanoseconds(0));
+                 return;
+             }
              std::unique_lock<std::mutex> lock(_stateMutex);
              return _totalReducedCountCv.wait(lock,[this]{
                  return _totalJobsCount==0 || !_running;
@@ -104,188 +314,900 @@ namespace ccol
 
         bool ThreadPool::Impl::wait_for(const std::chrono::nanoseconds &timeout)
         {
+            if (_helpWhileWaiting) {
+                return helpWhileWaiting(true, timeout);
+            }
             std::unique_lock<std::mutex> lock(_stateMutex);
             return _totalReducedCountCv.wait_for(lock,timeout,[this]{
                 return _totalJobsCount==0 || !_running;
             });
         }
 
+        bool ThreadPool::Impl::helpWhileWaiting(const bool &timed, const std::chrono::nanoseconds &timeout)
+        {
+            // a job that waits for the pool can not wait for itself, nor for the jobs that wait with it.
+            const size_t own = executingPool == this ? executingDepth - waitingDepth : 0;
+            const size_t previousDepth = waitingDepth;
+            if (own > 0) {
+                waitingDepth = executingDepth;
+                _waitingJobs += own;
+                std::unique_lock<std::mutex> lock(_stateMutex); // the other waiters might be satisfied now.
+                _totalReducedCountCv.notify_all();
+                _jobsCv.notify_all();
+            }
+            // a thread outside of the pool also waits for the jobs that wait.
+            const bool idle = executingPool == this ? help([this]{ return _totalJobsCount <= _waitingJobs; }, timed, timeout)
+                                      : help([this]{ return _totalJobsCount == 0; }, timed, timeout);
+            if (own > 0) {
+                _waitingJobs -= own;
+                waitingDepth = previousDepth;
+            }
+            return idle;
+        }
+
+        bool ThreadPool::Impl::helpsWhileWaiting() const
+        {
+            return _helpWhileWaiting;
+        }
+
+        WorkerContext &ThreadPool::Impl::acquireContext()
+        {
+            if (currentPool == this) return *currentContext;
+            {
+                std::unique_lock<std::mutex> lock(_contextMutex);
+                if (!_externalContexts.empty()) {
+                    WorkerContext *context = _externalContexts.back().release();
+                    _externalContexts.pop_back();
+                    return *context;
+                }
+            }
+            return *new WorkerContext(WorkerContext::externalWorker, _workerArenaSize,
+                                      _workerContextFactory ? _workerContextFactory(WorkerContext::externalWorker) : nullptr);
+        }
+
+        void ThreadPool::Impl::releaseContext(WorkerContext &context)
+        {
+            if (context.workerIndex() != WorkerContext::externalWorker) return; // owned by its worker.
+            std::unique_lock<std::mutex> lock(_contextMutex);
+            _externalContexts.emplace_back(&context);
+        }
+
+        bool ThreadPool::Impl::runPendingJob()
+        {
+            // a keyed job that helps must not run the next job of its lane, it would run out of order and nested.
+            const unsigned int worker = workerIndex();
+            const bool lanes = !executingKeyed();
+            detail::JobEntry entry;
+            if (!lanes || !popKeyed(entry, worker)) {
+                if (_queuedJobsCount == 0 || !_jobs->tryPop(entry, worker)) return false;
+                _queuedJobsCount--;
+                spaceAvailable(1);
+            }
+            WorkerCounters *counters = _counters && worker != detail::noWorker ? &_counters[worker] : nullptr;
+            auto idleSince = counters != nullptr ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+            execute(entry, counters, idleSince);
+            return true;
+        }
+
+        bool ThreadPool::Impl::help(const std::function<bool()> &done, const bool &timed, const std::chrono::nanoseconds &timeout)
+        {
+            const auto deadline = std::chrono::steady_clock::now() + timeout;
+            const unsigned int worker = workerIndex();
+            const bool lanes = !executingKeyed();
+            while (!done()) {
+                if (!_running) return done();
+                if (runPendingJob()) continue;
+                if (timed && std::chrono::steady_clock::now() >= deadline) return done();
+                // nothing to run, sleep until a job is queued or finishes.
+                std::unique_lock<std::mutex> lock(_stateMutex);
+                _parkedHelpers++; // must be visible before the condition is checked, see jobsAdded and jobsReduced.
+                if (worker < _laneCount) {
+                    _lanes[worker].parked = true;
+                }
+                const auto ready = [&]() { return _queuedJobsCount > 0 || (lanes && hasKeyed(worker)) || done() || !_running; };
+                if (timed) {
+                    _jobsCv.wait_until(lock, deadline, ready);
+                }
+                else {
+                    _jobsCv.wait(lock, ready);
+                }
+                _parkedHelpers--;
+                if (worker < _laneCount) {
+                    _lanes[worker].parked = false;
+                }
+            }
+            return true;
+        }
+
         unsigned int ThreadPool::Impl::threadCount() const
         {
             return _threadCount;
         }
 
+        unsigned int ThreadPool::Impl::maxThreadCount() const
+        {
+            return _maxThreads;
+        }
+
+        const std::shared_ptr<util::BlockPool> &ThreadPool::Impl::blockPool() const
+        {
+            return _blockPool;
+        }
+
         size_t ThreadPool::Impl::totalJobCount()
         {
-             std::unique_lock<std::mutex> lock( _stateMutex);
              return _totalJobsCount;
         }
 
         size_t ThreadPool::Impl::queueCount()
         {
-            std::unique_lock<std::mutex> jobsMutexLock( _stateMutex );
-            return _jobs.size();
+            size_t count = _queuedJobsCount;
+            for (unsigned int lane = 0; lane < _laneCount; lane++) {
+                count += _lanes[lane].backlog;
+            }
+            return count;
         }
 
-        ThreadPool::Impl::Impl(const unsigned int &threads, const std::function<void(std::thread&)> &threadCreateCallback)
+        ThreadPool::Impl::Impl(const ThreadPoolOptions &options)
+            : _blockPool(std::make_shared<util::BlockPool>())
         {
-            if (threads == 0) {
-                _threadCount = std::thread::hardware_concurrency();
+            _elastic = options.maxThreads != 0;
+            if (_elastic) {
+                _minThreads = options.minThreads;
+                _maxThreads = std::max(options.maxThreads, options.minThreads);
+                _idleTimeout = options.idleTimeout;
             }
             else {
-                _threadCount = threads;
+                _minThreads = options.threads == 0 ? std::thread::hardware_concurrency() : options.threads;
+                _minThreads = std::max(_minThreads, 1u);
+                _maxThreads = _minThreads;
+            }
+            _threadCreateCallback = options.threadCreateCallback;
+            _threadOptions = options.threadOptions;
+            _idleStrategy = options.idleStrategy;
+            _helpWhileWaiting = options.helpWhileWaiting;
+            _workerContextFactory = options.workerContextFactory;
+            _workerArenaSize = options.workerArenaSize;
+            _deadlineMissedCallback = options.deadlineMissedCallback;
+            _spinCount = std::max(options.spinCount, minimumSpinCount);
+            switch (options.scheduling) {
+            case Scheduling::WorkStealing:
+                _jobs = std::make_unique<detail::WorkStealingJobQueue>(_maxThreads);
+                break;
+            case Scheduling::Bounded:
+                _bounded = true;
+                _overflow = options.overflow;
+                _jobs = std::make_unique<detail::RingJobQueue>(options.queueCapacity);
+                break;
+            case Scheduling::Deadline:
+                _jobs = std::make_unique<detail::DeadlineJobQueue>();
+                break;
+            case Scheduling::Numa:
+                _numaJobs = new detail::NumaJobQueue(detail::readNumaTopology(), options.agingInterval);
+                _jobs.reset(_numaJobs);
+                break;
+            case Scheduling::SharedQueue:
+            default:
+                _jobs = std::make_unique<detail::SharedJobQueue>(options.agingInterval);
+                break;
             }
-            if (_threadCount == 0) {
-                _threadCount = 1;
+            if (options.metrics) {
+                _counters.reset(new WorkerCounters[_maxThreads]);
             }
-            for (unsigned int idx = 0; idx < _threadCount; idx++) {
-                std::thread thread = std::thread(&Impl::threadSpinner, this);
-                if (threadCreateCallback!=nullptr) {
-                    threadCreateCallback(thread);
+            // keyed jobs need workers that never stop, the first minThreads workers of an elastic pool.
+            _laneCount = _minThreads;
+            _affinitySkew = options.affinitySkew;
+            if (_laneCount > 0) {
+                _lanes.reset(new AffinityLane[_laneCount]);
+                size_t slots = 64;
+                while (slots < size_t(64) * _laneCount) slots *= 2;
+                _keySlots.reset(new std::atomic<std::uint64_t>[slots]);
+                for (size_t slot = 0; slot < slots; slot++) {
+                    _keySlots[slot] = 0;
                 }
-                _threads.push_back(std::move(thread));
+                _keySlotMask = slots - 1;
+            }
+            // the timer thread is numbered as the worker after the last one.
+            _timers = std::make_shared<detail::TimerQueue>([this](Job &&job) { push(detail::JobEntry(std::move(job))); }, _threadCreateCallback,
+                                                           _threadOptions, _maxThreads);
+            _threads.resize(_maxThreads);
+            for (unsigned int idx = _maxThreads; idx > 0; idx--) {
+                _freeWorkers.push_back(idx - 1); // the lowest indexes are reused first.
+            }
+            std::unique_lock<std::mutex> lock(_stateMutex);
+            for (unsigned int idx = 0; idx < _minThreads; idx++) {
+                startThread();
             }
         }
 
-        std::function<void()> ThreadPool::Impl::threadRetrieveCallback(const bool &reduceJobs)
+        void ThreadPool::Impl::startThread()
         {
-            std::function<void()> callback = nullptr;
-            {
-                std::unique_lock<std::mutex> jobsMutexLock( _stateMutex );
-                if (reduceJobs) {
-                    _totalJobsCount--;
-                    _totalReducedCountCv.notify_all();
+            const unsigned int index = _freeWorkers.back();
+            _freeWorkers.pop_back();
+            if (_threads[index].joinable()) {
+                _threads[index].join(); // the previous thread of this slot stopped after an idle timeout.
+            }
+            _threads[index] = detail::createThread(_threadOptions.stackSize, [this, index] { threadSpinner(index); });
+            if (_threadCreateCallback!=nullptr) {
+                _threadCreateCallback(_threads[index]);
+            }
+            _startingCount++;
+            _threadCount++;
+        }
+
+        void ThreadPool::Impl::grow()
+        {
+            if (!_running) return;
+            // threads are added until every queued job has a thread that is about to pick it up.
+            size_t available = _parkedCount + _spinningCount + _startingCount;
+            while (_queuedJobsCount > available && _threadCount < _maxThreads) {
+                startThread();
+                available++;
+            }
+        }
+
+        unsigned int ThreadPool::Impl::workerIndex() const
+        {
+            return currentPool == this ? currentWorker : detail::noWorker;
+        }
+
+        bool ThreadPool::Impl::park(const unsigned int workerIndex)
+        {
+            std::unique_lock<std::mutex> jobsMutexLock( _stateMutex );
+            _parkedCount++; // must be visible before the queued count is checked, see jobsAdded.
+            if (workerIndex < _laneCount) {
+                _lanes[workerIndex].parked = true; // must be visible before the lane is checked, see enqueue with a key.
+            }
+            const auto ready = [this, workerIndex]() { return _queuedJobsCount>0 || hasKeyed(workerIndex) || !_running; };
+            bool woken = true;
+            if (!_elastic || workerIndex < _minThreads) { // the first minThreads workers never stop.
+                _jobsCv.wait(jobsMutexLock, ready);
+            }
+            else {
+                woken = _jobsCv.wait_for(jobsMutexLock, _idleTimeout, ready);
+            }
+            _parkedCount--;
+            if (workerIndex < _laneCount) {
+                _lanes[workerIndex].parked = false;
+            }
+            if (woken || _threadCount <= _minThreads) return true;
+            _threadCount--; // idle for too long, the thread stops and its slot can be reused.
+            _freeWorkers.push_back(workerIndex);
+            return false;
+        }
+
+        void ThreadPool::Impl::jobsAdded(const size_t &count)
+        {
+            if (count == 0) return;
+            if (_parkedCount == 0 && _parkedHelpers == 0 && (!_elastic || _threadCount >= _maxThreads)) return; // the workers will find the jobs.
+            std::unique_lock<std::mutex> jobsMutexLock( _stateMutex );
+            // spinning workers pick up jobs themselves, wake up exactly one parked worker or helper for every remaining job.
+            const size_t spinning = _spinningCount;
+            const size_t wake = std::min<size_t>(count > spinning ? count - spinning : 0, _parkedCount + _parkedHelpers);
+            for (size_t idx = 0; idx < wake; idx++) {
+                _jobsCv.notify_one();
+            }
+            if (_elastic) {
+                grow();
+            }
+        }
+
+        bool ThreadPool::Impl::spin(detail::JobEntry &entry, const unsigned int workerIndex, unsigned int &spinLimit)
+        {
+            if (_idleStrategy == IdleStrategy::Park) return false;
+            const bool busy = _idleStrategy == IdleStrategy::BusySpin;
+            bool found = false;
+            _spinningCount++;
+            for (unsigned int iteration = 0; _running && (busy || iteration < spinLimit) && !hasKeyed(workerIndex); iteration++) {
+                if (_queuedJobsCount > 0 && _jobs->tryPop(entry, workerIndex)) { // the count avoids touching the queue while it is empty.
+                    found = true;
+                    break;
                 }
-                _jobsCv.wait(jobsMutexLock, [this]() { return !_jobs.empty() || !_running; });
-                if (!_running) return nullptr;
-                callback = std::move(_jobs.front());
-                _jobs.pop();
+                detail::cpuRelax();
             }
-            return callback;
+            _spinningCount--;
+            // spin longer while spinning pays off, shorter when the worker ends up parking anyway.
+            spinLimit = found ? std::min(spinLimit * 2, _spinCount) : std::max(spinLimit / 2, minimumSpinCount);
+            return found;
         }
 
-        void ThreadPool::Impl::threadSpinner()
+        void ThreadPool::Impl::jobsReduced(const size_t &count)
         {
-            bool reduceJobs = false;
+            if (count == 0) return;
+            const bool idle = _totalJobsCount.fetch_sub(count) - count <= _waitingJobs; // only waiters for an idle pool need to be notified.
+            const bool helpers = _parkedHelpers > 0; // helpers wait for a condition that a finished job might have met.
+            if (idle || helpers) {
+                std::unique_lock<std::mutex> lock( _stateMutex );
+                if (idle) _totalReducedCountCv.notify_all();
+                if (helpers) _jobsCv.notify_all();
+            }
+        }
+
+        void ThreadPool::Impl::threadSpinner(const unsigned int workerIndex)
+        {
+            currentPool = this;
+            currentWorker = workerIndex;
+            {
+                std::unique_lock<std::mutex> lock(_stateMutex);
+                _startingCount--;
+            }
+            if (_numaJobs != nullptr) {
+                _numaJobs->pinWorker(workerIndex);
+            }
+            detail::applyThreadOptions(_threadOptions, workerIndex); // after the NUMA pinning, a CPU set replaces it.
+            // created by the worker itself, so its memory is local to the node of the worker.
+            WorkerContext context(workerIndex, _workerArenaSize, _workerContextFactory ? _workerContextFactory(workerIndex) : nullptr);
+            currentContext = &context;
+            WorkerCounters *counters = _counters ? &_counters[workerIndex] : nullptr;
+            auto idleSince = counters != nullptr ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+            detail::JobEntry entry;
+            unsigned int spinLimit = _spinCount;
             while (_running) {
-                std::function<void()> callback(threadRetrieveCallback(reduceJobs));
-                reduceJobs = false;
-                if (_running && callback != nullptr) {
-                    callback();
-                    reduceJobs = true;
+                if (!popKeyed(entry, workerIndex)) {
+                    if (!_jobs->tryPop(entry, workerIndex) && !spin(entry, workerIndex, spinLimit)) {
+                        if (!park(workerIndex)) return;
+                        continue;
+                    }
+                    _queuedJobsCount--;
+                    spaceAvailable(1);
                 }
+                execute(entry, counters, idleSince);
             }
         }
 
-        void ThreadPool::Impl::lockedEnqueue(const std::vector<std::function<void()>> &jobs)
+        void ThreadPool::Impl::execute(detail::JobEntry &entry, WorkerCounters *counters, std::chrono::steady_clock::time_point &idleSince)
         {
-            std::unique_lock<std::mutex> jobsMutexLock( _stateMutex );
-            _totalJobsCount += jobs.size();
-            for (const auto &job : jobs) {
-                _jobs.push(job);
+            if (entry.isCancelled()) { // skipped without running, nor counting it in the metrics.
+                entry = detail::JobEntry();
+                jobsReduced(1);
+                return;
+            }
+            if (entry.isExpired()) { // too late to be of use, nor counted in the metrics as executed.
+                _deadlineMisses.fetch_add(1, std::memory_order_relaxed);
+                if (_deadlineMissedCallback && _running) {
+                    _deadlineMissedCallback(std::move(entry.job));
+                }
+                entry = detail::JobEntry();
+                jobsReduced(1);
+                return;
+            }
+            const void *previousPool = executingPool;
+            const size_t previousDepth = executingDepth;
+            const size_t previousWaitingDepth = waitingDepth;
+            const size_t previousKeyedDepth = keyedDepth;
+            if (executingPool != this) { // a job of another pool helps this pool.
+                executingPool = this;
+                executingDepth = 0;
+                waitingDepth = 0;
+                keyedDepth = 0;
+            }
+            executingDepth++;
+            if (entry.keySlot != detail::noKeySlot) {
+                keyedDepth++;
+            }
+            if (counters != nullptr) {
+                const auto started = std::chrono::steady_clock::now();
+                if (_running && entry.job != nullptr) {
+                    entry.job();
+                }
+                const auto finished = std::chrono::steady_clock::now();
+                counters->record(started - entry.enqueued, finished - started, started - idleSince);
+                idleSince = finished;
+            }
+            else if (_running && entry.job != nullptr) {
+                entry.job();
+            }
+            executingPool = previousPool;
+            executingDepth = previousDepth;
+            waitingDepth = previousWaitingDepth;
+            keyedDepth = previousKeyedDepth;
+            entry.job = nullptr;
+            if (entry.keySlot != detail::noKeySlot) {
+                _keySlots[entry.keySlot]--; // one job less pending for the key slot, it may move once none are left.
             }
+            jobsReduced(1);
         }
 
+        void ThreadPool::Impl::stamp(detail::JobEntry &entry) const
+        {
+            if (_counters) {
+                entry.enqueued = std::chrono::steady_clock::now();
+            }
+        }
 
-        void ThreadPool::Impl::lockedEnqueue(const std::function<void()> &job)
+        void ThreadPool::Impl::push(detail::JobEntry &&entry)
+        {
+            stamp(entry);
+            if (!_bounded) {
+                _totalJobsCount++;
+                _queuedJobsCount++;
+                _jobs->push(std::move(entry), workerIndex());
+                jobsAdded(1);
+                return;
+            }
+            if (tryPush(entry)) return;
+            // a worker that waits for space might wait for itself, so it always runs the job.
+            const unsigned int worker = workerIndex();
+            if (_overflow == Overflow::CallerRuns || worker != detail::noWorker) {
+                _totalJobsCount++; // counted until it ran, so wait() does not return while it runs.
+                WorkerCounters *counters = _counters && worker != detail::noWorker ? &_counters[worker] : nullptr;
+                auto idleSince = counters != nullptr ? std::chrono::steady_clock::now() : std::chrono::steady_clock::time_point();
+                execute(entry, counters, idleSince);
+                return;
+            }
+            pushWhenSpace(entry, false, std::chrono::nanoseconds(0));
+        }
+
+        bool ThreadPool::Impl::tryPush(detail::JobEntry &entry)
         {
-            std::unique_lock<std::mutex> jobsMutexLock( _stateMutex );
             _totalJobsCount++;
-            _jobs.push(job);
+            _queuedJobsCount++;
+            if (_jobs->tryPush(entry, workerIndex())) {
+                jobsAdded(1);
+                return true;
+            }
+            _queuedJobsCount--;
+            jobsReduced(1);
+            return false;
         }
 
-        void ThreadPool::Impl::lockedEnqueue(std::vector<std::function<void()>> &&jobs)
+        bool ThreadPool::Impl::pushWhenSpace(detail::JobEntry &entry, const bool &timed, const std::chrono::nanoseconds &timeout)
         {
-            std::unique_lock<std::mutex> jobsMutexLock( _stateMutex );
-            _totalJobsCount += jobs.size();
-            for (const auto &job : jobs) {
-                _jobs.push(std::move(job));
+            if (tryPush(entry)) return true;
+            bool pushed = false;
+            const auto ready = [&]() { pushed = tryPush(entry); return pushed || !_running; };
+            std::unique_lock<std::mutex> lock(_spaceMutex);
+            _blockedProducers++; // must be visible before the queue is checked again, see spaceAvailable.
+            if (timed) {
+                _spaceCv.wait_for(lock, timeout, ready);
+            }
+            else {
+                _spaceCv.wait(lock, ready);
             }
+            _blockedProducers--;
+            return pushed;
         }
 
-        void ThreadPool::Impl::lockedEnqueue(std::queue<std::function<void()>> &&jobs)
+        void ThreadPool::Impl::spaceAvailable(const size_t &count)
         {
-            std::unique_lock<std::mutex> jobsMutexLock( _stateMutex );
-            _totalJobsCount += jobs.size();
-            while (!jobs.empty()) {
-                _jobs.push(std::move(jobs.front()));
-                jobs.pop();
+            if (!_bounded || count == 0) return;
+            // a read-modify-write instead of a load, a producer that registers concurrently is then guaranteed to see the pop.
+            if (_blockedProducers.fetch_add(0) == 0) return;
+            std::unique_lock<std::mutex> lock(_spaceMutex);
+            if (count == 1) {
+                _spaceCv.notify_one();
+            }
+            else {
+                _spaceCv.notify_all();
             }
         }
 
-        void ThreadPool::Impl::lockedEnqueue(std::function<void()> &&job)
+        bool ThreadPool::Impl::executingKeyed() const
         {
-            std::unique_lock<std::mutex> jobsMutexLock( _stateMutex );
+            return executingPool == this && keyedDepth > 0;
+        }
+
+        bool ThreadPool::Impl::hasKeyed(const unsigned int workerIndex) const
+        {
+            return workerIndex < _laneCount && _lanes[workerIndex].backlog > 0;
+        }
+
+        bool ThreadPool::Impl::popKeyed(detail::JobEntry &entry, const unsigned int workerIndex)
+        {
+            if (!hasKeyed(workerIndex)) return false;
+            AffinityLane &lane = _lanes[workerIndex];
+            std::unique_lock<std::mutex> lock(lane.mutex);
+            if (lane.jobs.empty()) return false;
+            entry = std::move(lane.jobs.front());
+            lane.jobs.pop_front();
+            lane.backlog--;
+            return true;
+        }
+
+        unsigned int ThreadPool::Impl::balancedLane(const unsigned int &home) const
+        {
+            const size_t homeBacklog = _lanes[home].backlog;
+            if (homeBacklog <= _affinitySkew) return home;
+            unsigned int least = home;
+            size_t leastBacklog = homeBacklog;
+            for (unsigned int lane = 0; lane < _laneCount; lane++) {
+                const size_t backlog = _lanes[lane].backlog;
+                if (backlog < leastBacklog) {
+                    least = lane;
+                    leastBacklog = backlog;
+                }
+            }
+            return homeBacklog - leastBacklog > _affinitySkew ? least : home;
+        }
+
+        unsigned int ThreadPool::Impl::route(const size_t &slot)
+        {
+            std::atomic<std::uint64_t> &state = _keySlots[slot];
+            std::uint64_t current = state.load();
+            for (;;) {
+                unsigned int lane = static_cast<unsigned int>(current >> 32);
+                const std::uint64_t pending = current & 0xffffffffULL;
+                if (pending == 0) { // no job of the slot is queued or running, it may go anywhere without reordering.
+                    lane = balancedLane(static_cast<unsigned int>(slot % _laneCount));
+                }
+                const std::uint64_t next = (std::uint64_t(lane) << 32) | (pending + 1);
+                if (state.compare_exchange_weak(current, next)) return lane;
+            }
+        }
+
+        std::vector<detail::JobEntry> ThreadPool::Impl::popAllKeyed()
+        {
+            std::vector<detail::JobEntry> result;
+            for (unsigned int idx = 0; idx < _laneCount; idx++) {
+                AffinityLane &lane = _lanes[idx];
+                std::unique_lock<std::mutex> lock(lane.mutex);
+                for (auto &entry : lane.jobs) {
+                    _keySlots[entry.keySlot]--;
+                    result.push_back(std::move(entry));
+                }
+                lane.backlog -= lane.jobs.size();
+                lane.jobs.clear();
+            }
+            return result;
+        }
+
+        void ThreadPool::Impl::enqueue(const AffinityKey &key, Job &&job)
+        {
+            if (_laneCount == 0) {
+                push(detail::JobEntry(std::move(job)));
+                return;
+            }
+            detail::JobEntry entry(std::move(job));
+            entry.keySlot = static_cast<size_t>(mixKey(key.value)) & _keySlotMask;
+            stamp(entry);
+            const unsigned int index = route(entry.keySlot);
+            AffinityLane &lane = _lanes[index];
             _totalJobsCount++;
-            _jobs.push(std::move(job));
+            {
+                std::unique_lock<std::mutex> lock(lane.mutex);
+                lane.jobs.push_back(std::move(entry));
+                lane.backlog++;
+            }
+            if (lane.parked) { // the jobs condition variable is shared, so the parked worker can only be woken with the others.
+                std::unique_lock<std::mutex> jobsMutexLock(_stateMutex);
+                _jobsCv.notify_all();
+            }
         }
 
-        void ThreadPool::Impl::enqueue(const std::function<void()> &job)
+        void ThreadPool::Impl::push(std::vector<detail::JobEntry> &&entries)
         {
-            lockedEnqueue(job);
-            _jobsCv.notify_one(); // since one job is added, wake up one extra threads.
+            if (_bounded) { // every job is subject to the overflow policy.
+                for (auto &entry : entries) {
+                    push(std::move(entry));
+                }
+                return;
+            }
+            if (_counters && !entries.empty()) {
+                const auto now = std::chrono::steady_clock::now();
+                for (auto &entry : entries) {
+                    entry.enqueued = now;
+                }
+            }
+            const size_t count = entries.size();
+            _totalJobsCount += count;
+            _queuedJobsCount += count; // counted before pushing, so the queued count never underflows.
+            _jobs->push(std::move(entries), workerIndex());
+            jobsAdded(count);
         }
 
-        void ThreadPool::Impl::enqueue(const std::vector<std::function<void()>> &jobs)
+        template<class Jobs>
+        void ThreadPool::Impl::pushConverted(Jobs &&jobs, const Priority &priority, const TenantId &tenant)
         {
-            lockedEnqueue(jobs);
-            _jobsCv.notify_all(); // multiple jobs are added, wake up all threads.
+            std::vector<detail::JobEntry> vector;
+            vector.reserve(jobs.size());
+            for (auto &job : jobs) {
+                vector.emplace_back(Job(forwardElement<Jobs>(job)), priority, tenant);
+            }
+            push(std::move(vector));
         }
 
-        void ThreadPool::Impl::enqueue(std::function<void()> &&job)
+        template<class T>
+        void ThreadPool::Impl::pushConverted(std::queue<T> &&jobs)
+        {
+            std::vector<detail::JobEntry> vector;
+            vector.reserve(jobs.size());
+            while (!jobs.empty()) {
+                vector.emplace_back(Job(std::move(jobs.front())));
+                jobs.pop();
+            }
+            push(std::move(vector));
+        }
+
+        void ThreadPool::Impl::enqueue(const Priority &priority, const TenantId &tenant, Job &&job)
+        {
+            push(detail::JobEntry(std::move(job), priority, tenant));
+        }
+
+        void ThreadPool::Impl::enqueue(const Priority &priority, const TenantId &tenant, std::vector<Job> &&jobs)
+        {
+            pushConverted(std::move(jobs), priority, tenant);
+        }
+
+        void ThreadPool::Impl::enqueue(const std::vector<std::function<void()>> &jobs)
         {
-            lockedEnqueue(std::move(job));
-            _jobsCv.notify_one(); // since one job is added, wake up one extra threads.
+            pushConverted(jobs);
         }
 
         void ThreadPool::Impl::enqueue(std::vector<std::function<void()>> &&jobs)
         {
-            lockedEnqueue(std::move(jobs));
-            _jobsCv.notify_all(); // multiple jobs are added, wake up all threads.
+            pushConverted(std::move(jobs));
         }
 
         void ThreadPool::Impl::enqueue(std::queue<std::function<void()>> &&jobs)
         {
-            lockedEnqueue(std::move(jobs));
-            _jobsCv.notify_all(); // multiple jobs are added, wake up all threads.
+            pushConverted(std::move(jobs));
+        }
+
+        void ThreadPool::Impl::enqueue(std::queue<Job> &&jobs)
+        {
+            pushConverted(std::move(jobs));
+        }
+
+        void ThreadPool::Impl::setTenantWeight(const TenantId &tenant, const unsigned int &weight)
+        {
+            _jobs->setTenantWeight(tenant, weight);
+        }
+
+        void ThreadPool::Impl::enqueue(const util::CancellationToken &token, Job &&job)
+        {
+            detail::JobEntry entry(std::move(job));
+            entry.cancellable = true;
+            entry.token = token;
+            push(std::move(entry));
+        }
+
+        void ThreadPool::Impl::enqueue(const util::CancellationToken &token, std::vector<Job> &&jobs)
+        {
+            std::vector<detail::JobEntry> vector;
+            vector.reserve(jobs.size());
+            for (auto &job : jobs) {
+                vector.emplace_back(std::move(job));
+                vector.back().cancellable = true;
+                vector.back().token = token;
+            }
+            push(std::move(vector));
+        }
+
+        size_t ThreadPool::Impl::purgeCancelled()
+        {
+            const size_t count = _jobs->removeCancelled();
+            _queuedJobsCount -= count;
+            jobsReduced(count);
+            spaceAvailable(count);
+            return count;
+        }
+
+        void ThreadPool::Impl::enqueue(const std::chrono::steady_clock::time_point &deadline, Job &&job)
+        {
+            detail::JobEntry entry(std::move(job));
+            entry.deadline = deadline;
+            push(std::move(entry));
+        }
+
+        ScheduledJob ThreadPool::Impl::schedule(const std::chrono::steady_clock::time_point &due, const std::chrono::nanoseconds &interval, Job &&job)
+        {
+            return _timers->schedule(due, interval, std::move(job));
+        }
+
+        size_t ThreadPool::Impl::scheduledCount()
+        {
+            return _timers->size();
+        }
+
+        void ThreadPool::Impl::enqueueOnNode(const unsigned int &node, Job &&job)
+        {
+            detail::JobEntry entry(std::move(job));
+            entry.node = node;
+            push(std::move(entry));
+        }
+
+        void ThreadPool::Impl::enqueueOnNode(const unsigned int &node, std::vector<Job> &&jobs)
+        {
+            std::vector<detail::JobEntry> vector;
+            vector.reserve(jobs.size());
+            for (auto &job : jobs) {
+                vector.emplace_back(std::move(job));
+                vector.back().node = node;
+            }
+            push(std::move(vector));
+        }
+
+        bool ThreadPool::Impl::tryEnqueue(Job &job, const bool &timed, const std::chrono::nanoseconds &timeout)
+        {
+            detail::JobEntry entry(std::move(job));
+            stamp(entry);
+            if (timed ? pushWhenSpace(entry, true, timeout) : tryPush(entry)) return true;
+            job = std::move(entry.job); // the caller keeps its job.
+            return false;
+        }
+
+        ThreadPoolMetrics ThreadPool::Impl::metrics()
+        {
+            ThreadPoolMetrics result;
+            if (_counters) {
+                result.workers.reserve(_maxThreads);
+                for (unsigned int idx = 0; idx < _maxThreads; idx++) {
+                    result.workers.push_back(_counters[idx].read());
+                }
+            }
+            result.queued = queueCount();
+            result.total = _totalJobsCount;
+            result.threads = _threadCount;
+            result.deadlineMisses = _deadlineMisses.load(std::memory_order_relaxed);
+            return result;
+        }
+
+        unsigned int ThreadPool::Impl::nodeCount() const
+        {
+            return _numaJobs != nullptr ? _numaJobs->nodeCount() : 1;
         }
 
         ThreadPool::Impl::~Impl()
         {
+            _timers->stop(); // first, the timer thread enqueues jobs.
             _running = false;
             { // scope to release the lock.
                 std::unique_lock<std::mutex> jobsMutexLock( _stateMutex); // acquire lock, otherwise not all threads are waiting...
                 _jobsCv.notify_all();
+                _totalReducedCountCv.notify_all();
+            }
+            { // producers that wait for space give up.
+                std::unique_lock<std::mutex> spaceLock(_spaceMutex);
+                _spaceCv.notify_all();
             }
 
             for (std::thread &thread : _threads) {
-                thread.join();
+                if (thread.joinable()) {
+                    thread.join();
+                }
+            }
+        }
+
+        namespace {
+            // The options of the constructors that predate ThreadPoolOptions.
+            ThreadPoolOptions legacyOptions(const unsigned int &threads, const std::function<void(std::thread&)> &threadCreateCallback)
+            {
+                ThreadPoolOptions options;
+                options.threads = threads;
+                options.threadCreateCallback = threadCreateCallback;
+                return options;
             }
         }
 
         ThreadPool::ThreadPool()
-            : _impl(std::make_unique<Impl>(0,nullptr))
+            : _impl(std::make_unique<Impl>(ThreadPoolOptions()))
         {
         }
 
         ThreadPool::ThreadPool(const std::function<void (std::thread &)> &threadCreateCallback)
-        : _impl(std::make_unique<Impl>(0,threadCreateCallback))
+            : _impl(std::make_unique<Impl>(legacyOptions(0, threadCreateCallback)))
         {
         }
 
         ThreadPool::ThreadPool(const unsigned int &threads)
-            : _impl(std::make_unique<Impl>(threads,nullptr))
+            : _impl(std::make_unique<Impl>(legacyOptions(threads, nullptr)))
         {
         }
 
         ThreadPool::ThreadPool(const unsigned int &threads, const std::function<void(std::thread&)> &threadCreateCallback)
-            : _impl(std::make_unique<Impl>(threads,threadCreateCallback))
+            : _impl(std::make_unique<Impl>(legacyOptions(threads, threadCreateCallback)))
+        {
+        }
+
+        ThreadPool::ThreadPool(const ThreadPoolOptions &options)
+            : _impl(std::make_unique<Impl>(options))
+        {
+        }
+
+        void ThreadPool::enqueue(Job &&job)
+        {
+            _impl->enqueue(Priority::Normal, 0, std::move(job));
+        }
+
+        void ThreadPool::enqueue(const Priority &priority, Job &&job)
+        {
+            _impl->enqueue(priority, 0, std::move(job));
+        }
+
+        void ThreadPool::enqueue(const Priority &priority, const TenantId &tenant, Job &&job)
+        {
+            _impl->enqueue(priority, tenant, std::move(job));
+        }
+
+        void ThreadPool::enqueue(const Priority &priority, std::vector<Job> &&jobs)
+        {
+            _impl->enqueue(priority, 0, std::move(jobs));
+        }
+
+        void ThreadPool::enqueue(const Priority &priority, const TenantId &tenant, std::vector<Job> &&jobs)
+        {
+            _impl->enqueue(priority, tenant, std::move(jobs));
+        }
+
+        void ThreadPool::setTenantWeight(const TenantId &tenant, const unsigned int &weight)
+        {
+            _impl->setTenantWeight(tenant, weight);
+        }
+
+        void ThreadPool::enqueue(const util::CancellationToken &token, Job &&job)
+        {
+            _impl->enqueue(token, std::move(job));
+        }
+
+        void ThreadPool::enqueue(const util::CancellationToken &token, std::vector<Job> &&jobs)
+        {
+            _impl->enqueue(token, std::move(jobs));
+        }
+
+        size_t ThreadPool::purgeCancelled()
+        {
+            return _impl->purgeCancelled();
+        }
+
+        void ThreadPool::enqueueOnNode(const unsigned int &node, Job &&job)
+        {
+            _impl->enqueueOnNode(node, std::move(job));
+        }
+
+        void ThreadPool::enqueueOnNode(const unsigned int &node, std::vector<Job> &&jobs)
+        {
+            _impl->enqueueOnNode(node, std::move(jobs));
+        }
+
+        void ThreadPool::enqueue(const AffinityKey &key, Job &&job)
+        {
+            _impl->enqueue(key, std::move(job));
+        }
+
+        void ThreadPool::enqueue(const std::chrono::steady_clock::time_point &deadline, Job &&job)
+        {
+            _impl->enqueue(deadline, std::move(job));
+        }
+
+        ScheduledJob ThreadPool::enqueueAfter(const std::chrono::nanoseconds &delay, Job &&job)
+        {
+            return _impl->schedule(std::chrono::steady_clock::now() + delay, std::chrono::nanoseconds(0), std::move(job));
+        }
+
+        ScheduledJob ThreadPool::enqueueAt(const std::chrono::steady_clock::time_point &timePoint, Job &&job)
+        {
+            return _impl->schedule(timePoint, std::chrono::nanoseconds(0), std::move(job));
+        }
+
+        ScheduledJob ThreadPool::enqueueEvery(const std::chrono::nanoseconds &interval, Job &&job)
         {
+            const auto period = std::max(interval, std::chrono::nanoseconds(1));
+            return _impl->schedule(std::chrono::steady_clock::now() + period, period, std::move(job));
         }
 
-        void ThreadPool::enqueue(const std::function<void()> &job)
+        size_t ThreadPool::scheduledCount()
         {
-            _impl->enqueue(job);
+            return _impl->scheduledCount();
+        }
+
+        bool ThreadPool::tryEnqueue(Job &&job)
+        {
+            return _impl->tryEnqueue(job, false, std::chrono::nanoseconds(0));
+        }
+
+        bool ThreadPool::tryEnqueueFor(Job &&job, const std::chrono::nanoseconds &timeout)
+        {
+            return _impl->tryEnqueue(job, true, timeout);
+        }
+
+        ThreadPoolMetrics ThreadPool::metrics() const
+        {
+            return _impl->metrics();
+        }
+
+        unsigned int ThreadPool::nodeCount() const
+        {
+            return _impl->nodeCount();
         }
 
         void ThreadPool::enqueue(const std::vector<std::function<void()>> &jobs)
@@ -298,9 +1220,14 @@ namespace ccol
             _impl->enqueue(std::move(jobs));
         }
 
-        void ThreadPool::enqueue(std::function<void()> &&job)
+        void ThreadPool::enqueue(std::vector<Job> &&jobs)
+        {
+            _impl->enqueue(Priority::Normal, 0, std::move(jobs));
+        }
+
+        void ThreadPool::enqueue(std::queue<Job> &&jobs)
         {
-            _impl->enqueue(std::move(job));
+            _impl->enqueue(std::move(jobs));
         }
 
         void ThreadPool::enqueue(std::vector<std::function<void()>> &&jobs)
@@ -328,12 +1255,17 @@ namespace ccol
             return _impl->threadCount();
         }
 
+        unsigned int ThreadPool::maxThreadCount() const
+        {
+            return _impl->maxThreadCount();
+        }
+
         void ThreadPool::clear()
         {
             return _impl->clear();
         }
 
-        std::queue<std::function<void()>> ThreadPool::dequeueAll()
+        std::queue<Job> ThreadPool::dequeueAll()
         {
             return _impl->dequeueAll();
         }
@@ -348,6 +1280,36 @@ namespace ccol
              return _impl->wait_for(timeout);
         }
 
+        WorkerContext &ThreadPool::acquireContext()
+        {
+            return _impl->acquireContext();
+        }
+
+        void ThreadPool::releaseContext(WorkerContext &context)
+        {
+            _impl->releaseContext(context);
+        }
+
+        bool ThreadPool::helpsWhileWaiting() const
+        {
+            return _impl->helpsWhileWaiting();
+        }
+
+        bool ThreadPool::runPendingJob()
+        {
+            return _impl->runPendingJob();
+        }
+
+        void ThreadPool::helpUntil(const std::function<bool()> &done)
+        {
+            _impl->help(done, false, std::chrono::nanoseconds(0));
+        }
+
+        bool ThreadPool::helpUntilFor(const std::function<bool()> &done, const std::chrono::nanoseconds &timeout)
+        {
+            return _impl->help(done, true, timeout);
+        }
+
         std::function<void ()> ThreadPool::wrap(const std::function<void ()> &job)
         {
             return [this, job]{
@@ -355,6 +1317,11 @@ namespace ccol
             };
         }
 
+        const std::shared_ptr<util::BlockPool> &ThreadPool::blockPool() const
+        {
+            return _impl->blockPool();
+        }
+
         ThreadPool::~ThreadPool()
         {
         }
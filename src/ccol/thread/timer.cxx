@@ -59,11 +59,11 @@ namespace ccol
             std::thread _thread;
             unsigned int _reliablity = 1;
             bool _running = false;
-            bool _threadRunning = true;
+            std::atomic_bool _threadRunning{true}; // read by the thread without the lock.
             bool _changedState = false;
             void threadSpinner();
         public:
-            Impl(const std::function<void (std::thread &)> &threadCreateCallback = nullptr);
+            Impl(const std::function<void (std::thread &)> &threadCreateCallback = nullptr, const ThreadOptions &threadOptions = ThreadOptions());
             void start(const std::chrono::nanoseconds& delay, const std::chrono::nanoseconds& interval);
             void setReliability(const unsigned int &reliability);
             void setCallback(const std::function<void()> &callback);
@@ -73,9 +73,9 @@ namespace ccol
             ~Impl();
         };
 
-        Timer::Impl::Impl(const std::function<void (std::thread &)> &threadCreateCallback)
+        Timer::Impl::Impl(const std::function<void (std::thread &)> &threadCreateCallback, const ThreadOptions &threadOptions)
         {
-            _thread = std::thread(&Timer::Impl::threadSpinner, this);
+            _thread = createThread(threadOptions, [this] { threadSpinner(); });
             if (threadCreateCallback!=nullptr) {
                 threadCreateCallback(_thread);
             }
@@ -202,6 +202,11 @@ namespace ccol
 
         }
 
+        Timer::Timer(const ThreadOptions &threadOptions)
+            : _impl(std::make_unique<Impl>(nullptr, threadOptions))
+        {
+        }
+
         Timer::Timer(const std::function<void()> &callback)
             : _impl(std::make_unique<Impl>())
         {
@@ -0,0 +1,278 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include "timerqueue.hxx"
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            namespace {
+                // One queued occurrence of a periodic job, which allows the next occurrence once it ran or was dropped.
+                class Occurrence
+                {
+                private:
+                    std::shared_ptr<ScheduledJobState> _state;
+                public:
+                    explicit Occurrence(std::shared_ptr<ScheduledJobState> state) noexcept : _state(std::move(state)) {}
+                    Occurrence(Occurrence &&other) noexcept = default;
+                    Occurrence &operator=(Occurrence &&other) = delete;
+                    void operator()()
+                    {
+                        if (!_state->finished) {
+                            _state->job();
+                        }
+                    }
+                    ~Occurrence()
+                    {
+                        if (_state) {
+                            _state->queued = false;
+                        }
+                    }
+                };
+            }
+
+            TimerQueue::TimerQueue(std::function<void(Job&&)> enqueue, std::function<void(std::thread&)> threadCreateCallback,
+                                   const ThreadOptions &threadOptions, const unsigned int &threadIndex)
+                : _enqueue(std::move(enqueue)), _threadCreateCallback(std::move(threadCreateCallback)),
+                  _threadOptions(threadOptions), _threadIndex(threadIndex)
+            {
+            }
+
+            bool TimerQueue::before(const size_t &left, const size_t &right) const
+            {
+                const HeapItem &a = _heap[left];
+                const HeapItem &b = _heap[right];
+                return a.due != b.due ? a.due < b.due : a.sequence < b.sequence;
+            }
+
+            void TimerQueue::place(const size_t &index)
+            {
+                _heap[index].state->position = index;
+            }
+
+            void TimerQueue::siftUp(size_t index)
+            {
+                while (index > 0) {
+                    const size_t parent = (index - 1) / 2;
+                    if (!before(index, parent)) break;
+                    std::swap(_heap[index], _heap[parent]);
+                    place(index);
+                    index = parent;
+                }
+                place(index);
+            }
+
+            void TimerQueue::siftDown(size_t index)
+            {
+                for (;;) {
+                    const size_t left = 2 * index + 1;
+                    if (left >= _heap.size()) break;
+                    const size_t child = left + 1 < _heap.size() && before(left + 1, left) ? left + 1 : left;
+                    if (!before(child, index)) break;
+                    std::swap(_heap[index], _heap[child]);
+                    place(index);
+                    index = child;
+                }
+                place(index);
+            }
+
+            void TimerQueue::insert(HeapItem &&item)
+            {
+                _heap.push_back(std::move(item));
+                siftUp(_heap.size() - 1);
+            }
+
+            TimerQueue::HeapItem TimerQueue::removeAt(const size_t index)
+            {
+                HeapItem item = std::move(_heap[index]);
+                item.state->position = notScheduled;
+                if (index + 1 < _heap.size()) {
+                    _heap[index] = std::move(_heap.back());
+                    _heap.pop_back();
+                    if (index > 0 && before(index, (index - 1) / 2)) {
+                        siftUp(index);
+                    }
+                    else {
+                        siftDown(index);
+                    }
+                }
+                else {
+                    _heap.pop_back();
+                }
+                return item;
+            }
+
+            void TimerQueue::fire(HeapItem &&item, const std::chrono::steady_clock::time_point &now, std::vector<Job> &ready)
+            {
+                ScheduledJobState &state = *item.state;
+                if (state.interval == std::chrono::nanoseconds(0)) {
+                    if (!state.finished.exchange(true)) { // a concurrent cancel might have won.
+                        ready.push_back(std::move(state.job));
+                    }
+                    return;
+                }
+                if (state.finished) return; // cancelled periodic job, its handles keep the state alive.
+                if (!state.queued.exchange(true)) {
+                    ready.push_back(Job(Occurrence(item.state)));
+                }
+                // a fixed rate, occurrences that were missed because the timer thread was late are skipped.
+                item.due += state.interval;
+                if (item.due <= now) {
+                    item.due += ((now - item.due) / state.interval + 1) * state.interval;
+                }
+                item.sequence = _sequence++;
+                insert(std::move(item));
+            }
+
+            void TimerQueue::threadSpinner()
+            {
+                std::vector<Job> ready;
+                std::unique_lock<std::mutex> lock(_mutex);
+                while (_running) {
+                    if (_heap.empty()) {
+                        _changed.wait(lock);
+                        continue;
+                    }
+                    const auto now = std::chrono::steady_clock::now();
+                    const auto due = _heap.front().due;
+                    if (due > now) {
+                        _changed.wait_until(lock, due);
+                        continue;
+                    }
+                    while (!_heap.empty() && _heap.front().due <= now) {
+                        fire(removeAt(0), now, ready);
+                    }
+                    // the pool is used without the lock, a job might cancel a scheduled job, or a bounded pool might block.
+                    lock.unlock();
+                    for (auto &job : ready) {
+                        _enqueue(std::move(job));
+                    }
+                    ready.clear();
+                    lock.lock();
+                }
+            }
+
+            ScheduledJob TimerQueue::schedule(const std::chrono::steady_clock::time_point &due, const std::chrono::nanoseconds &interval, Job &&job)
+            {
+                auto state = std::make_shared<ScheduledJobState>(std::move(job), interval, shared_from_this());
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (!_running) return ScheduledJob(std::move(state));
+                insert(HeapItem{due, _sequence++, state});
+                if (!_thread.joinable()) {
+                    _thread = createThread(_threadOptions.stackSize, [this] {
+                        applyThreadOptions(_threadOptions, _threadIndex);
+                        threadSpinner();
+                    });
+                    if (_threadCreateCallback != nullptr) {
+                        _threadCreateCallback(_thread);
+                    }
+                }
+                else if (state->position == 0) { // due before the job the thread sleeps for.
+                    _changed.notify_one();
+                }
+                return ScheduledJob(std::move(state));
+            }
+
+            void TimerQueue::remove(ScheduledJobState &state)
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                if (state.position != notScheduled) {
+                    removeAt(state.position); // the thread wakes up for nothing when this was the first job, no need to notify.
+                }
+            }
+
+            size_t TimerQueue::size()
+            {
+                std::unique_lock<std::mutex> lock(_mutex);
+                return _heap.size();
+            }
+
+            void TimerQueue::stop()
+            {
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    _running = false;
+                    _changed.notify_all();
+                }
+                if (_thread.joinable()) {
+                    _thread.join();
+                }
+                std::vector<HeapItem> heap;
+                {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    heap.swap(_heap);
+                    for (auto &item : heap) {
+                        item.state->position = notScheduled;
+                    }
+                }
+                for (auto &item : heap) { // the jobs are destroyed without the lock, their captures might cancel other jobs.
+                    if (!item.state->finished.exchange(true) && item.state->interval == std::chrono::nanoseconds(0)) {
+                        item.state->job = nullptr; // never enqueued, so nobody else uses it.
+                    }
+                }
+            }
+
+            TimerQueue::~TimerQueue()
+            {
+                stop();
+            }
+        }
+
+        ScheduledJob::ScheduledJob(std::shared_ptr<detail::ScheduledJobState> state)
+            : _state(std::move(state))
+        {
+        }
+
+        bool ScheduledJob::cancel()
+        {
+            if (!_state || _state->finished.exchange(true)) return false;
+            if (auto timers = _state->timers.lock()) {
+                timers->remove(*_state);
+            }
+            if (_state->interval == std::chrono::nanoseconds(0)) {
+                _state->job = nullptr; // release the captures now, a single shot job that was not enqueued is not used anymore.
+            }
+            return true;
+        }
+
+        bool ScheduledJob::isPending() const
+        {
+            return _state && !_state->finished;
+        }
+    }
+}
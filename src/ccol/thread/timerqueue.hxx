@@ -0,0 +1,142 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_TIMERQUEUE_HXX
+#define CCOL_THREAD_TIMERQUEUE_HXX
+
+#include <ccol/thread/job.hxx>
+#include <ccol/thread/scheduledjob.hxx>
+#include <ccol/thread/threadoptions.hxx>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            class TimerQueue;
+
+            /** \brief Heap position of a scheduled job that is not in the heap. */
+            constexpr size_t notScheduled = std::numeric_limits<size_t>::max();
+
+            /** \brief A job waiting in a TimerQueue, shared by the queue, its handles and its queued occurrences. */
+            class ScheduledJobState
+            {
+            public:
+                Job job;
+                std::chrono::nanoseconds interval; // 0 for a single shot job.
+                std::atomic_bool finished{false}; // set once by cancel, or when a single shot job is enqueued.
+                std::atomic_bool queued{false}; // an occurrence of a periodic job is queued or running.
+                std::weak_ptr<TimerQueue> timers;
+                size_t position = notScheduled; // the index in the heap, guarded by the mutex of the queue.
+
+                ScheduledJobState(Job &&job, const std::chrono::nanoseconds &interval, std::weak_ptr<TimerQueue> timers)
+                    : job(std::move(job)), interval(interval), timers(std::move(timers)) {}
+            };
+
+            /** \brief Holds the delayed and periodic jobs of a ThreadPool and enqueues them when they are due.
+             *
+             *  All scheduled jobs of a pool share one binary heap ordered by due time, and one thread
+             *  that sleeps until the earliest job is due. The thread is only started when the first
+             *  job is scheduled. Every job knows its position in the heap, so a cancelled job is
+             *  removed and released at once instead of when it would have been due.
+             *
+             *  A periodic job is enqueued at a fixed rate. An occurrence is skipped while the
+             *  previous one is still queued or running, so a slow job does not pile up in the pool.
+             */
+            class TimerQueue : public std::enable_shared_from_this<TimerQueue>
+            {
+            private:
+                struct HeapItem
+                {
+                    std::chrono::steady_clock::time_point due;
+                    std::uint64_t sequence;
+                    std::shared_ptr<ScheduledJobState> state;
+                };
+                std::mutex _mutex;
+                std::condition_variable _changed;
+                std::vector<HeapItem> _heap;
+                std::uint64_t _sequence = 0;
+                std::thread _thread;
+                bool _running = true;
+                std::function<void(Job&&)> _enqueue;
+                std::function<void(std::thread&)> _threadCreateCallback;
+                ThreadOptions _threadOptions;
+                unsigned int _threadIndex;
+                void threadSpinner();
+                inline bool before(const size_t &left, const size_t &right) const;
+                inline void place(const size_t &index);
+                inline void siftUp(size_t index);
+                inline void siftDown(size_t index);
+                inline void insert(HeapItem &&item);
+                inline HeapItem removeAt(const size_t index);
+                inline void fire(HeapItem &&item, const std::chrono::steady_clock::time_point &now, std::vector<Job> &ready);
+            public:
+                /** \brief Creates the queue, enqueue is called on the timer thread with every due job.
+                 *
+                 *  The timer thread applies threadOptions as thread number threadIndex.
+                 */
+                TimerQueue(std::function<void(Job&&)> enqueue, std::function<void(std::thread&)> threadCreateCallback,
+                           const ThreadOptions &threadOptions = ThreadOptions(), const unsigned int &threadIndex = unnumbered);
+
+                /** \brief Schedules a job, an interval of 0 makes it a single shot job. */
+                ScheduledJob schedule(const std::chrono::steady_clock::time_point &due, const std::chrono::nanoseconds &interval, Job &&job);
+
+                /** \brief Removes a scheduled job from the heap, if it is still in there. */
+                void remove(ScheduledJobState &state);
+
+                /** \brief Returns the amount of scheduled jobs that are not yet due. */
+                size_t size();
+
+                /** \brief Stops and joins the timer thread, the jobs that are not yet due are destroyed. */
+                void stop();
+
+                ~TimerQueue();
+            };
+        }
+    }
+}
+
+#endif // CCOL_THREAD_TIMERQUEUE_HXX
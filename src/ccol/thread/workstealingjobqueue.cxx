@@ -0,0 +1,144 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include "workstealingjobqueue.hxx"
+#include <algorithm>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            WorkStealingJobQueue::WorkStealingJobQueue(const unsigned int &workerCount)
+                : _workerCount(std::max(workerCount, 1u)),
+                  _deques(new WorkerDeque[_workerCount])
+            {
+            }
+
+            unsigned int WorkStealingJobQueue::targetWorker(const unsigned int &workerIndex)
+            {
+                if (workerIndex < _workerCount) return workerIndex;
+                return _nextWorker.fetch_add(1, std::memory_order_relaxed) % _workerCount;
+            }
+
+            void WorkStealingJobQueue::push(JobEntry &&job, const unsigned int &workerIndex)
+            {
+                WorkerDeque &deque = _deques[targetWorker(workerIndex)];
+                std::unique_lock<std::mutex> lock(deque.mutex);
+                deque.jobs.push_back(std::move(job));
+            }
+
+            void WorkStealingJobQueue::push(std::vector<JobEntry> &&jobs, const unsigned int &workerIndex)
+            {
+                if (jobs.empty()) return;
+                if (workerIndex < _workerCount) { // a worker keeps its own jobs, the others will steal them.
+                    WorkerDeque &deque = _deques[workerIndex];
+                    std::unique_lock<std::mutex> lock(deque.mutex);
+                    for (auto &job : jobs) {
+                        deque.jobs.push_back(std::move(job));
+                    }
+                    return;
+                }
+                // spread jobs from outside the pool over the deques in contiguous chunks.
+                const size_t chunks = std::min<size_t>(_workerCount, jobs.size());
+                const size_t chunkSize = (jobs.size() + chunks - 1) / chunks;
+                auto first = jobs.begin();
+                while (first != jobs.end()) {
+                    auto last = first + std::min<size_t>(chunkSize, jobs.end() - first);
+                    WorkerDeque &deque = _deques[targetWorker(noWorker)];
+                    std::unique_lock<std::mutex> lock(deque.mutex);
+                    for (; first != last; ++first) {
+                        deque.jobs.push_back(std::move(*first));
+                    }
+                }
+            }
+
+            bool WorkStealingJobQueue::tryPop(JobEntry &job, const unsigned int &workerIndex)
+            {
+                unsigned int start = 0;
+                if (workerIndex < _workerCount) {
+                    WorkerDeque &own = _deques[workerIndex];
+                    std::unique_lock<std::mutex> lock(own.mutex);
+                    if (!own.jobs.empty()) {
+                        job = std::move(own.jobs.back());
+                        own.jobs.pop_back();
+                        return true;
+                    }
+                    start = workerIndex + 1;
+                }
+                for (unsigned int offset = 0; offset < _workerCount; offset++) {
+                    const unsigned int victimIndex = (start + offset) % _workerCount;
+                    if (victimIndex == workerIndex) continue;
+                    WorkerDeque &victim = _deques[victimIndex];
+                    std::unique_lock<std::mutex> lock(victim.mutex);
+                    if (!victim.jobs.empty()) {
+                        job = std::move(victim.jobs.front());
+                        victim.jobs.pop_front();
+                        return true;
+                    }
+                }
+                return false;
+            }
+
+            std::vector<JobEntry> WorkStealingJobQueue::popAll()
+            {
+                std::vector<JobEntry> result;
+                for (unsigned int idx = 0; idx < _workerCount; idx++) {
+                    WorkerDeque &deque = _deques[idx];
+                    std::unique_lock<std::mutex> lock(deque.mutex);
+                    for (auto &job : deque.jobs) {
+                        result.push_back(std::move(job));
+                    }
+                    deque.jobs.clear();
+                }
+                return result;
+            }
+
+            size_t WorkStealingJobQueue::removeCancelled()
+            {
+                size_t removed = 0;
+                for (unsigned int idx = 0; idx < _workerCount; idx++) {
+                    WorkerDeque &deque = _deques[idx];
+                    std::unique_lock<std::mutex> lock(deque.mutex);
+                    const size_t before = deque.jobs.size();
+                    deque.jobs.erase(std::remove_if(deque.jobs.begin(), deque.jobs.end(), [](JobEntry &entry) { return entry.isCancelled(); }), deque.jobs.end());
+                    removed += before - deque.jobs.size();
+                }
+                return removed;
+            }
+        }
+    }
+}
@@ -0,0 +1,81 @@
+/*
+    SPDX-License-Identifier: MIT
+
+    © 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+    Permission is hereby granted, free of charge, to any person obtaining a copy
+    of this software and associated documentation files (the "Software"), to deal
+    in the Software without restriction, including without limitation the rights
+    to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+    copies of the Software, and to permit persons to whom the Software is
+    furnished to do so, subject to the following conditions:
+
+    The above copyright notice and this permission notice shall be included in all
+    copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+    IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+    FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+    AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+    LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+    OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+    SOFTWARE.
+
+    If you use this code, please mention usages of this library and the copyright notice visible
+    in your end product or distributed documentation. For example:
+
+    This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+    Visit http://www.ccopenlib.com for more information.
+
+    If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+    If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+    If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#ifndef CCOL_THREAD_WORKSTEALINGJOBQUEUE_HXX
+#define CCOL_THREAD_WORKSTEALINGJOBQUEUE_HXX
+
+#include "jobqueue.hxx"
+#include <atomic>
+#include <deque>
+#include <memory>
+#include <mutex>
+
+namespace ccol
+{
+    namespace thread
+    {
+        namespace detail
+        {
+            /** \brief A deque per worker, idle workers steal from the deques of the other workers.
+             *
+             *  Every deque has its own mutex, which is only contended when a worker is being robbed.
+             *  The owner works at the back of its deque (LIFO), thieves take from the front (FIFO).
+             */
+            class WorkStealingJobQueue : public JobQueue
+            {
+            private:
+                struct WorkerDeque
+                {
+                    std::mutex mutex;
+                    std::deque<JobEntry> jobs;
+                    char padding[64]; // keep the deques of different workers on different cache lines.
+                };
+                unsigned int _workerCount;
+                std::unique_ptr<WorkerDeque[]> _deques;
+                std::atomic<unsigned int> _nextWorker{0};
+                inline unsigned int targetWorker(const unsigned int &workerIndex);
+            public:
+                WorkStealingJobQueue(const unsigned int &workerCount);
+                void push(JobEntry &&job, const unsigned int &workerIndex) override;
+                void push(std::vector<JobEntry> &&jobs, const unsigned int &workerIndex) override;
+                bool tryPop(JobEntry &job, const unsigned int &workerIndex) override;
+                std::vector<JobEntry> popAll() override;
+                size_t removeCancelled() override;
+            };
+        }
+    }
+}
+
+#endif // CCOL_THREAD_WORKSTEALINGJOBQUEUE_HXX
@@ -0,0 +1,161 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/util/blockpool.hxx>
+#include <mutex>
+#include <new>
+
+namespace ccol
+{
+    namespace util
+    {
+        namespace {
+            constexpr std::size_t sizeClassCount = 7; // 32, 64, 128, 256, 512, 1024 and 2048 bytes.
+
+            inline std::size_t sizeClass(const std::size_t &size)
+            {
+                std::size_t index = 0;
+                std::size_t blockSize = BlockPool::minBlockSize;
+                while (blockSize < size) {
+                    blockSize <<= 1;
+                    index++;
+                }
+                return index;
+            }
+        }
+
+        constexpr std::size_t BlockPool::minBlockSize;
+        constexpr std::size_t BlockPool::maxBlockSize;
+
+        class BlockPool::Impl
+        {
+        private:
+            struct FreeBlock
+            {
+                FreeBlock *next;
+            };
+            struct FreeList
+            {
+                std::mutex mutex;
+                FreeBlock *head = nullptr;
+                std::size_t count = 0;
+                char padding[64]; // keep the free lists on different cache lines.
+            };
+            std::size_t _maxCachedBlocks;
+            FreeList _freeLists[sizeClassCount];
+        public:
+            Impl(const std::size_t &maxCachedBlocks);
+            void *allocate(const std::size_t &size);
+            void deallocate(void *block, const std::size_t &size);
+            ~Impl();
+        };
+
+        BlockPool::Impl::Impl(const std::size_t &maxCachedBlocks)
+            : _maxCachedBlocks(maxCachedBlocks)
+        {
+        }
+
+        void *BlockPool::Impl::allocate(const std::size_t &size)
+        {
+            if (size > maxBlockSize) return ::operator new(size);
+            const std::size_t index = sizeClass(size);
+            FreeList &freeList = _freeLists[index];
+            {
+                std::unique_lock<std::mutex> lock(freeList.mutex);
+                if (freeList.head != nullptr) {
+                    FreeBlock *block = freeList.head;
+                    freeList.head = block->next;
+                    freeList.count--;
+                    return block;
+                }
+            }
+            return ::operator new(minBlockSize << index);
+        }
+
+        void BlockPool::Impl::deallocate(void *block, const std::size_t &size)
+        {
+            if (block == nullptr) return;
+            if (size > maxBlockSize) {
+                ::operator delete(block);
+                return;
+            }
+            FreeList &freeList = _freeLists[sizeClass(size)];
+            {
+                std::unique_lock<std::mutex> lock(freeList.mutex);
+                if (freeList.count < _maxCachedBlocks) {
+                    freeList.head = new (block) FreeBlock{freeList.head};
+                    freeList.count++;
+                    return;
+                }
+            }
+            ::operator delete(block);
+        }
+
+        BlockPool::Impl::~Impl()
+        {
+            for (FreeList &freeList : _freeLists) {
+                while (freeList.head != nullptr) {
+                    FreeBlock *block = freeList.head;
+                    freeList.head = block->next;
+                    ::operator delete(block);
+                }
+            }
+        }
+
+        BlockPool::BlockPool()
+            : _impl(std::make_unique<Impl>(1024))
+        {
+        }
+
+        BlockPool::BlockPool(const std::size_t &maxCachedBlocks)
+            : _impl(std::make_unique<Impl>(maxCachedBlocks))
+        {
+        }
+
+        void *BlockPool::allocate(const std::size_t &size)
+        {
+            return _impl->allocate(size);
+        }
+
+        void BlockPool::deallocate(void *block, const std::size_t &size)
+        {
+            _impl->deallocate(block, size);
+        }
+
+        BlockPool::~BlockPool()
+        {
+        }
+    }
+}
@@ -0,0 +1,100 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/util/bumparena.hxx>
+#include <algorithm>
+#include <cstdint>
+
+namespace ccol
+{
+    namespace util
+    {
+        BumpArena::BumpArena(const std::size_t &chunkSize)
+            : _chunkSize(std::max<std::size_t>(chunkSize, 64))
+        {
+        }
+
+        void *BumpArena::allocate(const std::size_t &size, const std::size_t &alignment)
+        {
+            for (;;) {
+                if (_chunk < _chunks.size()) {
+                    Chunk &chunk = _chunks[_chunk];
+                    const std::uintptr_t base = reinterpret_cast<std::uintptr_t>(chunk.memory.get());
+                    const std::uintptr_t aligned = (base + _offset + alignment - 1) & ~std::uintptr_t(alignment - 1);
+                    const std::size_t offset = static_cast<std::size_t>(aligned - base);
+                    if (offset + size <= chunk.size) {
+                        _offset = offset + size;
+                        return chunk.memory.get() + offset;
+                    }
+                    if (_chunk + 1 == _chunks.size() && _offset == 0) { // an unused last chunk that is too small is replaced.
+                        _chunks.pop_back();
+                        continue;
+                    }
+                    _chunk++;
+                    _offset = 0;
+                    continue;
+                }
+                const std::size_t chunkSize = std::max(_chunkSize, size + alignment);
+                _chunks.push_back(Chunk{std::unique_ptr<unsigned char[]>(new unsigned char[chunkSize]), chunkSize});
+            }
+        }
+
+        BumpArena::Marker BumpArena::mark() const
+        {
+            return Marker{_chunk, _offset};
+        }
+
+        void BumpArena::rewind(const Marker &marker)
+        {
+            _chunk = marker.chunk;
+            _offset = marker.offset;
+        }
+
+        void BumpArena::reset()
+        {
+            _chunk = 0;
+            _offset = 0;
+        }
+
+        std::size_t BumpArena::capacity() const
+        {
+            std::size_t result = 0;
+            for (const auto &chunk : _chunks) {
+                result += chunk.size;
+            }
+            return result;
+        }
+    }
+}
@@ -0,0 +1,86 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/event/basiceventqueue.hxx>
+#include <future>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+TEST(BasicEventQueue, HandlesEventsInOrder)
+{
+    ccol::event::BasicEventQueue<int> queue;
+    for (int value = 1; value <= 5; value++) {
+        EXPECT_TRUE(queue.enqueue(value));
+    }
+    queue.enqueue(0);
+    std::vector<int> handled;
+    queue.run([&queue, &handled](int &&value) {
+        if (value == 0) {
+            queue.stop();
+            return;
+        }
+        handled.push_back(value);
+    });
+    EXPECT_EQ((std::vector<int>{1,2,3,4,5}), handled);
+    EXPECT_FALSE(queue.isRunning());
+}
+
+TEST(BasicEventQueue, RunsOnAnotherThread)
+{
+    ccol::event::BasicEventQueue<int, ccol::thread::RingQueue, ccol::thread::IdleStrategy::SpinThenPark> queue(16);
+    std::promise<int> sum;
+    std::thread loop([&queue, &sum]{
+        int total = 0;
+        queue.run([&total, &sum](int &&value) {
+            total += value;
+            if (value == 100) sum.set_value(total);
+        });
+    });
+    for (int value = 1; value <= 100; value++) {
+        while (!queue.enqueue(value)) std::this_thread::yield();
+    }
+    EXPECT_EQ(5050, sum.get_future().get());
+    queue.stop();
+    loop.join();
+}
+
+TEST(BasicEventQueue, FullQueueRejectsEvents)
+{
+    ccol::event::BasicEventQueue<int, ccol::thread::LockedQueue> queue(2);
+    EXPECT_TRUE(queue.enqueue(1));
+    EXPECT_TRUE(queue.enqueue(2));
+    EXPECT_FALSE(queue.enqueue(3));
+}
@@ -37,6 +37,7 @@ If you have found any errors or improvements you'd like to share, please contact
 #include <ccol/event/callbackevent.hxx>
 #include <ccol/event/dataevent.hxx>
 #include <typeindex>
+#include <vector>
 #include "gtest/gtest.h"
 
 TEST(EventQueue, EventQueueCallbackTest)
@@ -137,6 +138,29 @@ TEST(EventQueue, QueueLimitTest)
     EXPECT_EQ(3,count);
 }
 
+TEST(EventQueue, PostKeepsOrderWithEvents)
+{
+    ccol::event::EventQueue queue(1);
+    std::vector<int> order;
+    queue.setCallbackForType( typeid(ccol::event::CallbackEvent), [](ccol::event::EventQueue::event_type &&event){
+        std::static_pointer_cast<ccol::event::CallbackEvent>(event)->invoke();
+    });
+    struct Context { std::vector<int> *order; int value; ccol::event::EventQueue *queue; };
+    auto record = [](void *context) {
+        auto ctx = static_cast<Context*>(context);
+        ctx->order->push_back(ctx->value);
+        if (ctx->value==3) ctx->queue->stop();
+    };
+    Context first{&order, 1, &queue};
+    Context last{&order, 3, &queue};
+    EXPECT_FALSE(queue.post(nullptr, &first));
+    EXPECT_TRUE(queue.post(record, &first));
+    EXPECT_TRUE(queue.enqueue(std::make_shared<ccol::event::CallbackEvent>([&order]{ order.push_back(2); })));
+    EXPECT_TRUE(queue.post(record, &last)); // posts are not limited by the queue size
+    queue.run();
+    EXPECT_EQ((std::vector<int>{1,2,3}), order);
+}
+
 TEST(EventQueue, EventsAsVectorTest)
 {
     ccol::event::EventQueue queue;
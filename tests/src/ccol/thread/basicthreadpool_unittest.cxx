@@ -0,0 +1,125 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/basicthreadpool.hxx>
+#include <atomic>
+#include <future>
+#include <thread>
+#include "gtest/gtest.h"
+
+namespace {
+
+std::atomic_int functionCalls{0};
+
+void countCall()
+{
+    functionCalls++;
+}
+
+TEST(BasicThreadPool, RunsAllJobs)
+{
+    ccol::thread::BasicThreadPool<> threadpool(2);
+    EXPECT_EQ(2u, threadpool.threadCount());
+    std::atomic_int count{0};
+    for (int idx = 0; idx < 1000; idx++) {
+        EXPECT_TRUE(threadpool.enqueue([&count]{ count++; }));
+    }
+    threadpool.wait();
+    EXPECT_EQ(1000, count);
+}
+
+TEST(BasicThreadPool, RunsFunctionPointersFromARing)
+{
+    ccol::thread::BasicThreadPool<void(*)(), ccol::thread::RingQueue, ccol::thread::IdleStrategy::SpinThenPark> threadpool(2, 2048);
+    functionCalls = 0;
+    for (int idx = 0; idx < 1000; idx++) {
+        EXPECT_TRUE(threadpool.enqueue(&countCall));
+    }
+    threadpool.wait();
+    EXPECT_EQ(1000, functionCalls);
+}
+
+TEST(BasicThreadPool, BusySpinningWorkersStop)
+{
+    std::atomic_int count{0};
+    {
+        ccol::thread::BasicThreadPool<ccol::thread::BasicJob<32>, ccol::thread::LockedQueue, ccol::thread::IdleStrategy::BusySpin> threadpool(1);
+        threadpool.enqueue([&count]{ count++; });
+        threadpool.wait();
+    }
+    EXPECT_EQ(1, count);
+}
+
+TEST(BasicThreadPool, FullQueueRejectsJobs)
+{
+    ccol::thread::BasicThreadPool<ccol::thread::Job, ccol::thread::RingQueue> threadpool(1, 2);
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released(release.get_future());
+    threadpool.enqueue([&started, released]{
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait(); // the worker holds the first job, the ring is empty.
+    std::atomic_int count{0};
+    EXPECT_TRUE(threadpool.enqueue([&count]{ count++; }));
+    EXPECT_TRUE(threadpool.enqueue([&count]{ count++; }));
+    EXPECT_FALSE(threadpool.enqueue([&count]{ count++; }));
+    release.set_value();
+    threadpool.wait();
+    EXPECT_EQ(2, count);
+}
+
+TEST(BasicThreadPool, RunPendingJobRunsOnTheCallingThread)
+{
+    ccol::thread::BasicThreadPool<> threadpool(1);
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released(release.get_future());
+    threadpool.enqueue([&started, released]{
+        started.set_value();
+        released.wait();
+    });
+    started.get_future().wait();
+    std::thread::id executor;
+    threadpool.enqueue([&executor]{ executor = std::this_thread::get_id(); });
+    EXPECT_TRUE(threadpool.runPendingJob());
+    EXPECT_EQ(std::this_thread::get_id(), executor);
+    EXPECT_FALSE(threadpool.runPendingJob());
+    release.set_value();
+    threadpool.wait();
+}
+
+}
@@ -0,0 +1,152 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/batcher.hxx>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(Batcher, FlushesFullBatches)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::mutex mutex;
+    std::vector<std::size_t> sizes;
+    int sum = 0;
+    ccol::thread::Batcher<int> batcher(threadpool, 10, std::chrono::microseconds(0), [&](std::vector<int> &items) {
+        std::lock_guard<std::mutex> lock(mutex);
+        sizes.push_back(items.size());
+        for (int item : items) sum += item;
+    });
+    for (int item = 1; item <= 100; item++) {
+        batcher.add(item);
+    }
+    batcher.wait();
+    EXPECT_EQ(std::vector<std::size_t>(10, 10), sizes);
+    EXPECT_EQ(5050, sum);
+}
+
+TEST(Batcher, FlushesAfterTheDelay)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    std::promise<std::vector<std::string>> flushed;
+    ccol::thread::Batcher<std::string> batcher(threadpool, 1000, std::chrono::microseconds(20000), [&flushed](std::vector<std::string> &items) {
+        flushed.set_value(std::move(items));
+    });
+    const auto start = std::chrono::steady_clock::now();
+    batcher.add("a");
+    batcher.add(std::string("b"));
+    auto future = flushed.get_future();
+    ASSERT_EQ(std::future_status::ready, future.wait_for(std::chrono::seconds(5)));
+    EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(20));
+    EXPECT_EQ((std::vector<std::string>{"a", "b"}), future.get());
+}
+
+TEST(Batcher, CollectsFromManyThreads)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::atomic<long long> sum{0};
+    std::atomic<long long> count{0};
+    {
+        ccol::thread::Batcher<int> batcher(threadpool, 64, std::chrono::microseconds(100), [&](std::vector<int> &items) {
+            long long local = 0;
+            for (int item : items) local += item;
+            sum += local;
+            count += static_cast<long long>(items.size());
+        });
+        std::vector<std::thread> producers;
+        for (int producer = 0; producer < 4; producer++) {
+            producers.emplace_back([&batcher] {
+                for (int item = 1; item <= 10000; item++) batcher.add(item);
+            });
+        }
+        for (auto &producer : producers) producer.join();
+    }
+    EXPECT_EQ(40000, count);
+    EXPECT_EQ(4LL * 10000 * 10001 / 2, sum);
+}
+
+TEST(Batcher, DestructorFlushesTheLastBatch)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    std::size_t flushed = 0;
+    {
+        ccol::thread::Batcher<int> batcher(threadpool, 100, std::chrono::microseconds(0), [&flushed](std::vector<int> &items) {
+            flushed += items.size();
+        });
+        for (int item = 0; item < 5; item++) batcher.add(item);
+    }
+    EXPECT_EQ(5u, flushed);
+}
+
+TEST(Batcher, ReusesItsBuffers)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    std::set<const int*> buffers;
+    ccol::thread::Batcher<int> batcher(threadpool, 8, std::chrono::microseconds(0), [&buffers](std::vector<int> &items) {
+        buffers.insert(items.data());
+    }, 2);
+    for (int item = 0; item < 800; item++) batcher.add(item);
+    batcher.wait();
+    EXPECT_EQ(2u, buffers.size());
+}
+
+TEST(Batcher, AddsFromAJobOfAHelpingPool)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.helpWhileWaiting = true;
+    ccol::thread::ThreadPool threadpool(options);
+    std::promise<int> done;
+    threadpool.enqueue([&threadpool,&done]{
+        int sum = 0;
+        ccol::thread::Batcher<int> batcher(threadpool, 4, std::chrono::microseconds(0), [&sum](std::vector<int> &items) {
+            for (int item : items) sum += item;
+        }, 1);
+        for (int item = 1; item <= 100; item++) batcher.add(item);
+        batcher.wait();
+        done.set_value(sum);
+    });
+    EXPECT_EQ(5050, done.get_future().get());
+}
+
+}
@@ -0,0 +1,186 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/threadpool.hxx>
+#include <ccol/event/eventqueue.hxx>
+#include "gtest/gtest.h"
+
+#ifdef CCOL_ENABLE_COROUTINES
+
+#include <ccol/thread/coroutine.hxx>
+#include <ccol/event/coroutine.hxx>
+#include <atomic>
+#include <future>
+#include <thread>
+#include <type_traits>
+
+namespace {
+
+ccol::thread::Task<std::thread::id> hop(ccol::thread::ThreadPool &pool)
+{
+    co_await pool.schedule();
+    co_return std::this_thread::get_id();
+}
+
+ccol::thread::Task<int> doubled(ccol::thread::ThreadPool &pool, int value)
+{
+    co_await pool.schedule();
+    co_return value * 2;
+}
+
+ccol::thread::Task<int> sumOfDoubled(ccol::thread::ThreadPool &pool, int count)
+{
+    int sum = 0;
+    for (int i = 0; i < count; ++i) {
+        sum += co_await doubled(pool, i);
+    }
+    co_return sum;
+}
+
+ccol::thread::Task<void> setFlag(std::atomic_bool &flag)
+{
+    flag = true;
+    co_return;
+}
+
+ccol::thread::Task<std::thread::id> onEventLoop(ccol::event::EventQueue &queue)
+{
+    co_await queue.schedule();
+    co_return std::this_thread::get_id();
+}
+
+// Counts the frames that were destroyed, completed or not.
+struct FrameGuard
+{
+    std::atomic_int &destroyed;
+    ~FrameGuard() { destroyed++; }
+};
+
+ccol::thread::Task<int> guardedHop(ccol::thread::ThreadPool &pool, std::atomic_int &destroyed)
+{
+    FrameGuard guard{destroyed};
+    co_await pool.schedule();
+    co_return 1;
+}
+
+ccol::thread::Task<int> awaitGuardedHop(ccol::thread::ThreadPool &pool, std::atomic_int &destroyed)
+{
+    FrameGuard guard{destroyed};
+    co_return co_await guardedHop(pool, destroyed) + 1;
+}
+
+TEST(Coroutine, ScheduleResumesOnWorker)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    EXPECT_NE(std::this_thread::get_id(), ccol::thread::syncWait(hop(threadpool)));
+}
+
+TEST(Coroutine, TasksCompose)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    EXPECT_EQ(9900, ccol::thread::syncWait(sumOfDoubled(threadpool, 100)));
+}
+
+TEST(Coroutine, TaskIsLazy)
+{
+    std::atomic_bool flag{false};
+    auto task = setFlag(flag);
+    EXPECT_TRUE(task.valid());
+    EXPECT_FALSE(task.done());
+    EXPECT_FALSE(flag);
+    ccol::thread::syncWait(std::move(task));
+    EXPECT_TRUE(flag);
+}
+
+TEST(Coroutine, ManyTasksRecycleFrames)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    for (int i = 0; i < 1000; ++i) {
+        EXPECT_EQ(i * 2, ccol::thread::syncWait(doubled(threadpool, i)));
+    }
+}
+
+TEST(Coroutine, TasksOnAThreadPoolAllocateFromThePool)
+{
+    static_assert(std::is_same<std::coroutine_traits<ccol::thread::Task<int>, ccol::thread::ThreadPool&, int>::promise_type,
+                               ccol::thread::detail::PoolTaskPromise<int, int>>::value, "A Task on a ThreadPool allocates from its BlockPool.");
+    static_assert(std::is_same<std::coroutine_traits<ccol::thread::Task<void>, std::atomic_bool&>::promise_type,
+                               ccol::thread::detail::TaskPromise<void>>::value, "Other Tasks use the global heap.");
+    ccol::thread::ThreadPool threadpool(1);
+    EXPECT_NE(std::this_thread::get_id(), ccol::thread::syncWait(hop(threadpool)));
+}
+
+TEST(Coroutine, DroppedHopDestroysTheAwaitingTasks)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::promise<void> started;
+    threadpool.enqueue([opened,&started]{ started.set_value(); opened.wait(); });
+    started.get_future().wait();
+    std::atomic_int destroyed{0};
+    auto waiter = std::async(std::launch::async, [&threadpool,&destroyed]{
+        return ccol::thread::syncWait(awaitGuardedHop(threadpool, destroyed));
+    });
+    while (threadpool.queueCount() == 0) {
+        std::this_thread::yield();
+    }
+    threadpool.clear();
+    EXPECT_THROW(waiter.get(), std::future_error);
+    EXPECT_EQ(2, destroyed);
+    gate.set_value();
+    threadpool.wait();
+}
+
+TEST(Coroutine, CompletedTasksDestroyTheirFramesOnce)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    std::atomic_int destroyed{0};
+    EXPECT_EQ(2, ccol::thread::syncWait(awaitGuardedHop(threadpool, destroyed)));
+    EXPECT_EQ(2, destroyed);
+}
+
+TEST(Coroutine, EventQueueScheduleResumesOnRunThread)
+{
+    ccol::event::EventQueue queue;
+    std::thread loop([&queue]{ queue.run(); });
+    EXPECT_EQ(loop.get_id(), ccol::thread::syncWait(onEventLoop(queue)));
+    queue.stop();
+    loop.join();
+}
+
+}
+
+#endif // CCOL_ENABLE_COROUTINES
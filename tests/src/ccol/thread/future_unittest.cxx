@@ -0,0 +1,233 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/future.hxx>
+#include <ccol/thread/threadpool.hxx>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(Future, SubmitReturnsValue)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    auto future = threadpool.submit([]{ return 42; });
+    EXPECT_TRUE(future.valid());
+    EXPECT_EQ(42,future.get());
+    EXPECT_FALSE(future.valid());
+}
+
+TEST(Future, SubmitVoidFunction)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::atomic_int count{0};
+    auto future = threadpool.submit([&count]{ count++; });
+    future.get();
+    EXPECT_EQ(1,count);
+}
+
+TEST(Future, SubmitMoveOnlyResult)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    auto future = threadpool.submit([value = std::make_unique<int>(5)]() mutable { return std::move(value); });
+    std::unique_ptr<int> result = future.get();
+    EXPECT_EQ(5,*result);
+}
+
+TEST(Future, ThenChainsContinuations)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    auto future = threadpool.submit([]{ return 21; })
+            .then([](int value){ return value * 2; })
+            .then([](int value){ return std::to_string(value); });
+    EXPECT_EQ("42",future.get());
+}
+
+TEST(Future, ThenWithVoid)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::atomic_int count{0};
+    auto future = threadpool.submit([&count]{ count++; })
+            .then([&count]{ count++; return count.load(); });
+    EXPECT_EQ(2,future.get());
+}
+
+TEST(Future, ThenIsScheduledOnPool)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    ccol::thread::Promise<int> promise(threadpool);
+    auto future = promise.getFuture().then([](int value){
+        return std::make_pair(value, std::this_thread::get_id());
+    });
+    promise.setValue(3);
+    auto result = future.get();
+    EXPECT_EQ(3,result.first);
+    EXPECT_NE(std::this_thread::get_id(),result.second);
+}
+
+TEST(Future, ThenWithoutPoolRunsOnSettingThread)
+{
+    ccol::thread::Promise<int> promise;
+    std::thread::id continuationThread;
+    auto future = promise.getFuture().then([&continuationThread](int value){
+        continuationThread = std::this_thread::get_id();
+        return value + 1;
+    });
+    EXPECT_FALSE(future.isReady());
+    promise.setValue(1);
+    EXPECT_TRUE(future.isReady());
+    EXPECT_EQ(std::this_thread::get_id(),continuationThread);
+    EXPECT_EQ(2,future.get());
+}
+
+TEST(Future, ThenOnReadyFuture)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    auto future = threadpool.submit([]{ return 1; });
+    future.wait();
+    EXPECT_TRUE(future.isReady());
+    EXPECT_EQ(2,future.then([](int value){ return value + 1; }).get());
+}
+
+TEST(Future, WaitForTimesOut)
+{
+    using namespace std::literals::chrono_literals;
+
+    ccol::thread::Promise<void> promise;
+    auto future = promise.getFuture();
+    EXPECT_FALSE(future.wait_for(10ms));
+    promise.setValue();
+    EXPECT_TRUE(future.wait_for(10ms));
+}
+
+TEST(Future, WhenAllIsReadyWhenAllFuturesAreReady)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::vector<ccol::thread::Future<int>> futures;
+    for (int counter=0; counter<100; counter++) {
+        futures.push_back(threadpool.submit([counter]{ return counter; }));
+    }
+    auto all = ccol::thread::when_all(std::move(futures)).get();
+    ASSERT_EQ(100,all.size());
+    int sum = 0;
+    for (auto &future : all) {
+        EXPECT_TRUE(future.isReady());
+        sum += future.get();
+    }
+    EXPECT_EQ(4950,sum);
+}
+
+TEST(Future, WhenAllWithoutFuturesIsReady)
+{
+    auto all = ccol::thread::when_all(std::vector<ccol::thread::Future<void>>());
+    EXPECT_TRUE(all.isReady());
+    EXPECT_EQ(0,all.get().size());
+}
+
+TEST(Future, WhenAllThen)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::vector<ccol::thread::Future<int>> futures;
+    futures.push_back(threadpool.submit([]{ return 1; }));
+    futures.push_back(threadpool.submit([]{ return 2; }));
+    auto sum = ccol::thread::when_all(std::move(futures)).then([](std::vector<ccol::thread::Future<int>> futures){
+        int sum = 0;
+        for (auto &future : futures) sum += future.get();
+        return sum;
+    });
+    EXPECT_EQ(3,sum.get());
+}
+
+TEST(Future, WhenAnyReturnsFirstReadyFuture)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    ccol::thread::Promise<int> first(threadpool);
+    ccol::thread::Promise<int> second(threadpool);
+    std::vector<ccol::thread::Future<int>> futures;
+    futures.push_back(first.getFuture());
+    futures.push_back(second.getFuture());
+    auto any = ccol::thread::when_any(std::move(futures));
+    EXPECT_FALSE(any.isReady());
+    second.setValue(7);
+    auto result = any.get();
+    EXPECT_EQ(1,result.index);
+    ASSERT_EQ(2,result.futures.size());
+    EXPECT_EQ(7,result.futures[1].get());
+    EXPECT_FALSE(result.futures[0].isReady());
+    first.setValue(3);
+    EXPECT_EQ(3,result.futures[0].get());
+}
+
+TEST(Future, ClearedJobBreaksFuture)
+{
+    using namespace std::literals::chrono_literals;
+
+    ccol::thread::ThreadPool threadpool(1);
+    std::promise<void> started;
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    auto blocker = threadpool.submit([&started, released]{ started.set_value(); released.wait(); });
+    started.get_future().wait();
+    auto future = threadpool.submit([]{ return 1; });
+    auto continuation = threadpool.submit([]{ return 2; }).then([](int value){ return value + 1; });
+    threadpool.clear();
+    release.set_value();
+    EXPECT_TRUE(future.wait_for(1s));
+    EXPECT_TRUE(future.isBroken());
+    EXPECT_THROW(future.get(), std::future_error);
+    EXPECT_TRUE(continuation.wait_for(1s));
+    EXPECT_THROW(continuation.get(), std::future_error);
+    blocker.get();
+}
+
+TEST(Future, DestroyedPromiseBreaksFuture)
+{
+    ccol::thread::Future<int> future;
+    {
+        ccol::thread::Promise<int> promise;
+        future = promise.getFuture();
+    }
+    EXPECT_TRUE(future.isReady());
+    EXPECT_TRUE(future.isBroken());
+    EXPECT_THROW(future.get(), std::future_error);
+}
+
+}
@@ -0,0 +1,151 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/job.hxx>
+#include <functional>
+#include <memory>
+#include "gtest/gtest.h"
+
+namespace {
+
+struct DestructionCounter
+{
+    int *count;
+    DestructionCounter(int *count) : count(count) {}
+    DestructionCounter(DestructionCounter &&other) noexcept : count(other.count) { other.count = nullptr; }
+    ~DestructionCounter() { if (count != nullptr) (*count)++; }
+};
+
+TEST(Job, DefaultConstructedJobIsEmpty)
+{
+    ccol::thread::Job job;
+    EXPECT_FALSE(job);
+    EXPECT_TRUE(job == nullptr);
+}
+
+TEST(Job, EmptyFunctionResultsInEmptyJob)
+{
+    std::function<void()> function;
+    ccol::thread::Job job(function);
+    EXPECT_TRUE(job == nullptr);
+    void (*pointer)() = nullptr;
+    ccol::thread::Job job2(pointer);
+    EXPECT_TRUE(job2 == nullptr);
+}
+
+TEST(Job, SmallCallableIsStoredInline)
+{
+    int count = 0;
+    ccol::thread::Job job([&count]{ count++; });
+    EXPECT_TRUE(job != nullptr);
+    EXPECT_FALSE(job.isHeapAllocated());
+    job();
+    job();
+    EXPECT_EQ(2,count);
+}
+
+TEST(Job, CallableOfInlineSizeIsStoredInline)
+{
+    struct Capture { char data[ccol::thread::Job::inlineSize - sizeof(int*)]; };
+    int count = 0;
+    Capture capture{};
+    ccol::thread::Job job([&count, capture]{ count += capture.data[0] + 1; });
+    EXPECT_FALSE(job.isHeapAllocated());
+    job();
+    EXPECT_EQ(1,count);
+}
+
+TEST(Job, LargeCallableIsStoredOnHeap)
+{
+    struct Capture { char data[ccol::thread::Job::inlineSize + 1]; };
+    int count = 0;
+    Capture capture{};
+    ccol::thread::Job job([&count, capture]{ count += capture.data[0] + 1; });
+    EXPECT_TRUE(job.isHeapAllocated());
+    ccol::thread::Job moved(std::move(job));
+    EXPECT_TRUE(job == nullptr);
+    moved();
+    EXPECT_EQ(1,count);
+}
+
+TEST(Job, ConfigurableInlineSize)
+{
+    struct Capture { char data[64]; };
+    Capture capture{};
+    ccol::thread::BasicJob<32> small([capture]{});
+    ccol::thread::BasicJob<96> large([capture]{});
+    EXPECT_TRUE(small.isHeapAllocated());
+    EXPECT_FALSE(large.isHeapAllocated());
+}
+
+TEST(Job, AcceptsMoveOnlyCallable)
+{
+    auto value = std::make_unique<int>(5);
+    int result = 0;
+    ccol::thread::Job job([value = std::move(value), &result]{ result = *value; });
+    ccol::thread::Job moved;
+    moved = std::move(job);
+    EXPECT_TRUE(job == nullptr);
+    moved();
+    EXPECT_EQ(5,result);
+}
+
+TEST(Job, CallableDestroyedOnce)
+{
+    int inlineDestructions = 0;
+    int heapDestructions = 0;
+    struct Padding { char data[ccol::thread::Job::inlineSize]; };
+    {
+        ccol::thread::Job job([counter = DestructionCounter(&inlineDestructions)]{});
+        ccol::thread::Job job2([counter = DestructionCounter(&heapDestructions), padding = Padding()]{});
+        ccol::thread::Job moved(std::move(job));
+        ccol::thread::Job moved2(std::move(job2));
+        EXPECT_EQ(0,inlineDestructions);
+        EXPECT_EQ(0,heapDestructions);
+    }
+    EXPECT_EQ(1,inlineDestructions);
+    EXPECT_EQ(1,heapDestructions);
+}
+
+TEST(Job, AssignNullptrDestroysCallable)
+{
+    int destructions = 0;
+    ccol::thread::Job job([counter = DestructionCounter(&destructions)]{});
+    job = nullptr;
+    EXPECT_EQ(1,destructions);
+    EXPECT_TRUE(job == nullptr);
+}
+
+}
@@ -0,0 +1,156 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include "ccol/thread/numatopology.hxx"
+#include <ccol/thread/threadpool.hxx>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#ifdef __linux__
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+TEST(NumaTopology, ParseCpuListWithRanges)
+{
+    EXPECT_EQ((std::vector<unsigned int>{0, 1, 2, 3, 8}), ccol::thread::detail::parseCpuList("0-3,8\n"));
+    EXPECT_EQ((std::vector<unsigned int>{10, 11, 14}), ccol::thread::detail::parseCpuList("10-11,14"));
+    EXPECT_EQ((std::vector<unsigned int>{5}), ccol::thread::detail::parseCpuList("5"));
+    EXPECT_TRUE(ccol::thread::detail::parseCpuList("").empty());
+    EXPECT_TRUE(ccol::thread::detail::parseCpuList("\n").empty());
+}
+
+TEST(NumaTopology, WithoutSysfsAllCpusBelongToOneNode)
+{
+    auto topology = ccol::thread::detail::readNumaTopology("/nonexistent/ccopenlib/node");
+    ASSERT_EQ(1u, topology.nodeCpus.size());
+    EXPECT_EQ(std::max(std::thread::hardware_concurrency(), 1u), topology.nodeCpus[0].size());
+    EXPECT_EQ(0u, topology.currentNode());
+}
+
+#ifdef __linux__
+// A directory in the layout of /sys/devices/system/node, removed when it goes out of scope.
+class FakeSysfs
+{
+private:
+    std::string _path;
+    std::vector<std::string> _files;
+    std::vector<std::string> _directories;
+public:
+    FakeSysfs()
+    {
+        char path[] = "/tmp/ccopenlib-numa-XXXXXX";
+        if (mkdtemp(path) != nullptr) _path = path;
+    }
+
+    const std::string &path() const { return _path; }
+
+    void write(const std::string &name, const std::string &content)
+    {
+        const std::string::size_type slash = name.rfind('/');
+        if (slash != std::string::npos) {
+            const std::string directory = _path + "/" + name.substr(0, slash);
+            if (mkdir(directory.c_str(), 0700) == 0) _directories.push_back(directory);
+        }
+        std::ofstream file(_path + "/" + name);
+        file << content;
+        _files.push_back(_path + "/" + name);
+    }
+
+    ~FakeSysfs()
+    {
+        for (const auto &file : _files) unlink(file.c_str());
+        for (const auto &directory : _directories) rmdir(directory.c_str());
+        if (!_path.empty()) rmdir(_path.c_str());
+    }
+};
+
+TEST(NumaTopology, ReadsNodesAndSkipsMemoryOnlyNodes)
+{
+    FakeSysfs sysfs;
+    ASSERT_FALSE(sysfs.path().empty());
+    sysfs.write("online", "0-2\n");
+    sysfs.write("node0/cpulist", "0-3,8\n");
+    sysfs.write("node1/cpulist", "\n"); // memory only.
+    sysfs.write("node2/cpulist", "4-7\n");
+    auto topology = ccol::thread::detail::readNumaTopology(sysfs.path());
+    ASSERT_EQ(2u, topology.nodeCpus.size());
+    EXPECT_EQ((std::vector<unsigned int>{0, 1, 2, 3, 8}), topology.nodeCpus[0]);
+    EXPECT_EQ((std::vector<unsigned int>{4, 5, 6, 7}), topology.nodeCpus[1]);
+    ASSERT_EQ(9u, topology.cpuNodes.size());
+    EXPECT_EQ(0u, topology.cpuNodes[2]);
+    EXPECT_EQ(1u, topology.cpuNodes[5]);
+    EXPECT_EQ(0u, topology.cpuNodes[8]);
+}
+
+TEST(NumaTopology, NodeWithoutCpulistIsSkipped)
+{
+    FakeSysfs sysfs;
+    ASSERT_FALSE(sysfs.path().empty());
+    sysfs.write("online", "0,3\n");
+    sysfs.write("node3/cpulist", "0-1\n"); // node0 has no cpulist file.
+    auto topology = ccol::thread::detail::readNumaTopology(sysfs.path());
+    ASSERT_EQ(1u, topology.nodeCpus.size());
+    EXPECT_EQ((std::vector<unsigned int>{0, 1}), topology.nodeCpus[0]);
+}
+TEST(NumaTopology, WorkersKeepTheInheritedAffinity)
+{
+    std::atomic_int widened{0};
+    std::thread creator([&widened]{
+        ccol::thread::detail::pinCurrentThread(std::vector<unsigned int>{ccol::thread::detail::currentThreadCpus().front()});
+        ccol::thread::ThreadPoolOptions options;
+        options.threads = 2;
+        options.scheduling = ccol::thread::Scheduling::Numa;
+        ccol::thread::ThreadPool threadpool(options);
+        for (int counter=0; counter<20; counter++) {
+            threadpool.enqueue([&widened]{
+                if (ccol::thread::detail::currentThreadCpus().size() > 1) widened++;
+            });
+        }
+        threadpool.wait();
+    });
+    creator.join();
+    EXPECT_EQ(0, widened);
+}
+#endif
+
+}
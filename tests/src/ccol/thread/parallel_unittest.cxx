@@ -0,0 +1,235 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/parallel.hxx>
+#include <ccol/thread/threadpool.hxx>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <memory>
+#include <numeric>
+#include <random>
+#include <string>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(Parallel, ForVisitsEveryElementOnce)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    std::vector<int> values(100003, 0);
+    ccol::thread::parallel_for(threadpool, values.begin(), values.end(), [](int &value){
+        value++;
+    });
+    for (const auto &value : values) {
+        ASSERT_EQ(1,value);
+    }
+}
+
+TEST(Parallel, ForIndexRange)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    std::atomic<long long> sum{0};
+    ccol::thread::parallel_for(threadpool, 0, 10000, [&sum](int index){
+        sum += index;
+    });
+    EXPECT_EQ(49995000,sum);
+}
+
+TEST(Parallel, ForEmptyRange)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::vector<int> values;
+    int count = 0;
+    ccol::thread::parallel_for(threadpool, values.begin(), values.end(), [&count](int &){ count++; });
+    EXPECT_EQ(0,count);
+    EXPECT_EQ(0,threadpool.totalJobCount());
+}
+
+TEST(Parallel, ForFromJobOnSamePool)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    std::vector<int> values(10000, 1);
+    auto future = threadpool.submit([&threadpool, &values]{
+        ccol::thread::parallel_for(threadpool, values.begin(), values.end(), [](int &value){ value *= 2; });
+        return std::accumulate(values.begin(), values.end(), 0);
+    });
+    EXPECT_EQ(20000,future.get());
+}
+
+TEST(Parallel, ReduceSum)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    std::vector<long long> values(1000000);
+    std::iota(values.begin(), values.end(), 1);
+    long long sum = ccol::thread::parallel_reduce(threadpool, values.begin(), values.end(), 0LL, [](long long a, long long b){ return a + b; });
+    EXPECT_EQ(500000500000LL,sum);
+}
+
+TEST(Parallel, ReduceWithTransformOnIndexRange)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    long long sum = ccol::thread::parallel_reduce(threadpool, 0, 1000, 0LL,
+        [](long long a, long long b){ return a + b; },
+        [](int index){ return static_cast<long long>(index) * index; });
+    EXPECT_EQ(332833500LL,sum);
+}
+
+TEST(Parallel, ReduceEmptyRangeReturnsIdentity)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::vector<int> values;
+    EXPECT_EQ(7,ccol::thread::parallel_reduce(threadpool, values.begin(), values.end(), 7, [](int a, int b){ return a + b; }));
+}
+
+TEST(Parallel, ScanMatchesPartialSum)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    for (std::size_t size : {0, 1, 17, 1000, 100003}) {
+        std::vector<int> values(size);
+        for (std::size_t idx=0; idx<size; idx++) {
+            values[idx] = static_cast<int>(idx % 7) - 3;
+        }
+        std::vector<int> expected(size);
+        std::partial_sum(values.begin(), values.end(), expected.begin());
+        std::vector<int> output(size);
+        auto end = ccol::thread::parallel_scan(threadpool, values.begin(), values.end(), output.begin(), 0, [](int a, int b){ return a + b; });
+        EXPECT_TRUE(end == output.end());
+        EXPECT_EQ(expected,output);
+        ccol::thread::parallel_scan(threadpool, values.begin(), values.end(), values.begin(), 0, [](int a, int b){ return a + b; });
+        EXPECT_EQ(expected,values);
+    }
+}
+
+TEST(Parallel, ScanPreservesOrderOfNonCommutativeOperation)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    std::vector<std::string> values;
+    for (int idx=0; idx<500; idx++) {
+        values.push_back(std::string(1, static_cast<char>('a' + idx % 26)));
+    }
+    std::vector<std::string> output(values.size());
+    ccol::thread::parallel_scan(threadpool, values.begin(), values.end(), output.begin(), std::string(),
+        [](const std::string &a, const std::string &b){ return a + b; });
+    std::string expected;
+    for (std::size_t idx=0; idx<values.size(); idx++) {
+        expected += values[idx];
+        ASSERT_EQ(expected,output[idx]);
+    }
+}
+
+TEST(Parallel, SortMatchesStdSort)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    std::mt19937 random(42);
+    for (std::size_t size : {0, 1, 1000, 100003, 1000003}) {
+        std::vector<int> values(size);
+        for (auto &value : values) {
+            value = static_cast<int>(random() % 100000);
+        }
+        std::vector<int> expected = values;
+        std::sort(expected.begin(), expected.end());
+        ccol::thread::parallel_sort(threadpool, values.begin(), values.end());
+        ASSERT_EQ(expected,values);
+    }
+}
+
+TEST(Parallel, SortMovesElementsThatOwnMemory)
+{
+    ccol::thread::ThreadPool threadpool(3);
+    std::mt19937 random(7);
+    std::vector<std::string> values(200001);
+    for (auto &value : values) {
+        value = std::to_string(random()) + " with a suffix that does not fit in a small string";
+    }
+    std::vector<std::string> expected = values;
+    std::sort(expected.begin(), expected.end(), std::greater<std::string>());
+    ccol::thread::parallel_sort(threadpool, values.begin(), values.end(), std::greater<std::string>());
+    EXPECT_EQ(expected,values);
+}
+
+TEST(Parallel, SortFromJobOnSamePool)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    std::vector<int> values(300000);
+    std::iota(values.rbegin(), values.rend(), 0);
+    std::promise<void> done;
+    threadpool.enqueue([&]{
+        ccol::thread::parallel_sort(threadpool, values.begin(), values.end());
+        done.set_value();
+    });
+    done.get_future().wait();
+    EXPECT_TRUE(std::is_sorted(values.begin(), values.end()));
+    EXPECT_EQ(0,values.front());
+}
+
+TEST(Parallel, MergeKeepsTheOrderOfRunsForEqualElements)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    std::mt19937 random(3);
+    typedef std::pair<int,int> Element; // the key and the run.
+    std::vector<std::vector<Element>> runs(5);
+    for (int run = 0; run < 5; run++) {
+        runs[run].resize(run == 2 ? 0 : 20000 * (run + 1));
+        for (auto &element : runs[run]) {
+            element = Element(static_cast<int>(random() % 5000), run);
+        }
+        std::sort(runs[run].begin(), runs[run].end());
+    }
+    std::vector<std::pair<std::vector<Element>::const_iterator, std::vector<Element>::const_iterator>> ranges;
+    std::vector<Element> expected;
+    for (const auto &run : runs) {
+        ranges.emplace_back(run.begin(), run.end());
+        expected.insert(expected.end(), run.begin(), run.end());
+    }
+    std::sort(expected.begin(), expected.end());
+    std::vector<Element> output(expected.size());
+    auto end = ccol::thread::parallel_merge(threadpool, ranges, output.begin(),
+                                            [](const Element &left, const Element &right) { return left.first < right.first; });
+    EXPECT_TRUE(end == output.end());
+    EXPECT_EQ(expected,output);
+}
+
+TEST(Parallel, MergeEmptyRuns)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::vector<int> empty;
+    std::vector<std::pair<std::vector<int>::iterator, std::vector<int>::iterator>> ranges{{empty.begin(), empty.end()}};
+    std::vector<int> output;
+    EXPECT_TRUE(ccol::thread::parallel_merge(threadpool, ranges, output.begin()) == output.begin());
+}
+
+}
@@ -0,0 +1,191 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/pipeline.hxx>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Item
+{
+    int value = 0;
+    int result = 0;
+};
+
+// Keeps the maximum of a counter that is incremented and decremented by several threads.
+void track(std::atomic_int &maximum, const int &value)
+{
+    int current = maximum;
+    while (value > current && !maximum.compare_exchange_weak(current, value)) {}
+}
+
+TEST(Pipeline, SerialInOrderStageSeesTheOrderOfTheSource)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    ccol::thread::Pipeline<Item> pipeline(threadpool, 8);
+    int next = 0;
+    pipeline.setSource([&next](Item &item) {
+        if (next == 2000) return false;
+        item.value = next++;
+        return true;
+    });
+    pipeline.addStage(ccol::thread::StageMode::Parallel, [](Item &item) {
+        if (item.value % 7 == 0) std::this_thread::sleep_for(std::chrono::microseconds(50)); // let tokens overtake each other.
+        item.result = item.value * 2;
+    });
+    std::vector<int> results;
+    pipeline.addStage(ccol::thread::StageMode::SerialInOrder, [&results](Item &item) { results.push_back(item.result); });
+    pipeline.run();
+    ASSERT_EQ(2000, results.size());
+    for (int index = 0; index < 2000; index++) {
+        EXPECT_EQ(index * 2, results[index]);
+    }
+}
+
+TEST(Pipeline, TokensLimitTheItemsInFlight)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    ccol::thread::Pipeline<Item> pipeline(threadpool, 3);
+    std::atomic_int inFlight{0};
+    std::atomic_int maximum{0};
+    std::atomic_int produced{0};
+    pipeline.setSource([&](Item &) {
+        if (produced == 200) return false;
+        produced++;
+        track(maximum, ++inFlight);
+        return true;
+    });
+    pipeline.addStage(ccol::thread::StageMode::Parallel, [](Item &) { std::this_thread::sleep_for(std::chrono::microseconds(100)); });
+    pipeline.addStage(ccol::thread::StageMode::Parallel, [&inFlight](Item &) { inFlight--; });
+    pipeline.run();
+    EXPECT_EQ(200, produced);
+    EXPECT_EQ(0, inFlight);
+    EXPECT_GE(3, maximum);
+}
+
+TEST(Pipeline, SerialStageProcessesOneTokenAtATime)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    ccol::thread::Pipeline<Item> pipeline(threadpool, 16);
+    int next = 0;
+    pipeline.setSource([&next](Item &item) {
+        item.value = next++;
+        return next <= 500;
+    });
+    std::atomic_int running{0};
+    std::atomic_int maximum{0};
+    int sum = 0;
+    pipeline.addStage(ccol::thread::StageMode::Parallel, [](Item &) {});
+    pipeline.addStage(ccol::thread::StageMode::Serial, [&](Item &item) {
+        track(maximum, ++running);
+        sum += item.value;
+        running--;
+    });
+    pipeline.run();
+    EXPECT_EQ(1, maximum);
+    EXPECT_EQ(499 * 500 / 2, sum);
+}
+
+TEST(Pipeline, FullBuffersHoldBackTheSource)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    ccol::thread::Pipeline<Item> pipeline(threadpool, 100, 2);
+    std::atomic_int produced{0};
+    std::atomic_int consumed{0};
+    std::atomic_int ahead{0};
+    pipeline.setSource([&](Item &) {
+        if (produced == 100) return false;
+        track(ahead, ++produced - consumed);
+        return true;
+    });
+    pipeline.addStage(ccol::thread::StageMode::Parallel, [](Item &) {});
+    pipeline.addStage(ccol::thread::StageMode::Serial, [&consumed](Item &) {
+        consumed++;
+        std::this_thread::sleep_for(std::chrono::microseconds(200));
+    });
+    pipeline.run();
+    EXPECT_EQ(100, consumed);
+    // the source, two buffers of two tokens and the slow stage itself.
+    EXPECT_GE(6, ahead);
+}
+
+TEST(Pipeline, RunsAgain)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    ccol::thread::Pipeline<Item> pipeline(threadpool, 4);
+    int remaining = 0;
+    pipeline.setSource([&remaining](Item &item) {
+        item.value = remaining;
+        return remaining-- > 0;
+    });
+    std::vector<int> results;
+    pipeline.addStage(ccol::thread::StageMode::SerialInOrder, [&results](Item &item) { results.push_back(item.value); });
+    remaining = 3;
+    pipeline.run();
+    remaining = 2;
+    pipeline.run();
+    EXPECT_EQ((std::vector<int>{3,2,1,2,1}), results);
+}
+
+TEST(Pipeline, RunsFromAJobOfAHelpingPool)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.helpWhileWaiting = true;
+    ccol::thread::ThreadPool threadpool(options);
+    std::promise<int> done;
+    threadpool.enqueue([&threadpool,&done]{
+        ccol::thread::Pipeline<Item> pipeline(threadpool, 4);
+        int next = 0;
+        pipeline.setSource([&next](Item &item) {
+            item.value = ++next;
+            return next <= 100;
+        });
+        int sum = 0;
+        pipeline.addStage(ccol::thread::StageMode::Parallel, [](Item &item) { item.result = item.value; });
+        pipeline.addStage(ccol::thread::StageMode::SerialInOrder, [&sum](Item &item) { sum += item.result; });
+        pipeline.run();
+        done.set_value(sum);
+    });
+    EXPECT_EQ(5050, done.get_future().get());
+}
+
+}
@@ -0,0 +1,188 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/strand.hxx>
+#include <atomic>
+#include <future>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace {
+
+void blockWorker(ccol::thread::ThreadPool &threadpool, std::shared_future<void> released)
+{
+    std::promise<void> started;
+    threadpool.enqueue([&started, released]{ started.set_value(); released.wait(); });
+    started.get_future().wait();
+}
+
+TEST(Strand, RunsInOrderWithoutOverlap)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    ccol::thread::Strand strand(threadpool);
+    std::vector<int> order;
+    std::atomic_bool running{false};
+    std::atomic_int overlaps{0};
+    for (int i = 0; i < 10000; i++) {
+        strand.enqueue([&, i]{
+            if (running.exchange(true)) overlaps++;
+            order.push_back(i);
+            running = false;
+        });
+    }
+    strand.wait();
+    EXPECT_EQ(0, overlaps);
+    ASSERT_EQ(10000u, order.size());
+    for (int i = 0; i < 10000; i++) {
+        EXPECT_EQ(i, order[i]);
+    }
+    EXPECT_EQ(0u, strand.pendingCount());
+}
+
+TEST(Strand, KeepsOrderPerProducer)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    ccol::thread::Strand strand(threadpool, 16);
+    const int producers = 4;
+    std::vector<int> last(producers, -1);
+    std::atomic_int errors{0};
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p]{
+            for (int i = 0; i < 2000; i++) {
+                strand.enqueue([&, p, i]{
+                    if (last[p] != i - 1) errors++;
+                    last[p] = i;
+                });
+            }
+        });
+    }
+    for (auto &thread : threads) thread.join();
+    strand.wait();
+    EXPECT_EQ(0, errors);
+    for (int p = 0; p < producers; p++) {
+        EXPECT_EQ(1999, last[p]);
+    }
+}
+
+TEST(Strand, ManyStrandsShareAPool)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    std::vector<std::unique_ptr<ccol::thread::Strand>> strands;
+    std::vector<int> counts(10000, 0);
+    for (size_t s = 0; s < counts.size(); s++) {
+        strands.push_back(std::make_unique<ccol::thread::Strand>(threadpool));
+    }
+    for (int round = 0; round < 10; round++) {
+        for (size_t s = 0; s < counts.size(); s++) {
+            strands[s]->enqueue([&counts, s]{ counts[s]++; });
+        }
+    }
+    strands.clear(); // destruction waits for the jobs
+    for (auto count : counts) {
+        EXPECT_EQ(10, count);
+    }
+}
+
+TEST(Strand, EnqueueFromOwnJob)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    ccol::thread::Strand strand(threadpool);
+    std::vector<int> order;
+    strand.enqueue([&]{
+        order.push_back(1);
+        strand.enqueue([&]{ order.push_back(3); });
+        order.push_back(2); // the job enqueued above cannot start before this job returns
+    });
+    strand.wait();
+    EXPECT_EQ((std::vector<int>{1, 2, 3}), order);
+}
+
+TEST(Strand, BatchGivesWorkerBack)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    ccol::thread::Strand strand(threadpool, 1);
+    std::promise<void> release;
+    blockWorker(threadpool, release.get_future().share());
+    std::vector<char> order;
+    strand.enqueue([&order]{ order.push_back('a'); });
+    strand.enqueue([&order]{ order.push_back('b'); });
+    threadpool.enqueue([&order]{ order.push_back('c'); });
+    release.set_value();
+    strand.wait();
+    threadpool.wait();
+    EXPECT_EQ((std::vector<char>{'a', 'c', 'b'}), order);
+}
+
+TEST(Strand, DroppedTurnDiscardsJobs)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    ccol::thread::Strand strand(threadpool);
+    std::promise<void> release;
+    blockWorker(threadpool, release.get_future().share());
+    std::atomic_int count{0};
+    for (int i = 0; i < 3; i++) {
+        strand.enqueue([&count]{ count++; });
+    }
+    EXPECT_EQ(3u, strand.pendingCount());
+    threadpool.clear();
+    EXPECT_EQ(0u, strand.pendingCount());
+    release.set_value();
+    strand.enqueue([&count]{ count++; });
+    strand.wait();
+    EXPECT_EQ(1, count);
+}
+
+TEST(Strand, DroppedTurnDiscardsMoreThanABatch)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    ccol::thread::Strand strand(threadpool, 16);
+    std::promise<void> release;
+    blockWorker(threadpool, release.get_future().share());
+    std::atomic_int count{0};
+    for (int i = 0; i < 100; i++) {
+        strand.enqueue([&count]{ count++; });
+    }
+    threadpool.clear();
+    EXPECT_EQ(0u, strand.pendingCount());
+    EXPECT_EQ(1u, threadpool.totalJobCount());
+    release.set_value();
+    threadpool.wait();
+    EXPECT_EQ(0, count);
+}
+
+}
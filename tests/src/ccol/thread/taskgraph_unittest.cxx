@@ -0,0 +1,164 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/taskgraph.hxx>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <mutex>
+#include <vector>
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(TaskGraph, EmptyGraphRuns)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    ccol::thread::TaskGraph graph;
+    EXPECT_TRUE(graph.run(threadpool));
+    EXPECT_EQ(0,graph.nodeCount());
+}
+
+TEST(TaskGraph, RespectsDependencies)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    ccol::thread::TaskGraph graph;
+    std::atomic_int clock{0};
+    std::vector<int> finished(4, -1);
+    auto task = [&](int node) { return [&,node]{ finished[node] = clock++; }; };
+    auto load = graph.addNode(task(0));
+    auto left = graph.addNode(task(1));
+    auto right = graph.addNode(task(2));
+    auto merge = graph.addNode(task(3));
+    EXPECT_TRUE(graph.addEdge(load, left));
+    EXPECT_TRUE(graph.addEdge(load, right));
+    EXPECT_TRUE(graph.addEdge(left, merge));
+    EXPECT_TRUE(graph.addEdge(right, merge));
+    EXPECT_TRUE(graph.run(threadpool));
+    EXPECT_LT(finished[load],finished[left]);
+    EXPECT_LT(finished[load],finished[right]);
+    EXPECT_LT(finished[left],finished[merge]);
+    EXPECT_LT(finished[right],finished[merge]);
+}
+
+TEST(TaskGraph, RejectsInvalidEdges)
+{
+    ccol::thread::TaskGraph graph;
+    auto node = graph.addNode([]{});
+    EXPECT_FALSE(graph.addEdge(node, node));
+    EXPECT_FALSE(graph.addEdge(node, 5));
+    EXPECT_FALSE(graph.addEdge(5, node));
+}
+
+TEST(TaskGraph, RefusesToRunCycles)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    ccol::thread::TaskGraph graph;
+    auto first = graph.addNode([]{});
+    auto second = graph.addNode([]{});
+    auto third = graph.addNode([]{});
+    graph.addEdge(first, second);
+    graph.addEdge(second, third);
+    graph.addEdge(third, second);
+    EXPECT_FALSE(graph.run(threadpool));
+}
+
+TEST(TaskGraph, CanBeExecutedRepeatedly)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    ccol::thread::TaskGraph graph;
+    std::atomic_int count{0};
+    // a layered graph where every node depends on all nodes of the previous layer.
+    std::vector<ccol::thread::TaskGraph::NodeId> previous;
+    for (int layer=0; layer<10; layer++) {
+        std::vector<ccol::thread::TaskGraph::NodeId> current;
+        for (int width=0; width<20; width++) {
+            auto node = graph.addNode([&count]{ count++; });
+            for (auto dependency : previous) {
+                graph.addEdge(dependency, node);
+            }
+            current.push_back(node);
+        }
+        previous = current;
+    }
+    for (int run=0; run<50; run++) {
+        EXPECT_TRUE(graph.run(threadpool));
+        EXPECT_EQ(200*(run+1),count);
+    }
+}
+
+TEST(TaskGraph, StartReturnsImmediatelyAndCannotStartTwice)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPool threadpool(2);
+    ccol::thread::TaskGraph graph;
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    graph.addNode([opened]{ opened.wait(); });
+    EXPECT_TRUE(graph.start(threadpool));
+    EXPECT_FALSE(graph.start(threadpool));
+    EXPECT_FALSE(graph.wait_for(10ms));
+    gate.set_value();
+    graph.wait();
+    EXPECT_TRUE(graph.wait_for(0ms));
+}
+
+TEST(TaskGraph, RunsFromAJobOfAHelpingPool)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.helpWhileWaiting = true;
+    ccol::thread::ThreadPool threadpool(options);
+    std::atomic_int count{0};
+    std::promise<bool> result;
+    threadpool.enqueue([&]{
+        ccol::thread::TaskGraph graph;
+        auto first = graph.addNode([&count]{ count++; });
+        auto left = graph.addNode([&count]{ count++; });
+        auto right = graph.addNode([&count]{ count++; });
+        graph.addEdge(first, left);
+        graph.addEdge(first, right);
+        const bool ran = graph.run(threadpool); // the only worker runs the tasks while it waits.
+        EXPECT_TRUE(graph.start(threadpool));
+        EXPECT_TRUE(graph.wait_for(std::chrono::seconds(10)));
+        result.set_value(ran);
+    });
+    auto ran = result.get_future();
+    ASSERT_EQ(std::future_status::ready, ran.wait_for(std::chrono::seconds(10)));
+    EXPECT_TRUE(ran.get());
+    EXPECT_EQ(6, count);
+}
+
+}
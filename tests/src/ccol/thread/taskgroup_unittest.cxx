@@ -0,0 +1,132 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/taskgroup.hxx>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include "gtest/gtest.h"
+
+namespace {
+
+TEST(TaskGroup, WaitsOnlyForOwnJobs)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    threadpool.enqueue([released]{ released.wait(); });
+
+    ccol::thread::TaskGroup group(threadpool);
+    std::atomic_int count{0};
+    for (int i = 0; i < 100; i++) {
+        group.enqueue([&count]{ count++; });
+    }
+    group.wait();
+    EXPECT_EQ(100, count);
+    EXPECT_EQ(0, group.pendingCount());
+    EXPECT_LT(0, threadpool.totalJobCount()); // the unrelated job is still running
+    release.set_value();
+    threadpool.wait();
+}
+
+TEST(TaskGroup, WaitForTimesOut)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    ccol::thread::TaskGroup group(threadpool);
+    group.enqueue([released]{ released.wait(); });
+    EXPECT_FALSE(group.wait_for(std::chrono::milliseconds(10)));
+    EXPECT_EQ(1, group.pendingCount());
+    release.set_value();
+    EXPECT_TRUE(group.wait_for(std::chrono::seconds(10)));
+    EXPECT_EQ(0, group.pendingCount());
+}
+
+TEST(TaskGroup, GroupsShareAPool)
+{
+    ccol::thread::ThreadPool threadpool(4);
+    ccol::thread::TaskGroup first(threadpool);
+    ccol::thread::TaskGroup second(threadpool);
+    std::atomic_int firstCount{0};
+    std::atomic_int secondCount{0};
+    for (int i = 0; i < 1000; i++) {
+        first.enqueue([&firstCount]{ firstCount++; });
+        second.enqueue([&secondCount]{ secondCount++; });
+    }
+    first.wait();
+    EXPECT_EQ(1000, firstCount);
+    second.wait();
+    EXPECT_EQ(1000, secondCount);
+}
+
+TEST(TaskGroup, DroppedJobsCountAsFinished)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    std::promise<void> release;
+    std::shared_future<void> released = release.get_future().share();
+    std::promise<void> started;
+    threadpool.enqueue([&started, released]{ started.set_value(); released.wait(); });
+    started.get_future().wait();
+
+    ccol::thread::TaskGroup group(threadpool);
+    std::atomic_int count{0};
+    for (int i = 0; i < 3; i++) {
+        group.enqueue([&count]{ count++; });
+    }
+    EXPECT_EQ(3, group.pendingCount());
+    threadpool.clear();
+    EXPECT_TRUE(group.wait_for(std::chrono::seconds(10)));
+    EXPECT_EQ(0, count);
+    release.set_value();
+}
+
+TEST(TaskGroup, DestructorWaits)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::atomic_int count{0};
+    {
+        ccol::thread::TaskGroup group(threadpool);
+        for (int i = 0; i < 10; i++) {
+            group.enqueue([&count]{
+                std::this_thread::sleep_for(std::chrono::milliseconds(1));
+                count++;
+            });
+        }
+    }
+    EXPECT_EQ(10, count);
+}
+
+}
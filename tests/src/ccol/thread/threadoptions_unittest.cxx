@@ -0,0 +1,215 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/thread/threadoptions.hxx>
+#include <ccol/thread/threadpool.hxx>
+#include <ccol/thread/timer.hxx>
+#include <ccol/event/eventqueue.hxx>
+#include <algorithm>
+#include <fstream>
+#include <future>
+#include <string>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+#ifdef __linux__
+#include <dirent.h>
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace {
+
+#ifdef __linux__
+// The name, CPU count and policy of the calling thread.
+struct ThreadState
+{
+    std::string name;
+    int cpus = 0;
+    int policy = -1;
+    size_t stackSize = 0;
+};
+
+ThreadState currentThreadState()
+{
+    ThreadState state;
+    char name[16] = {};
+    pthread_getname_np(pthread_self(), name, sizeof(name));
+    state.name = name;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    pthread_getaffinity_np(pthread_self(), sizeof(set), &set);
+    state.cpus = CPU_COUNT(&set);
+    sched_param parameters;
+    pthread_getschedparam(pthread_self(), &state.policy, &parameters);
+    pthread_attr_t attributes;
+    if (pthread_getattr_np(pthread_self(), &attributes) == 0) {
+        pthread_attr_getstacksize(&attributes, &state.stackSize);
+        pthread_attr_destroy(&attributes);
+    }
+    return state;
+}
+
+// The names of all threads of the process.
+std::vector<std::string> threadNames()
+{
+    std::vector<std::string> names;
+    DIR *tasks = opendir("/proc/self/task");
+    if (tasks == nullptr) return names;
+    while (dirent *task = readdir(tasks)) {
+        std::ifstream comm(std::string("/proc/self/task/") + task->d_name + "/comm");
+        std::string name;
+        if (std::getline(comm, name)) names.push_back(name);
+    }
+    closedir(tasks);
+    return names;
+}
+
+ccol::thread::ThreadOptions testOptions(const std::string &name)
+{
+    ccol::thread::ThreadOptions options;
+    options.cpuSets = {{0}};
+    options.policy = ccol::thread::SchedulingPolicy::Batch; // lowering the priority needs no permission.
+    options.stackSize = 16 * 1024 * 1024;
+    options.name = name;
+    return options;
+}
+
+TEST(ThreadOptions, WorkersApplyOptionsBeforeTheirFirstJob)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 2;
+    options.threadOptions = testOptions("worker");
+    ccol::thread::ThreadPool threadpool(options);
+    std::promise<ThreadState> state;
+    threadpool.enqueue([&state]{ state.set_value(currentThreadState()); });
+    const ThreadState worker = state.get_future().get();
+    EXPECT_TRUE(worker.name == "worker0" || worker.name == "worker1");
+    EXPECT_EQ(1, worker.cpus);
+    EXPECT_EQ(SCHED_BATCH, worker.policy);
+    EXPECT_GE(worker.stackSize, 16u * 1024 * 1024);
+}
+
+TEST(ThreadOptions, TimerThreadOfAPoolIsNumberedAfterTheWorkers)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.threadOptions = testOptions("pool");
+    ccol::thread::ThreadPool threadpool(options);
+    auto job = threadpool.enqueueAfter(std::chrono::hours(1), []{}); // starts the timer thread.
+    bool found = false;
+    for (int attempt = 0; attempt < 500 && !found; attempt++) {
+        const auto names = threadNames();
+        found = std::find(names.begin(), names.end(), "pool1") != names.end();
+        if (!found) std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    EXPECT_TRUE(found);
+    job.cancel();
+}
+
+TEST(ThreadOptions, TimerAppliesOptions)
+{
+    ccol::thread::Timer timer(testOptions("timer"));
+    std::promise<ThreadState> state;
+    timer.setCallback([&state]{ state.set_value(currentThreadState()); });
+    timer.startSingleshot(std::chrono::milliseconds(1));
+    const ThreadState thread = state.get_future().get();
+    EXPECT_EQ("timer", thread.name);
+    EXPECT_EQ(SCHED_BATCH, thread.policy);
+    EXPECT_GE(thread.stackSize, 16u * 1024 * 1024);
+}
+
+TEST(ThreadOptions, CreateThreadDrivesAnEventQueue)
+{
+    ccol::event::EventQueue queue;
+    std::promise<ThreadState> state;
+    queue.post([](void *context) {
+        static_cast<std::promise<ThreadState>*>(context)->set_value(currentThreadState());
+    }, &state);
+    std::thread loop = ccol::thread::createThread(testOptions("events-with-a-long-name"), [&queue]{ queue.run(); });
+    const ThreadState thread = state.get_future().get();
+    queue.stop();
+    loop.join();
+    EXPECT_EQ("events-with-a-l", thread.name);
+    EXPECT_EQ(1, thread.cpus);
+    EXPECT_GE(thread.stackSize, 16u * 1024 * 1024);
+}
+
+#ifdef __GLIBC__
+TEST(ThreadOptions, CreateThreadRestoresTheDefaultStackSize)
+{
+    const auto defaultStackSize = []{
+        size_t stackSize = 0;
+        pthread_attr_t attributes;
+        if (pthread_getattr_default_np(&attributes) == 0) {
+            pthread_attr_getstacksize(&attributes, &stackSize);
+            pthread_attr_destroy(&attributes);
+        }
+        return stackSize;
+    };
+    const size_t before = defaultStackSize();
+    std::thread thread = ccol::thread::createThread(testOptions("stack"), []{});
+    thread.join();
+    EXPECT_EQ(before, defaultStackSize());
+}
+#endif
+
+TEST(ThreadOptions, EventQueueRunAppliesOptionsToTheCallingThread)
+{
+    ccol::event::EventQueue queue;
+    std::promise<ThreadState> state;
+    queue.post([](void *context) {
+        static_cast<std::promise<ThreadState>*>(context)->set_value(currentThreadState());
+    }, &state);
+    std::thread loop([&queue]{ queue.run(testOptions("loop")); });
+    const ThreadState thread = state.get_future().get();
+    queue.stop();
+    loop.join();
+    EXPECT_EQ("loop", thread.name);
+    EXPECT_EQ(SCHED_BATCH, thread.policy);
+}
+
+TEST(ThreadOptions, RefusedSettingsAreReported)
+{
+    ccol::thread::ThreadOptions options;
+    options.cpuSets = {{CPU_SETSIZE + 1u}}; // no CPU the thread could run on.
+    std::promise<bool> applied;
+    std::thread thread([&]{ applied.set_value(ccol::thread::applyThreadOptions(options)); });
+    EXPECT_FALSE(applied.get_future().get());
+    thread.join();
+}
+#endif
+
+}
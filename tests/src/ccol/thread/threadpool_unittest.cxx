@@ -34,12 +34,19 @@ If you'd like to modify and/or share this code, share it under the same license,
 If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
 */
 #include <ccol/thread/threadpool.hxx>
+#include <ccol/thread/taskgroup.hxx>
+#include <ccol/util/cancellationtokensource.hxx>
 #include <mutex>
 #include <atomic>
 #include <condition_variable>
 #include <chrono>
 #include <vector>
 #include <queue>
+#include <future>
+#include <memory>
+#include <algorithm>
+#include <string>
+#include <thread>
 #include "gtest/gtest.h"
 
 namespace {
@@ -194,7 +201,7 @@ TEST(ThreadPool, ExecutedFourOfFourThreadsWithDequeInBetween)
 
     ThreadPoolTestContext tptc;
     ccol::thread::ThreadPool threadpool(2);
-    std::queue<std::function<void()>> jobs;
+    std::queue<ccol::thread::Job> jobs;
     {
         std::unique_lock<std::mutex> lk2(tptc.waitTerminateMutex);
         threadpool.enqueue(tptc.job);
@@ -208,7 +215,7 @@ TEST(ThreadPool, ExecutedFourOfFourThreadsWithDequeInBetween)
         EXPECT_EQ(0,threadpool.queueCount());
         EXPECT_TRUE(tptc.cv2.wait_for(lk2, 200ms, [&tptc]{ return tptc.endCount==2; }));
         EXPECT_EQ(2,tptc.endCount);
-        threadpool.enqueue(jobs);
+        threadpool.enqueue(std::move(jobs));
         EXPECT_TRUE(tptc.cv.wait_for(tptc.syncLock, 200ms, [&tptc]{ return tptc.middleCount==4; }));
         EXPECT_TRUE(tptc.cv2.wait_for(lk2, 200ms, [&tptc]{ return tptc.endCount==4; }));
     }
@@ -308,6 +315,1186 @@ TEST(ThreadPool, WaitForReturnsBeforeJobsHaveBeenProcessed)
     EXPECT_NE(0,threadpool.totalJobCount());
 }
 
+TEST(ThreadPool, ExecutesMoveOnlyJobs)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::promise<int> promise;
+    std::future<int> future = promise.get_future();
+    auto value = std::make_unique<int>(42);
+    threadpool.enqueue([promise = std::move(promise), value = std::move(value)]() mutable {
+        promise.set_value(*value);
+    });
+    EXPECT_EQ(42,future.get());
+}
+
+TEST(ThreadPool, ExecutesJobsFromJobVectorAndQueue)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    std::atomic_int count{0};
+    std::vector<ccol::thread::Job> vector;
+    std::queue<ccol::thread::Job> queue;
+    for (int counter=0; counter<10; counter++) {
+        vector.emplace_back([&count, value = std::make_unique<int>(1)]{ count += *value; });
+        queue.emplace([&count, value = std::make_unique<int>(2)]{ count += *value; });
+    }
+    threadpool.enqueue(std::move(vector));
+    threadpool.enqueue(std::move(queue));
+    threadpool.wait();
+    EXPECT_EQ(30,count);
+}
+
+TEST(ThreadPool, HighPriorityJobsRunBeforeLowerPriorityJobs)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.agingInterval = 1h;
+    ccol::thread::ThreadPool threadpool(options);
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    threadpool.enqueue([opened]{ opened.wait(); });
+    std::vector<int> order;
+    threadpool.enqueue(ccol::thread::Priority::Low, [&order]{ order.push_back(3); });
+    threadpool.enqueue([&order]{ order.push_back(2); });
+    threadpool.enqueue(ccol::thread::Priority::High, [&order]{ order.push_back(1); });
+    gate.set_value();
+    threadpool.wait();
+    EXPECT_EQ((std::vector<int>{1,2,3}),order);
+}
+
+TEST(ThreadPool, WaitingLowPriorityJobsAge)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.agingInterval = 1ms;
+    ccol::thread::ThreadPool threadpool(options);
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    threadpool.enqueue([opened]{ opened.wait(); });
+    std::vector<int> order;
+    threadpool.enqueue(ccol::thread::Priority::Low, [&order]{ order.push_back(1); });
+    std::this_thread::sleep_for(10ms);
+    threadpool.enqueue(ccol::thread::Priority::High, [&order]{ order.push_back(2); });
+    gate.set_value();
+    threadpool.wait();
+    EXPECT_EQ((std::vector<int>{1,2}),order);
+}
+
+TEST(ThreadPool, TenantsShareThePoolByWeight)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    threadpool.setTenantWeight(1,3);
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    threadpool.enqueue([opened]{ opened.wait(); });
+    std::vector<int> order;
+    std::vector<ccol::thread::Job> first;
+    std::vector<ccol::thread::Job> second;
+    for (int counter=0; counter<40; counter++) {
+        first.emplace_back([&order]{ order.push_back(1); });
+        second.emplace_back([&order]{ order.push_back(2); });
+    }
+    threadpool.enqueue(ccol::thread::Priority::Normal, 1, std::move(first));
+    threadpool.enqueue(ccol::thread::Priority::Normal, 2, std::move(second));
+    gate.set_value();
+    threadpool.wait();
+    ASSERT_EQ(80,order.size());
+    const auto firstCount = std::count(order.begin(), order.begin()+40, 1);
+    EXPECT_GE(firstCount,29);
+    EXPECT_LE(firstCount,31);
+}
+
+TEST(ThreadPool, LargeTenantWeightsAreCapped)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    threadpool.setTenantWeight(1,4000000000u);
+    threadpool.setTenantWeight(2,1u << 21);
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    threadpool.enqueue([opened]{ opened.wait(); });
+    std::vector<int> order;
+    std::vector<ccol::thread::Job> first;
+    std::vector<ccol::thread::Job> second;
+    for (int counter=0; counter<40; counter++) {
+        first.emplace_back([&order]{ order.push_back(1); });
+        second.emplace_back([&order]{ order.push_back(2); });
+    }
+    threadpool.enqueue(ccol::thread::Priority::Normal, 1, std::move(first));
+    threadpool.enqueue(ccol::thread::Priority::Normal, 2, std::move(second));
+    gate.set_value();
+    threadpool.wait();
+    ASSERT_EQ(80,order.size());
+    const auto firstCount = std::count(order.begin(), order.begin()+40, 1);
+    EXPECT_GE(firstCount,19);
+    EXPECT_LE(firstCount,21);
+}
+
+TEST(ThreadPool, EphemeralTenantsKeepTheWeights)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    threadpool.setTenantWeight(1,3);
+    std::atomic_int executed{0};
+    for (ccol::thread::TenantId tenant=1000; tenant<11000; tenant++) {
+        threadpool.enqueue(ccol::thread::Priority::Normal, tenant, [&executed]{ executed++; });
+    }
+    threadpool.wait();
+    EXPECT_EQ(10000,executed);
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    threadpool.enqueue([opened]{ opened.wait(); });
+    std::vector<int> order;
+    for (int counter=0; counter<40; counter++) {
+        threadpool.enqueue(ccol::thread::Priority::Normal, 1, [&order]{ order.push_back(1); });
+        threadpool.enqueue(ccol::thread::Priority::Normal, 2, [&order]{ order.push_back(2); });
+    }
+    gate.set_value();
+    threadpool.wait();
+    ASSERT_EQ(80,order.size());
+    const auto firstCount = std::count(order.begin(), order.begin()+40, 1);
+    EXPECT_GE(firstCount,29);
+    EXPECT_LE(firstCount,31);
+}
+
+TEST(ThreadPool, DequeueAllReturnsJobsInPriorityOrder)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.agingInterval = 1h;
+    ccol::thread::ThreadPool threadpool(options);
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::promise<void> started;
+    threadpool.enqueue([opened,&started]{ started.set_value(); opened.wait(); });
+    started.get_future().wait();
+    std::vector<int> order;
+    threadpool.enqueue(ccol::thread::Priority::Low, [&order]{ order.push_back(2); });
+    threadpool.enqueue(ccol::thread::Priority::High, [&order]{ order.push_back(1); });
+    auto jobs = threadpool.dequeueAll();
+    EXPECT_EQ(0,threadpool.queueCount());
+    gate.set_value();
+    threadpool.wait();
+    while (!jobs.empty()) {
+        jobs.front()();
+        jobs.pop();
+    }
+    EXPECT_EQ((std::vector<int>{1,2}),order);
+}
+
+TEST(ThreadPool, ElasticStartsMinThreads)
+{
+    std::atomic_int count{0};
+    ccol::thread::ThreadPoolOptions options;
+    options.minThreads = 1;
+    options.maxThreads = 4;
+    options.threadCreateCallback = [&count](std::thread&){
+        count++;
+    };
+    ccol::thread::ThreadPool threadpool(options);
+    EXPECT_EQ(1,threadpool.threadCount());
+    EXPECT_EQ(4,threadpool.maxThreadCount());
+    EXPECT_EQ(1,count);
+}
+
+TEST(ThreadPool, ElasticGrowsWithBacklogUpToMaxThreads)
+{
+    using namespace std::literals::chrono_literals;
+    std::atomic_int created{0};
+    ccol::thread::ThreadPoolOptions options;
+    options.maxThreads = 3;
+    options.threadCreateCallback = [&created](std::thread&){
+        created++;
+    };
+    ccol::thread::ThreadPool threadpool(options);
+    EXPECT_EQ(0,threadpool.threadCount());
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::mutex mutex;
+    std::condition_variable cv;
+    int started = 0;
+    for (int counter=0; counter<6; counter++) {
+        threadpool.enqueue([&,opened]{
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                started++;
+                cv.notify_all();
+            }
+            opened.wait();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        EXPECT_TRUE(cv.wait_for(lock, 1s, [&started]{ return started==3; }));
+    }
+    EXPECT_EQ(3,threadpool.threadCount());
+    EXPECT_EQ(3,created);
+    EXPECT_EQ(3,threadpool.queueCount());
+    gate.set_value();
+    threadpool.wait();
+    EXPECT_EQ(6,started);
+    EXPECT_EQ(3,created);
+}
+
+TEST(ThreadPool, ElasticStopsIdleThreadsDownToMinThreads)
+{
+    using namespace std::literals::chrono_literals;
+    std::atomic_int created{0};
+    ccol::thread::ThreadPoolOptions options;
+    options.minThreads = 1;
+    options.maxThreads = 4;
+    options.idleTimeout = 10ms;
+    options.threadCreateCallback = [&created](std::thread&){
+        created++;
+    };
+    ccol::thread::ThreadPool threadpool(options);
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    for (int counter=0; counter<4; counter++) {
+        threadpool.enqueue([opened]{ opened.wait(); });
+    }
+    EXPECT_EQ(4,threadpool.threadCount());
+    gate.set_value();
+    threadpool.wait();
+    const auto deadline = std::chrono::steady_clock::now() + 2s;
+    while (threadpool.threadCount() > 1 && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_EQ(1,threadpool.threadCount());
+    std::atomic_int count{0};
+    for (int counter=0; counter<100; counter++) {
+        threadpool.enqueue([&count]{ count++; });
+    }
+    threadpool.wait();
+    EXPECT_EQ(100,count);
+    EXPECT_GE(created,4);
+}
+
+TEST(ThreadPool, ElasticWorkStealingExecutesAllJobs)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPoolOptions options;
+    options.maxThreads = 4;
+    options.idleTimeout = 1ms;
+    options.scheduling = ccol::thread::Scheduling::WorkStealing;
+    ccol::thread::ThreadPool threadpool(options);
+    std::atomic_int count{0};
+    for (int round=0; round<20; round++) {
+        for (int counter=0; counter<100; counter++) {
+            threadpool.enqueue([&count]{ count++; });
+        }
+        std::this_thread::sleep_for(1ms);
+    }
+    threadpool.wait();
+    EXPECT_EQ(2000,count);
+    EXPECT_LE(threadpool.threadCount(),4);
+}
+
+TEST(ThreadPool, NumaExecutesAllJobs)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 4;
+    options.scheduling = ccol::thread::Scheduling::Numa;
+    ccol::thread::ThreadPool threadpool(options);
+    EXPECT_EQ(4,threadpool.threadCount());
+    EXPECT_GE(threadpool.nodeCount(),1);
+    std::atomic_int count{0};
+    std::vector<ccol::thread::Job> jobs;
+    for (int counter=0; counter<1000; counter++) {
+        threadpool.enqueue([&count]{ count++; });
+        jobs.emplace_back([&count]{ count++; });
+    }
+    threadpool.enqueue(std::move(jobs));
+    threadpool.wait();
+    EXPECT_EQ(2000,count);
+    EXPECT_EQ(0,threadpool.queueCount());
+}
+
+TEST(ThreadPool, NumaExecutesJobsEnqueuedOnEveryNode)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 2;
+    options.scheduling = ccol::thread::Scheduling::Numa;
+    ccol::thread::ThreadPool threadpool(options);
+    std::atomic_int count{0};
+    for (unsigned int node=0; node<=threadpool.nodeCount(); node++) { // includes one node out of range.
+        threadpool.enqueueOnNode(node, [&count]{ count++; });
+        std::vector<ccol::thread::Job> jobs;
+        jobs.emplace_back([&count]{ count++; });
+        jobs.emplace_back([&count]{ count++; });
+        threadpool.enqueueOnNode(node, std::move(jobs));
+    }
+    threadpool.wait();
+    EXPECT_EQ(3*(threadpool.nodeCount()+1),count);
+}
+
+TEST(ThreadPool, NodeCountIsOneWithoutNumaScheduling)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    EXPECT_EQ(1,threadpool.nodeCount());
+    std::promise<void> done;
+    threadpool.enqueueOnNode(5, [&done]{ done.set_value(); });
+    done.get_future().wait();
+}
+
+TEST(ThreadPool, IdleStrategiesExecuteAllJobs)
+{
+    for (auto strategy : {ccol::thread::IdleStrategy::Park, ccol::thread::IdleStrategy::SpinThenPark, ccol::thread::IdleStrategy::BusySpin}) {
+        ccol::thread::ThreadPoolOptions options;
+        options.threads = 4;
+        options.idleStrategy = strategy;
+        options.spinCount = 100;
+        ccol::thread::ThreadPool threadpool(options);
+        std::atomic_int count{0};
+        for (int round=0; round<10; round++) {
+            std::vector<ccol::thread::Job> jobs;
+            for (int counter=0; counter<100; counter++) {
+                jobs.emplace_back([&count]{ count++; });
+            }
+            threadpool.enqueue(std::move(jobs));
+            threadpool.enqueue([&threadpool,&count]{
+                threadpool.enqueue([&count]{ count++; });
+            });
+            threadpool.wait();
+        }
+        EXPECT_EQ(1010,count);
+    }
+}
+
+TEST(ThreadPool, MetricsAreEmptyUnlessEnabled)
+{
+    ccol::thread::ThreadPool threadpool(2);
+    threadpool.enqueue([]{});
+    threadpool.wait();
+    auto metrics = threadpool.metrics();
+    EXPECT_TRUE(metrics.workers.empty());
+    EXPECT_EQ(2,metrics.threads);
+    EXPECT_EQ(0,metrics.total);
+}
+
+TEST(ThreadPool, MetricsCountJobsAndDurations)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 2;
+    options.metrics = true;
+    ccol::thread::ThreadPool threadpool(options);
+    for (int counter=0; counter<10; counter++) {
+        threadpool.enqueue([]{ std::this_thread::sleep_for(1ms); });
+    }
+    std::vector<ccol::thread::Job> jobs;
+    for (int counter=0; counter<90; counter++) {
+        jobs.emplace_back([]{});
+    }
+    threadpool.enqueue(std::move(jobs));
+    threadpool.wait();
+    auto metrics = threadpool.metrics();
+    ASSERT_EQ(2,metrics.workers.size());
+    auto all = metrics.combined();
+    EXPECT_EQ(100,all.jobsExecuted);
+    EXPECT_EQ(100,all.runTime.count());
+    EXPECT_EQ(100,all.queueWaitTime.count());
+    EXPECT_GE(all.busyTime,10ms);
+    EXPECT_GE(all.runTime.percentile(100),1ms);
+    EXPECT_GT(metrics.utilization(),0.0);
+    EXPECT_LE(metrics.utilization(),1.0);
+}
+
+TEST(ThreadPool, MetricsSnapshotsAreConsistentWhileRunning)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 2;
+    options.metrics = true;
+    ccol::thread::ThreadPool threadpool(options);
+    for (int counter=0; counter<20000; counter++) {
+        threadpool.enqueue([]{});
+    }
+    std::uint64_t previous = 0;
+    while (threadpool.totalJobCount() > 0) {
+        auto metrics = threadpool.metrics();
+        for (auto &worker : metrics.workers) {
+            EXPECT_EQ(worker.jobsExecuted,worker.runTime.count());
+            EXPECT_EQ(worker.jobsExecuted,worker.queueWaitTime.count());
+        }
+        auto executed = metrics.combined().jobsExecuted;
+        EXPECT_GE(executed,previous);
+        previous = executed;
+    }
+    threadpool.wait();
+}
+
+TEST(ThreadPool, DurationHistogramBuckets)
+{
+    using Histogram = ccol::thread::DurationHistogram;
+    EXPECT_EQ(0,Histogram::bucketOf(std::chrono::nanoseconds(0)));
+    EXPECT_EQ(1,Histogram::bucketOf(std::chrono::nanoseconds(1)));
+    EXPECT_EQ(2,Histogram::bucketOf(std::chrono::nanoseconds(3)));
+    EXPECT_EQ(11,Histogram::bucketOf(std::chrono::nanoseconds(1024)));
+    EXPECT_EQ(63,Histogram::bucketOf(std::chrono::nanoseconds::max()));
+    Histogram histogram;
+    histogram.buckets[Histogram::bucketOf(std::chrono::nanoseconds(100))] = 99;
+    histogram.buckets[Histogram::bucketOf(std::chrono::nanoseconds(5000))] = 1;
+    EXPECT_EQ(100,histogram.count());
+    EXPECT_EQ(std::chrono::nanoseconds(128),histogram.percentile(50));
+    EXPECT_EQ(std::chrono::nanoseconds(8192),histogram.percentile(100));
+}
+
+ccol::thread::ThreadPoolOptions boundedOptions(const size_t &capacity, const ccol::thread::Overflow &overflow)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.scheduling = ccol::thread::Scheduling::Bounded;
+    options.queueCapacity = capacity;
+    options.overflow = overflow;
+    return options;
+}
+
+// Occupies the only worker of a pool until the gate opens.
+void blockWorker(ccol::thread::ThreadPool &threadpool, std::shared_future<void> opened)
+{
+    std::promise<void> started;
+    threadpool.enqueue([opened,&started]{ started.set_value(); opened.wait(); });
+    started.get_future().wait();
+}
+
+TEST(ThreadPool, SkipsJobsOfCancelledTokens)
+{
+    for (auto scheduling : {ccol::thread::Scheduling::SharedQueue, ccol::thread::Scheduling::WorkStealing, ccol::thread::Scheduling::Bounded}) {
+        ccol::thread::ThreadPoolOptions options;
+        options.threads = 1;
+        options.scheduling = scheduling;
+        ccol::thread::ThreadPool threadpool(options);
+        ccol::util::CancellationTokenSource cancelled;
+        ccol::util::CancellationTokenSource active;
+        std::promise<void> gate;
+        std::shared_future<void> opened = gate.get_future().share();
+        threadpool.enqueue([opened]{ opened.wait(); });
+        std::atomic_int count{0};
+        for (int counter=0; counter<10; counter++) {
+            threadpool.enqueue(cancelled.token(), [&count]{ count += 100; });
+            threadpool.enqueue(active.token(), [&count]{ count++; });
+        }
+        cancelled.cancel();
+        gate.set_value();
+        threadpool.wait();
+        EXPECT_EQ(10,count);
+        EXPECT_EQ(0,threadpool.totalJobCount());
+    }
+}
+
+TEST(ThreadPool, PurgeCancelledRemovesOnlyCancelledJobs)
+{
+    for (auto scheduling : {ccol::thread::Scheduling::SharedQueue, ccol::thread::Scheduling::WorkStealing, ccol::thread::Scheduling::Numa, ccol::thread::Scheduling::Deadline}) {
+        ccol::thread::ThreadPoolOptions options;
+        options.threads = 1;
+        options.scheduling = scheduling;
+        ccol::thread::ThreadPool threadpool(options);
+        ccol::util::CancellationTokenSource cancelled;
+        ccol::util::CancellationTokenSource active;
+        std::promise<void> gate;
+        blockWorker(threadpool, gate.get_future().share());
+        std::atomic_int count{0};
+        std::vector<ccol::thread::Job> jobs;
+        for (int counter=0; counter<10; counter++) {
+            jobs.emplace_back([&count]{ count += 100; });
+            threadpool.enqueue(active.token(), [&count]{ count++; });
+        }
+        threadpool.enqueue(cancelled.token(), std::move(jobs));
+        threadpool.enqueue([&count]{ count++; });
+        EXPECT_EQ(21,threadpool.queueCount());
+        EXPECT_EQ(0,threadpool.purgeCancelled());
+        cancelled.cancel();
+        EXPECT_EQ(10,threadpool.purgeCancelled());
+        EXPECT_EQ(11,threadpool.queueCount());
+        EXPECT_EQ(12,threadpool.totalJobCount());
+        gate.set_value();
+        threadpool.wait();
+        EXPECT_EQ(11,count);
+    }
+}
+
+TEST(ThreadPool, DeadlineRunsEarliestDeadlineFirst)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.scheduling = ccol::thread::Scheduling::Deadline;
+    ccol::thread::ThreadPool threadpool(options);
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    std::vector<int> order;
+    const auto now = std::chrono::steady_clock::now();
+    threadpool.enqueue([&order]{ order.push_back(0); });
+    threadpool.enqueue(now + 30s, [&order]{ order.push_back(3); });
+    threadpool.enqueue(now + 10s, [&order]{ order.push_back(1); });
+    threadpool.enqueue(now + 20s, [&order]{ order.push_back(2); });
+    threadpool.enqueue(now + 10s, [&order]{ order.push_back(11); });
+    EXPECT_EQ(5,threadpool.queueCount());
+    gate.set_value();
+    threadpool.wait();
+    EXPECT_EQ((std::vector<int>{1,11,2,3,0}),order);
+    EXPECT_EQ(0,threadpool.metrics().deadlineMisses);
+}
+
+TEST(ThreadPool, DropsJobsWhoseDeadlinePassed)
+{
+    using namespace std::literals::chrono_literals;
+    for (auto scheduling : {ccol::thread::Scheduling::SharedQueue, ccol::thread::Scheduling::Deadline, ccol::thread::Scheduling::Bounded}) {
+        ccol::thread::ThreadPoolOptions options;
+        options.threads = 1;
+        options.scheduling = scheduling;
+        ccol::thread::ThreadPool threadpool(options);
+        std::promise<void> gate;
+        blockWorker(threadpool, gate.get_future().share());
+        std::atomic_int count{0};
+        const auto now = std::chrono::steady_clock::now();
+        for (int counter=0; counter<5; counter++) {
+            threadpool.enqueue(now + 1ms, [&count]{ count += 100; });
+            threadpool.enqueue(now + 60s, [&count]{ count++; });
+        }
+        std::this_thread::sleep_for(5ms);
+        gate.set_value();
+        threadpool.wait();
+        EXPECT_EQ(5,count);
+        EXPECT_EQ(5,threadpool.metrics().deadlineMisses);
+        EXPECT_EQ(0,threadpool.totalJobCount());
+    }
+}
+
+TEST(ThreadPool, DeadlineMissedCallbackReceivesExpiredJobs)
+{
+    using namespace std::literals::chrono_literals;
+    std::atomic_int missed{0};
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.scheduling = ccol::thread::Scheduling::Deadline;
+    options.deadlineMissedCallback = [&missed](ccol::thread::Job &&job) { missed++; job(); };
+    ccol::thread::ThreadPool threadpool(options);
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    std::atomic_int count{0};
+    threadpool.enqueue(std::chrono::steady_clock::now(), [&count]{ count += 10; });
+    threadpool.enqueue(std::chrono::steady_clock::now() + 60s, [&count]{ count++; });
+    std::this_thread::sleep_for(1ms);
+    gate.set_value();
+    threadpool.wait();
+    EXPECT_EQ(1,missed);
+    EXPECT_EQ(11,count);
+    EXPECT_EQ(1,threadpool.metrics().deadlineMisses);
+}
+
+TEST(ThreadPool, EnqueueAfterRunsOnceTheDelayPassed)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPool threadpool(2);
+    std::promise<std::chrono::steady_clock::time_point> ran;
+    const auto start = std::chrono::steady_clock::now();
+    auto scheduled = threadpool.enqueueAfter(20ms, [&ran]{ ran.set_value(std::chrono::steady_clock::now()); });
+    EXPECT_TRUE(scheduled.isPending());
+    EXPECT_EQ(1,threadpool.scheduledCount());
+    EXPECT_EQ(0,threadpool.totalJobCount());
+    EXPECT_GE(ran.get_future().get() - start, 20ms);
+    EXPECT_FALSE(scheduled.isPending());
+    EXPECT_FALSE(scheduled.cancel());
+    EXPECT_EQ(0,threadpool.scheduledCount());
+}
+
+TEST(ThreadPool, EnqueueAtRunsJobsInTheOrderOfTheirTime)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPool threadpool(1);
+    std::vector<int> order;
+    std::promise<void> done;
+    const auto now = std::chrono::steady_clock::now();
+    threadpool.enqueueAt(now + 30ms, [&order,&done]{ order.push_back(3); done.set_value(); });
+    threadpool.enqueueAt(now + 10ms, [&order]{ order.push_back(1); });
+    threadpool.enqueueAt(now + 20ms, [&order]{ order.push_back(2); });
+    threadpool.enqueueAt(now - 10ms, [&order]{ order.push_back(0); });
+    done.get_future().wait();
+    EXPECT_EQ((std::vector<int>{0,1,2,3}),order);
+}
+
+TEST(ThreadPool, CancelledScheduledJobIsReleased)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPool threadpool(1);
+    auto resource = std::make_shared<int>(42);
+    auto scheduled = threadpool.enqueueAfter(1h, [resource]{});
+    auto copy = scheduled;
+    EXPECT_EQ(2,resource.use_count());
+    EXPECT_TRUE(copy.cancel());
+    EXPECT_FALSE(scheduled.cancel());
+    EXPECT_FALSE(scheduled.isPending());
+    EXPECT_EQ(1,resource.use_count());
+    EXPECT_EQ(0,threadpool.scheduledCount());
+}
+
+TEST(ThreadPool, EnqueueEveryRepeatsUntilCancelled)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPool threadpool(2);
+    std::atomic_int count{0};
+    std::atomic_int running{0};
+    std::atomic_int overlapping{0};
+    auto scheduled = threadpool.enqueueEvery(1ms, [&]{
+        if (running++ > 0) overlapping++;
+        count++;
+        std::this_thread::sleep_for(3ms);
+        running--;
+    });
+    while (count < 5) {
+        std::this_thread::sleep_for(1ms);
+    }
+    EXPECT_TRUE(scheduled.cancel());
+    threadpool.wait();
+    const int stopped = count;
+    std::this_thread::sleep_for(20ms);
+    threadpool.wait();
+    EXPECT_EQ(stopped,count);
+    EXPECT_EQ(0,overlapping);
+    EXPECT_EQ(0,threadpool.scheduledCount());
+}
+
+TEST(ThreadPool, ManyScheduledJobsShareOneTimer)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPool threadpool(2);
+    constexpr int jobs = 10000;
+    std::atomic_int count{0};
+    std::promise<void> done;
+    std::vector<ccol::thread::ScheduledJob> scheduled;
+    for (int counter=0; counter<jobs; counter++) {
+        scheduled.push_back(threadpool.enqueueAfter(100ms + std::chrono::microseconds(counter % 1000), [&count,&done]{
+            if (++count == jobs / 2) done.set_value();
+        }));
+    }
+    for (int counter=1; counter<jobs; counter+=2) {
+        scheduled[counter].cancel();
+    }
+    done.get_future().wait();
+    threadpool.wait();
+    EXPECT_EQ(0,threadpool.scheduledCount());
+    EXPECT_EQ(jobs / 2,count);
+}
+
+ccol::thread::ThreadPoolOptions affinityOptions(const unsigned int &threads, const size_t &skew)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = threads;
+    options.affinitySkew = skew;
+    return options;
+}
+
+TEST(ThreadPool, KeyedJobsStayOnOneWorkerInOrder)
+{
+    ccol::thread::ThreadPool threadpool(affinityOptions(4, 1000000));
+    const int keys = 16;
+    std::vector<std::vector<int>> order(keys);
+    std::vector<std::vector<std::thread::id>> workers(keys);
+    for (int counter=0; counter<200; counter++) {
+        for (int key=0; key<keys; key++) {
+            threadpool.enqueue(ccol::thread::AffinityKey{std::uint64_t(key)}, [&order, &workers, key, counter]{
+                order[key].push_back(counter);
+                workers[key].push_back(std::this_thread::get_id());
+            });
+        }
+    }
+    threadpool.wait();
+    for (int key=0; key<keys; key++) {
+        ASSERT_EQ(200u, order[key].size());
+        for (int counter=0; counter<200; counter++) {
+            EXPECT_EQ(counter, order[key][counter]);
+            EXPECT_EQ(workers[key][0], workers[key][counter]);
+        }
+    }
+}
+
+TEST(ThreadPool, KeyedJobsKeepOrderWhileBalancing)
+{
+    ccol::thread::ThreadPool threadpool(affinityOptions(4, 0));
+    std::vector<int> order;
+    std::atomic_int errors{0};
+    std::atomic_bool running{false};
+    for (int counter=0; counter<5000; counter++) {
+        threadpool.enqueue(ccol::thread::AffinityKey{42}, [&, counter]{
+            if (running.exchange(true)) errors++;
+            order.push_back(counter);
+            running = false;
+        });
+        threadpool.enqueue([]{ std::this_thread::yield(); }); // unkeyed work competes for the workers.
+    }
+    threadpool.wait();
+    EXPECT_EQ(0, errors);
+    ASSERT_EQ(5000u, order.size());
+    EXPECT_TRUE(std::is_sorted(order.begin(), order.end()));
+}
+
+TEST(ThreadPool, KeyedJobsMoveAwayFromABusyWorker)
+{
+    ccol::thread::ThreadPool threadpool(affinityOptions(2, 4));
+    std::promise<void> gate;
+    std::shared_future<void> opened = gate.get_future().share();
+    std::promise<std::thread::id> blocked;
+    threadpool.enqueue(ccol::thread::AffinityKey{0}, [opened, &blocked]{
+        blocked.set_value(std::this_thread::get_id());
+        opened.wait();
+    });
+    const std::thread::id busy = blocked.get_future().get();
+    std::atomic_int onBusyWorker{0};
+    std::atomic_int count{0};
+    for (std::uint64_t key=1; key<=100; key++) {
+        auto done = std::make_shared<std::promise<void>>();
+        auto finished = done->get_future();
+        threadpool.enqueue(ccol::thread::AffinityKey{key}, [&, busy, done]{
+            if (std::this_thread::get_id() == busy) onBusyWorker++;
+            count++;
+            done->set_value();
+        });
+        finished.wait_for(std::chrono::milliseconds(50)); // a job routed to the free worker finishes before the next key is routed.
+    }
+    gate.set_value();
+    threadpool.wait();
+    EXPECT_EQ(100, count);
+    EXPECT_LT(0, onBusyWorker);
+    EXPECT_GE(12, onBusyWorker); // the skew and the keys that share a slot with key 0 wait for the busy worker.
+}
+
+TEST(ThreadPool, ClearRemovesKeyedJobs)
+{
+    ccol::thread::ThreadPool threadpool(1);
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    std::atomic_int count{0};
+    for (int counter=0; counter<3; counter++) {
+        threadpool.enqueue(ccol::thread::AffinityKey{7}, [&count]{ count++; });
+    }
+    EXPECT_EQ(3, threadpool.queueCount());
+    EXPECT_EQ(3, threadpool.dequeueAll().size());
+    EXPECT_EQ(0, threadpool.queueCount());
+    threadpool.enqueue(ccol::thread::AffinityKey{7}, [&count]{ count++; });
+    threadpool.clear();
+    EXPECT_EQ(1, threadpool.totalJobCount());
+    gate.set_value();
+    threadpool.wait();
+    threadpool.enqueue(ccol::thread::AffinityKey{7}, [&count]{ count++; });
+    threadpool.wait();
+    EXPECT_EQ(1, count);
+}
+
+TEST(ThreadPool, ElasticPoolRoutesKeysToPermanentWorkers)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.minThreads = 1;
+    options.maxThreads = 4;
+    options.idleTimeout = std::chrono::milliseconds(1);
+    ccol::thread::ThreadPool threadpool(options);
+    std::atomic_int count{0};
+    for (int round=0; round<3; round++) {
+        for (std::uint64_t key=0; key<50; key++) {
+            threadpool.enqueue(ccol::thread::AffinityKey{key}, [&count]{ count++; });
+        }
+        threadpool.wait();
+        std::this_thread::sleep_for(std::chrono::milliseconds(5)); // let extra workers stop.
+    }
+    EXPECT_EQ(150, count);
+
+    options.minThreads = 0;
+    ccol::thread::ThreadPool fallback(options);
+    fallback.enqueue(ccol::thread::AffinityKey{1}, [&count]{ count++; });
+    fallback.wait();
+    EXPECT_EQ(151, count);
+}
+
+ccol::thread::ThreadPoolOptions helpingOptions(const unsigned int &threads)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = threads;
+    options.helpWhileWaiting = true;
+    return options;
+}
+
+TEST(ThreadPool, HelpUntilRunsJobsOnTheCaller)
+{
+    ccol::thread::ThreadPool threadpool(helpingOptions(1));
+    EXPECT_TRUE(threadpool.helpsWhileWaiting());
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    std::atomic_int count{0};
+    std::atomic_int onCaller{0};
+    const auto caller = std::this_thread::get_id();
+    for (int counter=0; counter<10; counter++) {
+        threadpool.enqueue([&]{
+            if (std::this_thread::get_id() == caller) onCaller++;
+            count++;
+        });
+    }
+    threadpool.helpUntil([&count]{ return count == 10; });
+    EXPECT_EQ(10, onCaller);
+    EXPECT_FALSE(threadpool.runPendingJob());
+    EXPECT_FALSE(threadpool.wait_for(std::chrono::milliseconds(10))); // the blocked job is still running.
+    gate.set_value();
+    threadpool.wait();
+}
+
+TEST(ThreadPool, KeyedJobHelpsWithoutRunningItsOwnKey)
+{
+    ccol::thread::ThreadPool threadpool(helpingOptions(1));
+    std::mutex mutex;
+    std::vector<std::string> order;
+    const auto record = [&](const char *step) {
+        std::unique_lock<std::mutex> lock(mutex);
+        order.push_back(step);
+    };
+    std::promise<void> gate;
+    std::shared_future<void> queued = gate.get_future().share();
+    threadpool.enqueue(ccol::thread::AffinityKey{3}, [&, queued]{
+        record("first");
+        queued.wait(); // the second job of the key is queued on this worker.
+        ccol::thread::TaskGroup group(threadpool);
+        group.enqueue([&]{ record("group"); });
+        group.wait();
+        record("first done");
+    });
+    threadpool.enqueue(ccol::thread::AffinityKey{3}, [&]{ record("second"); });
+    gate.set_value();
+    threadpool.wait();
+    EXPECT_EQ((std::vector<std::string>{"first", "group", "first done", "second"}), order);
+}
+
+TEST(ThreadPool, JobWaitsForTheJobsItEnqueued)
+{
+    ccol::thread::ThreadPool threadpool(helpingOptions(1));
+    std::atomic_int count{0};
+    threadpool.enqueue([&]{
+        for (int counter=0; counter<5; counter++) {
+            threadpool.enqueue([&count]{ count++; });
+        }
+        threadpool.wait(); // does not wait for itself, so the only worker runs the jobs.
+        EXPECT_EQ(5, count);
+        count += 10;
+    });
+    threadpool.wait();
+    EXPECT_EQ(15, count);
+}
+
+int fibonacci(ccol::thread::ThreadPool &threadpool, int n)
+{
+    if (n < 2) return n;
+    int left = 0;
+    int right = 0;
+    ccol::thread::TaskGroup group(threadpool);
+    group.enqueue([&]{ left = fibonacci(threadpool, n - 1); });
+    group.enqueue([&]{ right = fibonacci(threadpool, n - 2); });
+    group.wait();
+    return left + right;
+}
+
+TEST(ThreadPool, NestedForkJoinWithoutExtraThreads)
+{
+    for (unsigned int threads : {1u, 2u}) {
+        ccol::thread::ThreadPool threadpool(helpingOptions(threads));
+        std::atomic_int result{0};
+        threadpool.enqueue([&]{ result = fibonacci(threadpool, 15); });
+        threadpool.wait();
+        EXPECT_EQ(610, result);
+        EXPECT_EQ(threads, threadpool.threadCount());
+    }
+}
+
+TEST(ThreadPool, JobsGetTheContextOfTheirWorker)
+{
+    struct Scratch
+    {
+        unsigned int worker;
+        int jobs = 0;
+    };
+    std::atomic_int created{0};
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 3;
+    options.workerContextFactory = [&created](unsigned int worker) {
+        created++;
+        return std::make_shared<Scratch>(Scratch{worker});
+    };
+    ccol::thread::ThreadPool threadpool(options);
+    std::atomic_int errors{0};
+    for (int counter=0; counter<300; counter++) {
+        threadpool.enqueueWithContext([&errors](ccol::thread::WorkerContext &context) {
+            auto &scratch = context.get<Scratch>();
+            if (!context.hasContext() || scratch.worker != context.workerIndex() || context.workerIndex() >= 3) errors++;
+            scratch.jobs++;
+        });
+    }
+    threadpool.wait();
+    EXPECT_EQ(0, errors);
+    EXPECT_EQ(3, created);
+}
+
+TEST(ThreadPool, ArenaIsRewoundBetweenJobs)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.workerArenaSize = 4096;
+    ccol::thread::ThreadPool threadpool(options);
+    std::vector<void*> memory;
+    std::vector<size_t> capacity;
+    for (int counter=0; counter<100; counter++) {
+        threadpool.enqueueWithContext([&](ccol::thread::WorkerContext &context) {
+            EXPECT_FALSE(context.hasContext());
+            memory.push_back(context.arena().allocate(1000));
+            context.arena().allocate(1000);
+            capacity.push_back(context.arena().capacity());
+        });
+    }
+    threadpool.wait();
+    ASSERT_EQ(100u, memory.size());
+    EXPECT_EQ(100, std::count(memory.begin(), memory.end(), memory[0]));
+    EXPECT_EQ(100, std::count(capacity.begin(), capacity.end(), 4096u));
+}
+
+TEST(ThreadPool, ExternalThreadsBorrowAContext)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 1;
+    options.helpWhileWaiting = true;
+    options.workerContextFactory = [](unsigned int worker) { return std::make_shared<unsigned int>(worker); };
+    ccol::thread::ThreadPool threadpool(options);
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    std::atomic_int done{0};
+    unsigned int worker = 0;
+    unsigned int created = 0;
+    threadpool.enqueueWithContext([&](ccol::thread::WorkerContext &context) {
+        worker = context.workerIndex();
+        created = context.get<unsigned int>();
+        done++;
+    });
+    threadpool.helpUntil([&done]{ return done == 1; });
+    EXPECT_EQ(ccol::thread::WorkerContext::externalWorker, worker);
+    EXPECT_EQ(ccol::thread::WorkerContext::externalWorker, created);
+    gate.set_value();
+    threadpool.wait();
+}
+
+TEST(ThreadPool, BoundedTryEnqueueFailsWhenFull)
+{
+    ccol::thread::ThreadPool threadpool(boundedOptions(2, ccol::thread::Overflow::Block));
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    std::atomic_int count{0};
+    EXPECT_TRUE(threadpool.tryEnqueue([&count]{ count++; }));
+    EXPECT_TRUE(threadpool.tryEnqueue([&count]{ count++; }));
+    ccol::thread::Job job([&count]{ count += 10; });
+    EXPECT_FALSE(threadpool.tryEnqueue(std::move(job)));
+    EXPECT_TRUE(job != nullptr);
+    EXPECT_EQ(2,threadpool.queueCount());
+    EXPECT_EQ(3,threadpool.totalJobCount());
+    gate.set_value();
+    threadpool.wait();
+    threadpool.enqueue(std::move(job));
+    threadpool.wait();
+    EXPECT_EQ(12,count);
+}
+
+TEST(ThreadPool, BoundedTryEnqueueForWaitsForSpace)
+{
+    using namespace std::literals::chrono_literals;
+    ccol::thread::ThreadPool threadpool(boundedOptions(2, ccol::thread::Overflow::Block));
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    std::atomic_int count{0};
+    threadpool.enqueue([&count]{ count++; });
+    threadpool.enqueue([&count]{ count++; });
+    EXPECT_FALSE(threadpool.tryEnqueueFor([&count]{ count++; }, 10ms));
+    std::thread opener([&gate]{
+        std::this_thread::sleep_for(20ms);
+        gate.set_value();
+    });
+    EXPECT_TRUE(threadpool.tryEnqueueFor([&count]{ count++; }, 10s));
+    opener.join();
+    threadpool.wait();
+    EXPECT_EQ(3,count);
+}
+
+TEST(ThreadPool, BoundedCallerRunsWhenFull)
+{
+    ccol::thread::ThreadPool threadpool(boundedOptions(2, ccol::thread::Overflow::CallerRuns));
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    std::thread::id executor;
+    threadpool.enqueue([]{});
+    threadpool.enqueue([]{});
+    threadpool.enqueue([&executor]{ executor = std::this_thread::get_id(); });
+    EXPECT_EQ(std::this_thread::get_id(),executor);
+    gate.set_value();
+    threadpool.wait();
+}
+
+TEST(ThreadPool, BoundedCallerRunsSkipsCancelledJobs)
+{
+    ccol::thread::ThreadPool threadpool(boundedOptions(2, ccol::thread::Overflow::CallerRuns));
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    ccol::util::CancellationTokenSource cancelled;
+    cancelled.cancel();
+    std::atomic_int count{0};
+    EXPECT_TRUE(threadpool.tryEnqueue([&count]{ count++; }));
+    EXPECT_TRUE(threadpool.tryEnqueue([&count]{ count++; }));
+    threadpool.enqueue(cancelled.token(), [&count]{ count += 100; });
+    EXPECT_EQ(0,count);
+    EXPECT_EQ(3,threadpool.totalJobCount());
+    gate.set_value();
+    threadpool.wait();
+    EXPECT_EQ(2,count);
+}
+
+TEST(ThreadPool, BoundedCallerRunsDropsExpiredJobs)
+{
+    using namespace std::literals::chrono_literals;
+    std::atomic_int missed{0};
+    ccol::thread::ThreadPoolOptions options = boundedOptions(2, ccol::thread::Overflow::CallerRuns);
+    options.deadlineMissedCallback = [&missed](ccol::thread::Job &&) { missed++; };
+    ccol::thread::ThreadPool threadpool(options);
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    std::atomic_int count{0};
+    EXPECT_TRUE(threadpool.tryEnqueue([&count]{ count++; }));
+    EXPECT_TRUE(threadpool.tryEnqueue([&count]{ count++; }));
+    threadpool.enqueue(std::chrono::steady_clock::now() - 1ms, [&count]{ count += 100; });
+    EXPECT_EQ(0,count);
+    EXPECT_EQ(1,missed);
+    EXPECT_EQ(1,threadpool.metrics().deadlineMisses);
+    gate.set_value();
+    threadpool.wait();
+    EXPECT_EQ(2,count);
+}
+
+TEST(ThreadPool, BoundedCallerRunsIgnoresEmptyJobs)
+{
+    ccol::thread::ThreadPool threadpool(boundedOptions(2, ccol::thread::Overflow::CallerRuns));
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    EXPECT_TRUE(threadpool.tryEnqueue([]{}));
+    EXPECT_TRUE(threadpool.tryEnqueue([]{}));
+    threadpool.enqueue(ccol::thread::Job());
+    EXPECT_EQ(3,threadpool.totalJobCount());
+    gate.set_value();
+    threadpool.wait();
+    EXPECT_EQ(0,threadpool.totalJobCount());
+}
 
+TEST(ThreadPool, BoundedPurgeCancelledLeavesTheRingToTheWorkers)
+{
+    ccol::thread::ThreadPool threadpool(boundedOptions(16, ccol::thread::Overflow::Block));
+    std::promise<void> gate;
+    blockWorker(threadpool, gate.get_future().share());
+    ccol::util::CancellationTokenSource cancelled;
+    std::atomic_int count{0};
+    for (int counter=0; counter<5; counter++) {
+        threadpool.enqueue(cancelled.token(), [&count]{ count += 100; });
+        threadpool.enqueue([&count]{ count++; });
+    }
+    cancelled.cancel();
+    EXPECT_EQ(0,threadpool.purgeCancelled());
+    EXPECT_EQ(10,threadpool.queueCount());
+    gate.set_value();
+    threadpool.wait();
+    EXPECT_EQ(5,count);
+}
+
+TEST(ThreadPool, BoundedBlocksProducersUntilSpace)
+{
+    ccol::thread::ThreadPoolOptions options = boundedOptions(16, ccol::thread::Overflow::Block);
+    options.threads = 2;
+    ccol::thread::ThreadPool threadpool(options);
+    std::atomic_int count{0};
+    std::vector<std::thread> producers;
+    for (int producer=0; producer<4; producer++) {
+        producers.emplace_back([&threadpool,&count]{
+            for (int counter=0; counter<10000; counter++) {
+                threadpool.enqueue([&count]{ count++; });
+            }
+        });
+    }
+    for (auto &producer : producers) {
+        producer.join();
+    }
+    threadpool.wait();
+    EXPECT_EQ(40000,count);
+}
+
+TEST(ThreadPool, WorkStealingInstantiatedSpecified3ThreadsCallBackCalled3Times)
+{
+    int count = 0;
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 3;
+    options.scheduling = ccol::thread::Scheduling::WorkStealing;
+    options.threadCreateCallback = [&count](std::thread&){
+        count++;
+    };
+    ccol::thread::ThreadPool threadpool(options);
+    EXPECT_EQ(3,threadpool.threadCount());
+    EXPECT_EQ(3,count);
+}
+
+TEST(ThreadPool, WorkStealingExecutesAllJobs)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 4;
+    options.scheduling = ccol::thread::Scheduling::WorkStealing;
+    ccol::thread::ThreadPool threadpool(options);
+    std::atomic_int count{0};
+    std::vector<std::function<void()>> jobs;
+    for (int counter=0; counter<1000; counter++) {
+        threadpool.enqueue([&count]{ count++; });
+        jobs.push_back([&count]{ count++; });
+    }
+    threadpool.enqueue(std::move(jobs));
+    threadpool.wait();
+    EXPECT_EQ(2000,count);
+    EXPECT_EQ(0,threadpool.totalJobCount());
+    EXPECT_EQ(0,threadpool.queueCount());
+}
+
+TEST(ThreadPool, WorkStealingExecutesJobsEnqueuedFromJobs)
+{
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 4;
+    options.scheduling = ccol::thread::Scheduling::WorkStealing;
+    ccol::thread::ThreadPool threadpool(options);
+    std::atomic_int count{0};
+    std::function<void(int)> fanOut = [&](int depth) {
+        count++;
+        if (depth == 0) return;
+        threadpool.enqueue([&fanOut,depth]{ fanOut(depth-1); });
+        threadpool.enqueue([&fanOut,depth]{ fanOut(depth-1); });
+    };
+    threadpool.enqueue([&fanOut]{ fanOut(9); });
+    threadpool.wait();
+    EXPECT_EQ(1023,count);
+}
+
+TEST(ThreadPool, WorkStealingExecutedTwoOfFourThreads)
+{
+    using namespace std::literals::chrono_literals;
+
+    ThreadPoolTestContext tptc;
+    ccol::thread::ThreadPoolOptions options;
+    options.threads = 2;
+    options.scheduling = ccol::thread::Scheduling::WorkStealing;
+    ccol::thread::ThreadPool threadpool(options);
+    {
+        std::unique_lock<std::mutex> lk2(tptc.waitTerminateMutex);
+
+        threadpool.enqueue(std::vector<std::function<void()>>{tptc.job,tptc.job,tptc.job,tptc.job});
+
+        EXPECT_TRUE(tptc.cv.wait_for(tptc.syncLock, 200ms, [&tptc]{ return tptc.middleCount==2; }));
+        EXPECT_EQ(2,threadpool.queueCount());
+        EXPECT_EQ(2,threadpool.dequeueAll().size());
+        EXPECT_EQ(0,threadpool.queueCount());
+    }
+    threadpool.wait();
+    EXPECT_EQ(0,threadpool.totalJobCount());
+    EXPECT_EQ(2,tptc.middleCount);
+}
 
 }
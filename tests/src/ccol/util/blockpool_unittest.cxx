@@ -0,0 +1,92 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/util/blockpool.hxx>
+#include <cstddef>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "gtest/gtest.h"
+
+TEST(BlockPool, RecyclesBlocksOfSameSize)
+{
+    ccol::util::BlockPool blockPool;
+    void *block = blockPool.allocate(40);
+    blockPool.deallocate(block, 40);
+    void *recycled = blockPool.allocate(64); // 40 and 64 share the same block size.
+    EXPECT_EQ(block,recycled);
+    blockPool.deallocate(recycled, 64);
+}
+
+TEST(BlockPool, BlocksAreAligned)
+{
+    ccol::util::BlockPool blockPool;
+    for (std::size_t size = 1; size <= ccol::util::BlockPool::maxBlockSize * 2; size += 37) {
+        void *block = blockPool.allocate(size);
+        EXPECT_EQ(0,reinterpret_cast<std::uintptr_t>(block) % alignof(std::max_align_t));
+        blockPool.deallocate(block, size);
+    }
+}
+
+TEST(BlockPool, AllocatesFromMultipleThreads)
+{
+    ccol::util::BlockPool blockPool(16);
+    std::vector<std::thread> threads;
+    for (int thread=0; thread<4; thread++) {
+        threads.emplace_back([&blockPool, thread]{
+            std::vector<int*> blocks;
+            for (int counter=0; counter<1000; counter++) {
+                int *block = static_cast<int*>(blockPool.allocate(sizeof(int) * (1 + counter % 64)));
+                *block = thread;
+                blocks.push_back(block);
+                if (blocks.size() > 32) {
+                    for (std::size_t idx=0; idx<blocks.size(); idx++) {
+                        EXPECT_EQ(thread,*blocks[idx]);
+                    }
+                    for (std::size_t idx=0; idx<blocks.size(); idx++) {
+                        blockPool.deallocate(blocks[idx], sizeof(int) * (1 + (counter - blocks.size() + 1 + idx) % 64));
+                    }
+                    blocks.clear();
+                }
+            }
+            for (std::size_t idx=0; idx<blocks.size(); idx++) {
+                blockPool.deallocate(blocks[idx], sizeof(int) * (1 + (1000 - blocks.size() + idx) % 64));
+            }
+        });
+    }
+    for (auto &thread : threads) {
+        thread.join();
+    }
+}
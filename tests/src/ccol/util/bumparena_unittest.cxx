@@ -0,0 +1,85 @@
+/*
+SPDX-License-Identifier: MIT
+
+© 2017 CrossCode / Patrick Vollebregt - All rights reserved
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in all
+copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+SOFTWARE.
+
+If you use this code, please mention usages of this library and the copyright notice visible
+in your end product or distributed documentation. For example:
+
+This product uses "ccopenlib" written and copyrighted by CrossCode / Patrick Vollebregt.
+Visit http://www.ccopenlib.com for more information.
+
+If for some reason this not possible, please contact: ccopenlib@crosscode.nl to purchase a license exception.
+
+If you'd like to modify and/or share this code, share it under the same license, and keep the original copyright notice intact.
+
+If you have found any errors or improvements you'd like to share, please contact me: ccopenlib@crosscode.nl
+*/
+#include <ccol/util/bumparena.hxx>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "gtest/gtest.h"
+
+TEST(BumpArena, AllocatesNothingUntilUsed)
+{
+    ccol::util::BumpArena arena(1024);
+    EXPECT_EQ(0,arena.capacity());
+    arena.allocate(10);
+    EXPECT_EQ(1024,arena.capacity());
+}
+
+TEST(BumpArena, HonoursAlignment)
+{
+    ccol::util::BumpArena arena(1024);
+    for (std::size_t alignment = 1; alignment <= 64; alignment *= 2) {
+        arena.allocate(1, 1);
+        void *memory = arena.allocate(8, alignment);
+        EXPECT_EQ(0,reinterpret_cast<std::uintptr_t>(memory) % alignment);
+    }
+}
+
+TEST(BumpArena, RewindReusesMemory)
+{
+    ccol::util::BumpArena arena(1024);
+    void *first = arena.allocate(100);
+    const auto marker = arena.mark();
+    void *second = arena.allocate(100);
+    arena.allocate(2000); // does not fit a chunk, it gets one of its own.
+    const std::size_t capacity = arena.capacity();
+    arena.rewind(marker);
+    EXPECT_EQ(second,arena.allocate(100));
+    arena.allocate(2000);
+    EXPECT_EQ(capacity,arena.capacity()); // the chunks are kept.
+    arena.reset();
+    EXPECT_EQ(first,arena.allocate(100));
+}
+
+TEST(BumpArena, AllocatorForContainers)
+{
+    ccol::util::BumpArena arena(256);
+    std::vector<int, ccol::util::ArenaAllocator<int>> values{ccol::util::ArenaAllocator<int>(arena)};
+    for (int value = 0; value < 1000; value++) {
+        values.push_back(value);
+    }
+    EXPECT_EQ(999,values.back());
+    EXPECT_LE(1000 * sizeof(int),arena.capacity());
+}